@@ -0,0 +1,33 @@
+#pragma once
+#include "terrain_generator.hpp"
+
+// Helpers shared by the micro benchmarks, block ids come from terrain_generator.hpp
+
+namespace Minecraft {
+
+// Ores scattered through the stone, ids past the terrain blocks
+inline constexpr BlockId FIRST_ORE = 16;
+inline constexpr uint32_t ORE_COUNT = 8;
+
+template<typename F>
+double time_ms(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Positional count argument, index 1 is the first one. Missing keeps fallback, anything below 1 becomes 1
+inline uint32_t count_argument(const int argc, char** argv, const int index, const uint32_t fallback)
+{
+    return argc > index ? static_cast<uint32_t>(std::max(std::atoi(argv[index]), 1)) : fallback;
+}
+
+// A named way to fill the chunks a benchmark runs on
+template<typename Signature>
+struct Scenario {
+    const char* Name;
+    std::function<Signature> Make;
+};
+
+}
@@ -0,0 +1,198 @@
+#include "bench_utils.hpp"
+#include "chunk_mesher.hpp"
+
+/*
+ * Greedy mesher throughput over a square of chunks, each meshed with its real neighbors.
+ * Also checks the quads cover exactly the faces a naive per block mesher would emit.
+ * Usage: chunk_mesh_bench [grid size] [passes]
+ */
+
+using namespace Minecraft;
+
+// Rolling hills of stone under dirt and grass, a few ores, water up to sea level
+static void make_terrain(Chunk& chunk, const uint32_t chunk_x, const uint32_t chunk_z, std::mt19937& rng)
+{
+    std::uniform_int_distribution percent { 0, 99 };
+    std::uniform_int_distribution<uint32_t> ore { 0, ORE_COUNT - 1 };
+    constexpr uint32_t sea_level = 62;
+
+    for (uint32_t z = 0; z < ChunkSection::SIZE; z++) {
+        for (uint32_t x = 0; x < ChunkSection::SIZE; x++) {
+            const auto wx = static_cast<float>(chunk_x * ChunkSection::SIZE + x);
+            const auto wz = static_cast<float>(chunk_z * ChunkSection::SIZE + z);
+            const auto height = static_cast<uint32_t>(64.0f + 10.0f * std::sin(wx * 0.07f) * std::cos(wz * 0.05f) + 3.0f * std::sin((wx + wz) * 0.21f));
+
+            for (uint32_t y = 0; y <= std::max(height, sea_level); y++) {
+                BlockId block = BLOCK_WATER;
+                if (y + 3 < height) {
+                    block = percent(rng) < 1 ? static_cast<BlockId>(FIRST_ORE + ore(rng)) : BLOCK_STONE;
+                } else if (y < height) {
+                    block = BLOCK_DIRT;
+                } else if (y == height) {
+                    block = BLOCK_GRASS;
+                }
+                chunk.set(x, y, z, block);
+            }
+        }
+    }
+}
+
+// Half the blocks filled at random, little to cull and nothing to merge
+static void make_noisy(Chunk& chunk, std::mt19937& rng)
+{
+    std::uniform_int_distribution<uint32_t> dist { 0, 7 };
+    std::array<BlockId, ChunkSection::VOLUME> blocks;
+    for (uint32_t s = 0; s < Chunk::SECTION_COUNT; s++) {
+        for (BlockId& block : blocks) {
+            const uint32_t value = dist(rng);
+            block = value < 4 ? BLOCK_AIR : static_cast<BlockId>(value - 3);
+        }
+        chunk.set_section(s, blocks);
+    }
+}
+
+// Every other block solid, the worst case: six faces per block and no merging at all
+static void make_checkerboard(Chunk& chunk)
+{
+    for (uint32_t y = 0; y < Chunk::HEIGHT; y++) {
+        for (uint32_t z = 0; z < ChunkSection::SIZE; z++) {
+            for (uint32_t x = 0; x < ChunkSection::SIZE; x++) {
+                chunk.set(x, y, z, (x + y + z) % 2 == 0 ? BLOCK_STONE : BLOCK_AIR);
+            }
+        }
+    }
+}
+
+// Faces between a block and air, the quad count of a mesher without merging
+static uint64_t count_naive_faces(const std::span<const BlockId, Chunk::PADDED_VOLUME> padded)
+{
+    const auto at = [&](const uint32_t x, const uint32_t y, const uint32_t z) {
+        return padded[x + z * Chunk::PADDED_SIZE + y * Chunk::PADDED_AREA];
+    };
+
+    uint64_t faces = 0;
+    for (uint32_t y = 1; y <= ChunkSection::SIZE; y++) {
+        for (uint32_t z = 1; z <= ChunkSection::SIZE; z++) {
+            for (uint32_t x = 1; x <= ChunkSection::SIZE; x++) {
+                if (at(x, y, z) == BLOCK_AIR) {
+                    continue;
+                }
+
+                faces += (at(x + 1, y, z) == BLOCK_AIR) + (at(x - 1, y, z) == BLOCK_AIR) + (at(x, y + 1, z) == BLOCK_AIR)
+                    + (at(x, y - 1, z) == BLOCK_AIR) + (at(x, y, z + 1) == BLOCK_AIR) + (at(x, y, z - 1) == BLOCK_AIR);
+            }
+        }
+    }
+    return faces;
+}
+
+// Block faces covered by the quads, from their UV extent
+static uint64_t count_covered_faces(const ChunkMesh& mesh)
+{
+    uint64_t faces = 0;
+    for (size_t v = 0; v + 3 < mesh.Vertices.size(); v += 4) {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        for (size_t corner = v; corner < v + 4; corner++) {
+            width = std::max(width, mesh.Vertices[corner].u());
+            height = std::max(height, mesh.Vertices[corner].v());
+        }
+        faces += width * height;
+    }
+    return faces;
+}
+
+static bool run(const char* name, const std::vector<Chunk>& chunks, const uint32_t grid, const uint32_t passes)
+{
+    const auto neighbors_of = [&](const uint32_t cx, const uint32_t cz) {
+        Chunk::Neighbors neighbors {};
+        neighbors[static_cast<uint32_t>(BlockFace::ePosX)] = cx + 1 < grid ? &chunks[cx + 1 + cz * grid] : nullptr;
+        neighbors[static_cast<uint32_t>(BlockFace::eNegX)] = cx > 0 ? &chunks[cx - 1 + cz * grid] : nullptr;
+        neighbors[static_cast<uint32_t>(BlockFace::ePosZ)] = cz + 1 < grid ? &chunks[cx + (cz + 1) * grid] : nullptr;
+        neighbors[static_cast<uint32_t>(BlockFace::eNegZ)] = cz > 0 ? &chunks[cx + (cz - 1) * grid] : nullptr;
+        return neighbors;
+    };
+
+    ChunkMesher mesher;
+    ChunkMesh mesh;
+
+    // Validation pass, not timed
+    std::array<BlockId, Chunk::PADDED_VOLUME> padded;
+    uint64_t naive_faces = 0;
+    uint64_t quads = 0;
+    uint64_t non_empty = 0;
+    for (uint32_t cz = 0; cz < grid; cz++) {
+        for (uint32_t cx = 0; cx < grid; cx++) {
+            const Chunk& chunk = chunks[cx + cz * grid];
+            for (uint32_t s = 0; s < Chunk::SECTION_COUNT; s++) {
+                chunk.gather_padded(s, neighbors_of(cx, cz), padded);
+                mesher.mesh(padded, mesh);
+
+                const uint64_t expected = count_naive_faces(padded);
+                const uint64_t covered = count_covered_faces(mesh);
+                if (covered != expected) {
+                    fmt::println(stderr, "{}: chunk {},{} section {} covers {} faces instead of {}", name, cx, cz, s, covered, expected);
+                    return false;
+                }
+
+                naive_faces += expected;
+                quads += mesh.get_quad_count();
+                non_empty += mesh.empty() ? 0 : 1;
+            }
+        }
+    }
+
+    uint64_t checksum = 0;
+    const double total_ms = time_ms([&] {
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            for (uint32_t cz = 0; cz < grid; cz++) {
+                for (uint32_t cx = 0; cx < grid; cx++) {
+                    const Chunk::Neighbors neighbors = neighbors_of(cx, cz);
+                    for (uint32_t s = 0; s < Chunk::SECTION_COUNT; s++) {
+                        mesher.mesh(chunks[cx + cz * grid], s, neighbors, mesh);
+                        checksum += mesh.Vertices.size();
+                    }
+                }
+            }
+        }
+    });
+
+    const double sections = static_cast<double>(chunks.size()) * Chunk::SECTION_COUNT * passes;
+    const double meshed = std::max<double>(static_cast<double>(non_empty), 1.0);
+    fmt::println("{:<14} {:>9.0f} sections/s  {:>7.2f} us/section  {:>8.1f} triangles/section  {:>8.0f} B/section  {:>5.2f}x fewer quads than naive  (checksum {})",
+        name, sections / total_ms * 1000.0, total_ms * 1000.0 / sections, static_cast<double>(quads) * 2.0 / meshed,
+        static_cast<double>(quads) * (4 * sizeof(PackedChunkVertex) + 6 * sizeof(uint32_t)) / meshed,
+        static_cast<double>(naive_faces) / std::max<double>(static_cast<double>(quads), 1.0), checksum);
+    return true;
+}
+
+int main(const int argc, char** argv)
+{
+    const uint32_t grid = count_argument(argc, argv, 1, 8);
+    const uint32_t passes = count_argument(argc, argv, 2, 4);
+
+    std::mt19937 rng { 1234 };
+
+    using ChunkScenario = Scenario<void(Chunk&, uint32_t, uint32_t)>;
+    const std::array scenarios {
+        ChunkScenario { "terrain", [&](Chunk& chunk, const uint32_t x, const uint32_t z) { make_terrain(chunk, x, z, rng); } },
+        ChunkScenario { "noisy", [&](Chunk& chunk, uint32_t, uint32_t) { make_noisy(chunk, rng); } },
+        ChunkScenario { "checkerboard", [](Chunk& chunk, uint32_t, uint32_t) { make_checkerboard(chunk); } },
+    };
+
+    fmt::println("{}x{} chunks of {} sections, {} passes, triangles and bytes per non empty section", grid, grid, Chunk::SECTION_COUNT, passes);
+    for (const ChunkScenario& scenario : scenarios) {
+        std::vector<Chunk> chunks(grid * grid);
+        for (uint32_t z = 0; z < grid; z++) {
+            for (uint32_t x = 0; x < grid; x++) {
+                scenario.Make(chunks[x + z * grid], x, z);
+            }
+        }
+
+        if (!run(scenario.Name, chunks, grid, passes)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
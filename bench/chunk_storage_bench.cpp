@@ -0,0 +1,136 @@
+#include "bench_utils.hpp"
+
+/*
+ * Memory per chunk and lookup throughput of the palette storage, against a flat uint16_t per block.
+ * Usage: chunk_storage_bench [chunk count]
+ */
+
+using namespace Minecraft;
+
+static constexpr size_t FLAT_CHUNK_BYTES = Chunk::SECTION_COUNT * ChunkSection::VOLUME * sizeof(BlockId);
+
+// Stone below, a rough surface with ores, dirt and grass in section 4, water up to section 5, air above
+static void make_terrain(Chunk& chunk, std::mt19937& rng)
+{
+    for (uint32_t s = 0; s < 4; s++) {
+        chunk.fill_section(s, BLOCK_STONE);
+    }
+
+    std::uniform_int_distribution height_dist { 66, 78 };
+    std::uniform_int_distribution percent { 0, 99 };
+    std::uniform_int_distribution<uint32_t> ore { 0, ORE_COUNT - 1 };
+    constexpr uint32_t sea_level = 82;
+
+    for (uint32_t z = 0; z < ChunkSection::SIZE; z++) {
+        for (uint32_t x = 0; x < ChunkSection::SIZE; x++) {
+            const auto height = static_cast<uint32_t>(height_dist(rng));
+            for (uint32_t y = 64; y < sea_level; y++) {
+                BlockId block = BLOCK_AIR;
+                if (y + 3 < height) {
+                    block = percent(rng) < 2 ? static_cast<BlockId>(FIRST_ORE + ore(rng)) : BLOCK_STONE;
+                } else if (y < height) {
+                    block = BLOCK_DIRT;
+                } else if (y == height) {
+                    block = BLOCK_GRASS;
+                } else {
+                    block = BLOCK_WATER;
+                }
+                chunk.set(x, y, z, block);
+            }
+        }
+    }
+}
+
+// Every section a random mix of block_types ids
+static void make_noisy(Chunk& chunk, std::mt19937& rng, const uint32_t block_types)
+{
+    std::uniform_int_distribution<uint32_t> dist { 0, block_types - 1 };
+    std::array<BlockId, ChunkSection::VOLUME> blocks;
+    for (uint32_t s = 0; s < Chunk::SECTION_COUNT; s++) {
+        for (BlockId& block : blocks) {
+            block = static_cast<BlockId>(dist(rng));
+        }
+        chunk.set_section(s, blocks);
+    }
+}
+
+static void report_memory(const char* name, const std::vector<Chunk>& chunks)
+{
+    size_t bytes = 0;
+    for (const Chunk& chunk : chunks) {
+        bytes += chunk.memory_usage();
+    }
+
+    const double per_chunk = static_cast<double>(bytes) / static_cast<double>(chunks.size());
+    fmt::println("{:<16} {:>10.0f} B/chunk  {:>6.2f}% of flat ({} B)", name, per_chunk,
+        per_chunk * 100.0 / FLAT_CHUNK_BYTES, FLAT_CHUNK_BYTES);
+}
+
+static void report_lookups(const char* name, const std::vector<Chunk>& chunks, std::mt19937& rng)
+{
+    constexpr uint32_t lookups = 1 << 24;
+    std::vector<uint32_t> coords(lookups);
+    std::uniform_int_distribution<uint32_t> dist { 0, UINT32_MAX };
+    for (uint32_t& c : coords) {
+        c = dist(rng);
+    }
+
+    uint64_t checksum = 0;
+    const double random_ms = time_ms([&] {
+        for (const uint32_t c : coords) {
+            const Chunk& chunk = chunks[(c >> 16) % chunks.size()];
+            checksum += chunk.get(c & 15, c >> 4 & (Chunk::HEIGHT - 1), c >> 12 & 15);
+        }
+    });
+
+    std::array<BlockId, ChunkSection::VOLUME> blocks;
+    const double bulk_ms = time_ms([&] {
+        for (const Chunk& chunk : chunks) {
+            for (uint32_t s = 0; s < Chunk::SECTION_COUNT; s++) {
+                chunk.get_section(s).get_all(blocks);
+                checksum += blocks[s];
+            }
+        }
+    });
+
+    const double bulk_blocks = static_cast<double>(chunks.size()) * Chunk::SECTION_COUNT * ChunkSection::VOLUME;
+    fmt::println("{:<16} random get {:>8.1f} M/s  get_all {:>8.1f} M blocks/s  (checksum {})", name,
+        lookups / random_ms / 1000.0, bulk_blocks / bulk_ms / 1000.0, checksum);
+}
+
+int main(const int argc, char** argv)
+{
+    const uint32_t chunk_count = count_argument(argc, argv, 1, 256);
+
+    std::mt19937 rng { 1234 };
+
+    using ChunkScenario = Scenario<void(Chunk&)>;
+    const std::array scenarios {
+        ChunkScenario { "terrain", [&](Chunk& chunk) { make_terrain(chunk, rng); } },
+        ChunkScenario { "noisy 4 types", [&](Chunk& chunk) { make_noisy(chunk, rng, 4); } },
+        ChunkScenario { "noisy 64 types", [&](Chunk& chunk) { make_noisy(chunk, rng, 64); } },
+        ChunkScenario { "noisy 1024 types", [&](Chunk& chunk) { make_noisy(chunk, rng, 1024); } },
+    };
+
+    fmt::println("{} chunks of {} sections", chunk_count, Chunk::SECTION_COUNT);
+    for (const ChunkScenario& scenario : scenarios) {
+        std::vector<Chunk> chunks(chunk_count);
+        const double build_ms = time_ms([&] {
+            for (Chunk& chunk : chunks) {
+                scenario.Make(chunk);
+            }
+        });
+
+        const double compact_ms = time_ms([&] {
+            for (Chunk& chunk : chunks) {
+                chunk.compact();
+            }
+        });
+
+        fmt::println("{:<16} built in {:.1f} ms, compacted in {:.1f} ms", scenario.Name, build_ms, compact_ms);
+        report_memory(scenario.Name, chunks);
+        report_lookups(scenario.Name, chunks, rng);
+    }
+
+    return EXIT_SUCCESS;
+}
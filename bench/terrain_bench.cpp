@@ -0,0 +1,177 @@
+#include "bench_utils.hpp"
+
+/*
+ * Noise and terrain generation throughput for every SIMD level the CPU supports.
+ * Checks first that each level returns the scalar noise and builds the same chunks.
+ * Usage: terrain_bench [grid size] [passes]
+ */
+
+using namespace Minecraft;
+
+static constexpr size_t SAMPLE_COUNT = 1 << 18;
+static constexpr uint32_t SECTION_BATCHES = 512;
+static constexpr FractalSpec SAMPLE_SPEC { .Seed = 99, .Frequency = 1.0f / 48.0f, .Octaves = 4 };
+
+struct Samples {
+    std::vector<float> X;
+    std::vector<float> Y;
+    std::vector<float> Z;
+};
+
+// Spread over positive and negative coordinates, an odd count so the scalar tail runs too
+static Samples make_samples(std::mt19937& rng)
+{
+    std::uniform_real_distribution horizontal { -30000.0f, 30000.0f };
+    std::uniform_real_distribution vertical { 0.0f, static_cast<float>(Chunk::HEIGHT) };
+
+    Samples samples;
+    for (size_t i = 0; i < SAMPLE_COUNT + 3; i++) {
+        samples.X.push_back(horizontal(rng));
+        samples.Y.push_back(vertical(rng));
+        samples.Z.push_back(horizontal(rng));
+    }
+    return samples;
+}
+
+static float max_difference(std::span<const float> a, std::span<const float> b)
+{
+    float difference = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        difference = std::max(difference, std::abs(a[i] - b[i]));
+    }
+    return difference;
+}
+
+static bool validate(const SimdLevel level, const Samples& samples, const uint32_t grid)
+{
+    const Noise scalar { SimdLevel::eScalar };
+    const Noise noise { level };
+
+    std::vector<float> expected(samples.X.size());
+    std::vector<float> actual(samples.X.size());
+
+    scalar.fbm_2d(SAMPLE_SPEC, samples.X, samples.Z, expected);
+    noise.fbm_2d(SAMPLE_SPEC, samples.X, samples.Z, actual);
+    if (const float difference = max_difference(expected, actual); difference > 0.0f) {
+        fmt::println(stderr, "{}: 2D noise differs from scalar by up to {}", to_string(level), difference);
+        return false;
+    }
+
+    scalar.fbm_3d(SAMPLE_SPEC, samples.X, samples.Y, samples.Z, expected);
+    noise.fbm_3d(SAMPLE_SPEC, samples.X, samples.Y, samples.Z, actual);
+    if (const float difference = max_difference(expected, actual); difference > 0.0f) {
+        fmt::println(stderr, "{}: 3D noise differs from scalar by up to {}", to_string(level), difference);
+        return false;
+    }
+
+    const TerrainGenerator reference { TerrainSpec {}, SimdLevel::eScalar };
+    const TerrainGenerator generator { TerrainSpec {}, level };
+    Chunk expected_chunk;
+    Chunk actual_chunk;
+    for (uint32_t cz = 0; cz < grid; cz++) {
+        for (uint32_t cx = 0; cx < grid; cx++) {
+            const auto chunk_x = static_cast<int32_t>(cx) - static_cast<int32_t>(grid / 2);
+            const auto chunk_z = static_cast<int32_t>(cz) - static_cast<int32_t>(grid / 2);
+            reference.generate(expected_chunk, chunk_x, chunk_z);
+            generator.generate(actual_chunk, chunk_x, chunk_z);
+
+            for (uint32_t y = 0; y < Chunk::HEIGHT; y++) {
+                for (uint32_t z = 0; z < ChunkSection::SIZE; z++) {
+                    for (uint32_t x = 0; x < ChunkSection::SIZE; x++) {
+                        if (expected_chunk.get(x, y, z) != actual_chunk.get(x, y, z)) {
+                            fmt::println(stderr, "{}: chunk {},{} differs from scalar at {},{},{}", to_string(level), chunk_x, chunk_z, x, y, z);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static void run(const SimdLevel level, const Samples& samples, const uint32_t grid, const uint32_t passes)
+{
+    const Noise noise { level };
+    std::vector<float> out(samples.X.size());
+    double checksum = 0.0;
+
+    const double noise_2d_ms = time_ms([&] {
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            noise.fbm_2d(SAMPLE_SPEC, samples.X, samples.Z, out);
+            checksum += out[pass];
+        }
+    });
+    const double noise_3d_ms = time_ms([&] {
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            noise.fbm_3d(SAMPLE_SPEC, samples.X, samples.Y, samples.Z, out);
+            checksum += out[pass];
+        }
+    });
+
+    // The cave noise alone, one batch per section
+    const TerrainSpec spec {};
+    const FractalSpec cave_spec { .Seed = spec.Seed, .Frequency = 1.0f / spec.CaveScale, .Octaves = spec.CaveOctaves };
+    std::array<float, ChunkSection::VOLUME> section;
+    const double section_ms = time_ms([&] {
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            for (uint32_t i = 0; i < SECTION_BATCHES; i++) {
+                const glm::ivec3 origin { static_cast<int32_t>(i % 32) * 16, static_cast<int32_t>(i / 32 % 8) * 16, static_cast<int32_t>(pass) * 16 };
+                noise.fbm_section(cave_spec, origin, section);
+                checksum += section[i];
+            }
+        }
+    });
+
+    const TerrainGenerator generator { spec, level };
+    Chunk chunk;
+    const double generate_ms = time_ms([&] {
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            for (uint32_t cz = 0; cz < grid; cz++) {
+                for (uint32_t cx = 0; cx < grid; cx++) {
+                    generator.generate(chunk, static_cast<int32_t>(cx + pass * grid), static_cast<int32_t>(cz));
+                    checksum += chunk.get(cx % ChunkSection::SIZE, 40, cz % ChunkSection::SIZE);
+                }
+            }
+        }
+    });
+
+    const double points = static_cast<double>(samples.X.size()) * passes;
+    const double sections = static_cast<double>(SECTION_BATCHES) * passes;
+    const double chunks = static_cast<double>(grid) * grid * passes;
+    fmt::println("{:<7} {:>7.1f} M 2D samples/s  {:>7.1f} M 3D samples/s  {:>8.0f} cave sections/s  {:>7.0f} chunks/s  {:>8.0f} generated sections/s  (checksum {:.3f})",
+        to_string(level), points / noise_2d_ms / 1000.0, points / noise_3d_ms / 1000.0, sections / section_ms * 1000.0, chunks / generate_ms * 1000.0,
+        chunks * Chunk::SECTION_COUNT / generate_ms * 1000.0, checksum);
+}
+
+int main(const int argc, char** argv)
+{
+    const uint32_t grid = count_argument(argc, argv, 1, 8);
+    const uint32_t passes = count_argument(argc, argv, 2, 4);
+
+    std::mt19937 rng { 1234 };
+    const Samples samples = make_samples(rng);
+
+    const SimdLevel best = detect_simd_level();
+    std::vector<SimdLevel> levels { SimdLevel::eScalar };
+    for (const SimdLevel level : { SimdLevel::eSse41, SimdLevel::eAvx2 }) {
+        if (level <= best) {
+            levels.push_back(level);
+        }
+    }
+
+    for (const SimdLevel level : levels) {
+        if (!validate(level, samples, grid)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    fmt::println("{} noise samples of {} octaves, {}x{} chunks of {} sections, {} passes, {} detected",
+        samples.X.size(), SAMPLE_SPEC.Octaves, grid, grid, Chunk::SECTION_COUNT, passes, to_string(best));
+    for (const SimdLevel level : levels) {
+        run(level, samples, grid, passes);
+    }
+
+    return EXIT_SUCCESS;
+}
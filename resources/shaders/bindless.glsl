@@ -0,0 +1,23 @@
+// Shader side of BindlessHeap (bindless_heap.hpp), include with GL_GOOGLE_include_directive.
+// Slot indices come from push constants, wrap them in nonuniformEXT when they vary within a draw.
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (set = 0, binding = 0) uniform texture2D bindless_textures[];
+// No format qualifier, the heap holds storage images of several formats (shaderStorageImageWriteWithoutFormat).
+// A shader reading one aliases binding 1 with the format of that image
+layout (set = 0, binding = 1) uniform writeonly image2D bindless_storage_images[];
+layout (set = 0, binding = 3) uniform sampler bindless_samplers[3];
+
+// BindlessSampler
+#define SAMPLER_NEAREST_REPEAT 0
+#define SAMPLER_LINEAR_REPEAT 1
+#define SAMPLER_LINEAR_CLAMP 2
+
+vec4 sample_texture(uint texture_index, uint sampler_index, vec2 uv)
+{
+    return texture(sampler2D(bindless_textures[nonuniformEXT(texture_index)], bindless_samplers[sampler_index]), uv);
+}
+
+// Storage buffers alias binding 2 with their own element type
+#define BINDLESS_STORAGE_BUFFER(Name, Type) \
+    layout (set = 0, binding = 2, std430) buffer Name##_block { Type data[]; } Name[]
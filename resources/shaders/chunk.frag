@@ -0,0 +1,40 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_buffer_reference : require
+
+#include "bindless.glsl"
+
+// Sampled image binding again as arrays, for TextureArray
+layout (set = 0, binding = 0) uniform texture2DArray bindless_texture_arrays[];
+
+layout (buffer_reference, std430, buffer_reference_align = 8) readonly buffer ChunkVertices {
+    uvec2 vertices[];
+};
+
+// ChunkDrawPushConstants in chunk_renderer.hpp
+layout (push_constant) uniform PushConstants {
+    mat4 view_projection;
+    ChunkVertices vertices;
+    uint records_index;
+    uint texture_index;
+} push;
+
+layout (location = 0) in vec2 in_uv;
+layout (location = 1) flat in uint in_texture;
+layout (location = 2) flat in uint in_face;
+
+layout (location = 0) out vec4 out_color;
+
+// Indexed by BlockFace, a fixed light from above
+const float FACE_SHADE[6] = float[](0.8f, 0.8f, 1.0f, 0.5f, 0.65f, 0.65f);
+
+void main()
+{
+    vec3 color = vec3(0.55f, 0.6f, 0.5f);
+    if (push.texture_index != 0xFFFFFFFFu) {
+        color = texture(sampler2DArray(bindless_texture_arrays[push.texture_index], bindless_samplers[SAMPLER_NEAREST_REPEAT]),
+            vec3(in_uv, float(in_texture))).rgb;
+    }
+
+    out_color = vec4(color * FACE_SHADE[in_face], 1.0f);
+}
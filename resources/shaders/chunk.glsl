@@ -0,0 +1,12 @@
+// Shader side of ChunkRenderer (chunk_renderer.hpp), include after bindless.glsl
+
+// ChunkSectionRecord, no indices for empty and free sections
+struct ChunkSectionRecord {
+    ivec3 origin;
+    uint index_count;
+    uint first_index;
+    int vertex_offset;
+    uvec2 padding;
+};
+
+BINDLESS_STORAGE_BUFFER(section_records, ChunkSectionRecord);
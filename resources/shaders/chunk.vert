@@ -0,0 +1,38 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_buffer_reference : require
+
+#include "bindless.glsl"
+#include "chunk.glsl"
+
+// PackedChunkVertex from chunk_vertex.hpp: geometry then material
+layout (buffer_reference, std430, buffer_reference_align = 8) readonly buffer ChunkVertices {
+    uvec2 vertices[];
+};
+
+// ChunkDrawPushConstants in chunk_renderer.hpp
+layout (push_constant) uniform PushConstants {
+    mat4 view_projection;
+    ChunkVertices vertices;
+    uint records_index;
+    uint texture_index;
+} push;
+
+layout (location = 0) out vec2 out_uv;
+layout (location = 1) flat out uint out_texture;
+layout (location = 2) flat out uint out_face;
+
+void main()
+{
+    // firstInstance is the record index, vertexOffset already points gl_VertexIndex into the arena
+    const ChunkSectionRecord record = section_records[push.records_index].data[gl_InstanceIndex];
+    const uvec2 vertex = push.vertices.vertices[gl_VertexIndex];
+
+    const uint geometry = vertex.x;
+    const vec3 position = vec3(geometry & 0x1Fu, (geometry >> 5) & 0x1Fu, (geometry >> 10) & 0x1Fu);
+    out_face = (geometry >> 15) & 0x7u;
+    out_uv = vec2((geometry >> 20) & 0x1Fu, (geometry >> 25) & 0x1Fu);
+    out_texture = vertex.y & 0xFFFFu;
+
+    gl_Position = push.view_projection * vec4(vec3(record.origin) + position, 1.0f);
+}
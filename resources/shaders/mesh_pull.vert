@@ -0,0 +1,23 @@
+#version 460
+#extension GL_EXT_buffer_reference : require
+
+// Vertex from types.hpp read as raw floats: vec3 position then vec3 color, no padding
+layout (buffer_reference, std430, buffer_reference_align = 4) readonly buffer VertexData {
+    float values[];
+};
+
+// MeshPushConstants in mesh_manager.hpp
+layout (push_constant) uniform PushConstants {
+    VertexData vertices;
+} push;
+
+layout (location = 0) out vec3 frag_color;
+
+void main()
+{
+    const uint base = uint(gl_VertexIndex) * 6u;
+    VertexData v = push.vertices;
+
+    gl_Position = vec4(v.values[base + 0], v.values[base + 1], v.values[base + 2], 1.0f);
+    frag_color = vec3(v.values[base + 3], v.values[base + 4], v.values[base + 5]);
+}
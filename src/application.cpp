@@ -1,10 +1,145 @@
 #include "engine.hpp"
+#include "logger.hpp"
 
+#include <charconv>
 
-int main()
+template<typename T>
+static bool parse_number(const std::string_view str, T& out)
 {
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), out);
+    return ec == std::errc {} && ptr == str.data() + str.size();
+}
+
+static bool parse_present_mode(const std::string_view str, vk::PresentModeKHR& out)
+{
+    if (str == "fifo") {
+        out = vk::PresentModeKHR::eFifo;
+    } else if (str == "fifo-relaxed") {
+        out = vk::PresentModeKHR::eFifoRelaxed;
+    } else if (str == "mailbox") {
+        out = vk::PresentModeKHR::eMailbox;
+    } else if (str == "immediate") {
+        out = vk::PresentModeKHR::eImmediate;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_extent(const std::string_view str, uint32_t& width, uint32_t& height)
+{
+    const size_t separator = str.find('x');
+    return separator != std::string_view::npos
+        && parse_number(str.substr(0, separator), width)
+        && parse_number(str.substr(separator + 1), height);
+}
+
+static bool parse_draw_format(const std::string_view str, vk::Format& out)
+{
+    if (str == "rgba16f") {
+        out = vk::Format::eR16G16B16A16Sfloat;
+    } else if (str == "b10g11r11") {
+        out = vk::Format::eB10G11R11UfloatPack32;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static constexpr std::string_view USAGE {
+    "[--headless] [--vertex-pulling] [--frames N] [--duration SECONDS] [--size WIDTHxHEIGHT] "
+    "[--frames-in-flight 1-4] [--present-mode fifo|fifo-relaxed|mailbox|immediate] "
+    "[--draw-format rgba16f|b10g11r11] [--max-draw-size WIDTHxHEIGHT] "
+    "[--gpu-trace FILE] [--cpu-trace FILE] [--frame-budget MS] [--memory-stats FILE] [--no-defrag] "
+    "[--no-dynamic-resolution] [--target-gpu-ms MS] [--min-render-scale 0.1-1] "
+    "[--no-swapchain-storage] [--no-tonemap] [--exposure SCALE] "
+    "[--workers N] [--view-distance CHUNKS] [--camera-speed BLOCKS_PER_SECOND]"
+};
+
+static bool parse_args(const int argc, char** argv, Minecraft::VkEngine::EngineSpec& spec)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg { argv[i] };
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--headless") {
+            spec.Headless = true;
+        } else if (arg == "--vertex-pulling") {
+            spec.VertexPulling = true;
+        } else if (arg == "--no-defrag") {
+            spec.DefragmentMeshes = false;
+        } else if (arg == "--no-dynamic-resolution") {
+            spec.DynamicResolution = false;
+        } else if (arg == "--no-swapchain-storage") {
+            spec.SwapchainStorage = false;
+        } else if (arg == "--no-tonemap") {
+            spec.Tonemap = false;
+        } else if (arg == "--frames" && has_value) {
+            if (!parse_number(argv[++i], spec.FrameCount))
+                return false;
+        } else if (arg == "--duration" && has_value) {
+            if (!parse_number(argv[++i], spec.Duration))
+                return false;
+        } else if (arg == "--frames-in-flight" && has_value) {
+            if (!parse_number(argv[++i], spec.FramesInFlight))
+                return false;
+        } else if (arg == "--present-mode" && has_value) {
+            if (!parse_present_mode(argv[++i], spec.PresentMode))
+                return false;
+        } else if (arg == "--draw-format" && has_value) {
+            if (!parse_draw_format(argv[++i], spec.DrawImageFormat))
+                return false;
+        } else if (arg == "--max-draw-size" && has_value) {
+            if (!parse_extent(argv[++i], spec.MaxDrawExtent.width, spec.MaxDrawExtent.height))
+                return false;
+        } else if (arg == "--gpu-trace" && has_value) {
+            spec.GpuTracePath = argv[++i];
+        } else if (arg == "--cpu-trace" && has_value) {
+            spec.CpuTracePath = argv[++i];
+        } else if (arg == "--memory-stats" && has_value) {
+            spec.MemoryStatsPath = argv[++i];
+        } else if (arg == "--frame-budget" && has_value) {
+            if (!parse_number(argv[++i], spec.FrameBudgetMs))
+                return false;
+        } else if (arg == "--target-gpu-ms" && has_value) {
+            if (!parse_number(argv[++i], spec.TargetGpuMs))
+                return false;
+        } else if (arg == "--min-render-scale" && has_value) {
+            if (!parse_number(argv[++i], spec.MinRenderScale))
+                return false;
+        } else if (arg == "--exposure" && has_value) {
+            if (!parse_number(argv[++i], spec.Exposure))
+                return false;
+        } else if (arg == "--workers" && has_value) {
+            if (!parse_number(argv[++i], spec.WorkerThreads))
+                return false;
+        } else if (arg == "--view-distance" && has_value) {
+            if (!parse_number(argv[++i], spec.ViewDistance))
+                return false;
+        } else if (arg == "--camera-speed" && has_value) {
+            if (!parse_number(argv[++i], spec.CameraSpeed))
+                return false;
+        } else if (arg == "--size" && has_value) {
+            if (!parse_extent(argv[++i], spec.Width, spec.Height))
+                return false;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(const int argc, char** argv)
+{
+    Minecraft::VkEngine::EngineSpec spec {};
+    if (!parse_args(argc, argv, spec)) {
+        LOG_ERROR("Usage: {} {}", argv[0], USAGE);
+        return EXIT_FAILURE;
+    }
+
     Minecraft::VkEngine::Engine engine { };
-    if (!engine.init(1280, 720)) {
+    if (!engine.init(spec)) {
         return EXIT_FAILURE;
     }
 
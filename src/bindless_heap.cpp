@@ -0,0 +1,250 @@
+#include "bindless_heap.hpp"
+#include "deferred_deleter.hpp"
+#include "helper.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+static constexpr std::array<vk::DescriptorType, static_cast<size_t>(BindlessType::eCount)> DESCRIPTOR_TYPES {
+    vk::DescriptorType::eSampledImage,
+    vk::DescriptorType::eStorageImage,
+    vk::DescriptorType::eStorageBuffer
+};
+
+vk::Result BindlessHeap::init(const vk::Device device, const vk::PhysicalDevice physical_device, DeferredDeleter& deleter)
+{
+    m_Device = device;
+    m_Deleter = &deleter;
+
+    vk::PhysicalDeviceVulkan12Properties properties12 {};
+    vk::PhysicalDeviceProperties2 properties { {}, &properties12 };
+    physical_device.getProperties2(&properties);
+
+    SlotAllocator& sampled_images = m_Slots[static_cast<size_t>(BindlessType::eSampledImage)];
+    SlotAllocator& storage_images = m_Slots[static_cast<size_t>(BindlessType::eStorageImage)];
+    SlotAllocator& storage_buffers = m_Slots[static_cast<size_t>(BindlessType::eStorageBuffer)];
+    sampled_images.Capacity = std::min({ MAX_SAMPLED_IMAGES,
+        properties12.maxDescriptorSetUpdateAfterBindSampledImages, properties12.maxPerStageDescriptorUpdateAfterBindSampledImages });
+    storage_images.Capacity = std::min({ MAX_STORAGE_IMAGES,
+        properties12.maxDescriptorSetUpdateAfterBindStorageImages, properties12.maxPerStageDescriptorUpdateAfterBindStorageImages });
+    storage_buffers.Capacity = std::min({ MAX_STORAGE_BUFFERS,
+        properties12.maxDescriptorSetUpdateAfterBindStorageBuffers, properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+
+    vk::Result res = create_samplers();
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    const std::array bindings {
+        vk::DescriptorSetLayoutBinding { SAMPLED_IMAGE_BINDING, vk::DescriptorType::eSampledImage, sampled_images.Capacity, vk::ShaderStageFlagBits::eAll },
+        vk::DescriptorSetLayoutBinding { STORAGE_IMAGE_BINDING, vk::DescriptorType::eStorageImage, storage_images.Capacity, vk::ShaderStageFlagBits::eAll },
+        vk::DescriptorSetLayoutBinding { STORAGE_BUFFER_BINDING, vk::DescriptorType::eStorageBuffer, storage_buffers.Capacity, vk::ShaderStageFlagBits::eAll },
+        vk::DescriptorSetLayoutBinding { SAMPLER_BINDING, vk::DescriptorType::eSampler, static_cast<uint32_t>(m_Samplers.size()), vk::ShaderStageFlagBits::eAll, m_Samplers.data() }
+    };
+
+    // Slots are written while older frames using other slots are still pending
+    constexpr vk::DescriptorBindingFlags array_flags {
+        vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending
+    };
+    constexpr std::array binding_flags {
+        array_flags,
+        array_flags,
+        array_flags,
+        vk::DescriptorBindingFlags {}
+    };
+
+    const vk::DescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info { binding_flags };
+    vk::DescriptorSetLayoutCreateInfo layout_info { vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool, bindings };
+    layout_info.pNext = &binding_flags_info;
+
+    res = m_Device.createDescriptorSetLayout(&layout_info, nullptr, &m_SetLayout);
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    const std::array pool_sizes {
+        vk::DescriptorPoolSize { vk::DescriptorType::eSampledImage, sampled_images.Capacity },
+        vk::DescriptorPoolSize { vk::DescriptorType::eStorageImage, storage_images.Capacity },
+        vk::DescriptorPoolSize { vk::DescriptorType::eStorageBuffer, storage_buffers.Capacity },
+        vk::DescriptorPoolSize { vk::DescriptorType::eSampler, static_cast<uint32_t>(m_Samplers.size()) }
+    };
+    const vk::DescriptorPoolCreateInfo pool_info { vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, pool_sizes };
+
+    res = m_Device.createDescriptorPool(&pool_info, nullptr, &m_Pool);
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    const vk::DescriptorSetAllocateInfo allocate_info { m_Pool, 1, &m_SetLayout };
+    res = m_Device.allocateDescriptorSets(&allocate_info, &m_Set);
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    constexpr std::array push_constants { vk::PushConstantRange { PUSH_CONSTANT_STAGES, 0, PUSH_CONSTANT_SIZE } };
+    const std::array set_layouts { m_SetLayout };
+    const vk::PipelineLayoutCreateInfo pipeline_layout_info = VkInit::pipeline_layout_create_info(set_layouts, push_constants);
+    res = m_Device.createPipelineLayout(&pipeline_layout_info, nullptr, &m_PipelineLayout);
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    LOG("Bindless heap: {} sampled images, {} storage images, {} storage buffers",
+        sampled_images.Capacity, storage_images.Capacity, storage_buffers.Capacity);
+    return vk::Result::eSuccess;
+}
+
+void BindlessHeap::destroy()
+{
+    // Released slots point back at the heap, the device is idle by now
+    if (m_Deleter) {
+        m_Deleter->flush();
+    }
+
+    if (m_PipelineLayout) {
+        m_Device.destroyPipelineLayout(m_PipelineLayout);
+    }
+
+    // Frees the set along with it
+    if (m_Pool) {
+        m_Device.destroyDescriptorPool(m_Pool);
+    }
+
+    if (m_SetLayout) {
+        m_Device.destroyDescriptorSetLayout(m_SetLayout);
+    }
+
+    for (auto& sampler : m_Samplers) {
+        if (sampler) {
+            m_Device.destroySampler(sampler);
+        }
+        sampler = nullptr;
+    }
+
+    m_PipelineLayout = nullptr;
+    m_Pool = nullptr;
+    m_SetLayout = nullptr;
+    m_Set = nullptr;
+    m_Slots = {};
+    m_Deleter = nullptr;
+}
+
+vk::Result BindlessHeap::create_samplers()
+{
+    struct SamplerDesc {
+        vk::Filter Filter;
+        vk::SamplerMipmapMode MipmapMode;
+        vk::SamplerAddressMode AddressMode;
+    };
+
+    // Same order as BindlessSampler, nearest keeps block textures crisp
+    constexpr std::array<SamplerDesc, static_cast<size_t>(BindlessSampler::eCount)> descs { {
+        { vk::Filter::eNearest, vk::SamplerMipmapMode::eNearest, vk::SamplerAddressMode::eRepeat },
+        { vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode::eRepeat },
+        { vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode::eClampToEdge },
+    } };
+
+    for (size_t i = 0; i < descs.size(); i++) {
+        vk::SamplerCreateInfo info {};
+        info.magFilter = descs[i].Filter;
+        info.minFilter = descs[i].Filter;
+        info.mipmapMode = descs[i].MipmapMode;
+        info.addressModeU = descs[i].AddressMode;
+        info.addressModeV = descs[i].AddressMode;
+        info.addressModeW = descs[i].AddressMode;
+        info.maxLod = VK_LOD_CLAMP_NONE;
+
+        if (const vk::Result res = m_Device.createSampler(&info, nullptr, &m_Samplers[i]); res != vk::Result::eSuccess) {
+            return res;
+        }
+    }
+
+    return vk::Result::eSuccess;
+}
+
+std::optional<uint32_t> BindlessHeap::allocate(const BindlessType type)
+{
+    SlotAllocator& slots = m_Slots[static_cast<size_t>(type)];
+    if (!slots.Free.empty()) {
+        const uint32_t index = slots.Free.back();
+        slots.Free.pop_back();
+        return index;
+    }
+
+    if (slots.Next >= slots.Capacity) {
+        LOG_ERROR("Bindless heap is out of {} slots ({})", vk::to_string(DESCRIPTOR_TYPES[static_cast<size_t>(type)]), slots.Capacity);
+        return std::nullopt;
+    }
+
+    return slots.Next++;
+}
+
+std::optional<uint32_t> BindlessHeap::add_sampled_image(const vk::ImageView view, const vk::ImageLayout layout)
+{
+    const auto index = allocate(BindlessType::eSampledImage);
+    if (!index.has_value()) {
+        return std::nullopt;
+    }
+
+    const vk::DescriptorImageInfo image_info { nullptr, view, layout };
+    vk::WriteDescriptorSet write { m_Set, SAMPLED_IMAGE_BINDING, index.value(), 1, vk::DescriptorType::eSampledImage };
+    write.pImageInfo = &image_info;
+    m_Device.updateDescriptorSets(1, &write, 0, nullptr);
+
+    return index;
+}
+
+std::optional<uint32_t> BindlessHeap::add_storage_image(const vk::ImageView view)
+{
+    const auto index = allocate(BindlessType::eStorageImage);
+    if (!index.has_value()) {
+        return std::nullopt;
+    }
+
+    const vk::DescriptorImageInfo image_info { nullptr, view, vk::ImageLayout::eGeneral };
+    vk::WriteDescriptorSet write { m_Set, STORAGE_IMAGE_BINDING, index.value(), 1, vk::DescriptorType::eStorageImage };
+    write.pImageInfo = &image_info;
+    m_Device.updateDescriptorSets(1, &write, 0, nullptr);
+
+    return index;
+}
+
+std::optional<uint32_t> BindlessHeap::add_storage_buffer(const vk::Buffer buffer, const vk::DeviceSize offset, const vk::DeviceSize range)
+{
+    const auto index = allocate(BindlessType::eStorageBuffer);
+    if (!index.has_value()) {
+        return std::nullopt;
+    }
+
+    const vk::DescriptorBufferInfo buffer_info { buffer, offset, range };
+    vk::WriteDescriptorSet write { m_Set, STORAGE_BUFFER_BINDING, index.value(), 1, vk::DescriptorType::eStorageBuffer };
+    write.pBufferInfo = &buffer_info;
+    m_Device.updateDescriptorSets(1, &write, 0, nullptr);
+
+    return index;
+}
+
+void BindlessHeap::release(const BindlessType type, const uint32_t index)
+{
+    assert(index < m_Slots[static_cast<size_t>(type)].Next);
+    m_Deleter->push(&BindlessHeap::free_slot, this, static_cast<uint64_t>(type) << 32 | index);
+}
+
+void BindlessHeap::free_slot(void* const heap, const uint64_t value)
+{
+    const auto type = static_cast<BindlessType>(value >> 32);
+    static_cast<BindlessHeap*>(heap)->m_Slots[static_cast<size_t>(type)].Free.push_back(static_cast<uint32_t>(value));
+}
+
+void BindlessHeap::bind(const vk::CommandBuffer cmd, const vk::PipelineBindPoint bind_point) const
+{
+    cmd.bindDescriptorSets(bind_point, m_PipelineLayout, 0, 1, &m_Set, 0, nullptr);
+}
+
+uint32_t BindlessHeap::get_used(const BindlessType type) const
+{
+    const SlotAllocator& slots = m_Slots[static_cast<size_t>(type)];
+    return slots.Next - static_cast<uint32_t>(slots.Free.size());
+}
+
+}
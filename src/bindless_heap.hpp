@@ -0,0 +1,88 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+class DeferredDeleter;
+
+enum class BindlessType : uint8_t {
+    eSampledImage,
+    eStorageImage,
+    eStorageBuffer,
+    eCount
+};
+
+// Immutable samplers at BindlessHeap::SAMPLER_BINDING, indexed by this
+enum class BindlessSampler : uint8_t {
+    eNearestRepeat,
+    eLinearRepeat,
+    eLinearClamp,
+    eCount
+};
+
+/*
+ * One update after bind descriptor set holding every sampled image, storage image and storage buffer,
+ * bound once per command buffer at set 0 of a pipeline layout shared by all pipelines.
+ * Resources are referred to by their slot index, passed to shaders through push constants,
+ * see resources/shaders/bindless.glsl for the shader side.
+ *
+ * Slots are written as soon as they are added, partially bound arrays let unused slots stay empty.
+ * Released slots go through the DeferredDeleter, they are reused once the frames that may still index them are complete.
+ */
+class BindlessHeap {
+public:
+    // Upper bounds, clamped to the device update after bind limits
+    static constexpr uint32_t MAX_SAMPLED_IMAGES = 16384;
+    static constexpr uint32_t MAX_STORAGE_IMAGES = 1024;
+    static constexpr uint32_t MAX_STORAGE_BUFFERS = 4096;
+
+    static constexpr uint32_t SAMPLED_IMAGE_BINDING = 0;
+    static constexpr uint32_t STORAGE_IMAGE_BINDING = 1;
+    static constexpr uint32_t STORAGE_BUFFER_BINDING = 2;
+    static constexpr uint32_t SAMPLER_BINDING = 3;
+
+    // The minimum every device supports, the whole block is visible to all stages
+    static constexpr uint32_t PUSH_CONSTANT_SIZE = 128;
+    static constexpr vk::ShaderStageFlags PUSH_CONSTANT_STAGES { vk::ShaderStageFlagBits::eAll };
+
+    [[nodiscard]] vk::Result init(vk::Device device, vk::PhysicalDevice physical_device, DeferredDeleter& deleter);
+    void destroy();
+
+    [[nodiscard]] std::optional<uint32_t> add_sampled_image(vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+    [[nodiscard]] std::optional<uint32_t> add_storage_image(vk::ImageView view);
+    [[nodiscard]] std::optional<uint32_t> add_storage_buffer(vk::Buffer buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = vk::WholeSize);
+
+    // The slot can be reused once the frame being recorded is done with it
+    void release(BindlessType type, uint32_t index);
+
+    // Binds the heap at set 0, for every bind point it will be used with
+    void bind(vk::CommandBuffer cmd, vk::PipelineBindPoint bind_point) const;
+
+    [[nodiscard]] vk::PipelineLayout get_pipeline_layout() const { return m_PipelineLayout; }
+    [[nodiscard]] vk::DescriptorSetLayout get_set_layout() const { return m_SetLayout; }
+    [[nodiscard]] uint32_t get_capacity(BindlessType type) const { return m_Slots[static_cast<size_t>(type)].Capacity; }
+    [[nodiscard]] uint32_t get_used(BindlessType type) const;
+
+private:
+    struct SlotAllocator {
+        uint32_t Capacity { 0 };
+        uint32_t Next { 0 };
+        std::vector<uint32_t> Free;
+    };
+
+    vk::Device m_Device { nullptr };
+    DeferredDeleter* m_Deleter { nullptr };
+    vk::DescriptorPool m_Pool { nullptr };
+    vk::DescriptorSetLayout m_SetLayout { nullptr };
+    vk::DescriptorSet m_Set { nullptr };
+    vk::PipelineLayout m_PipelineLayout { nullptr };
+    std::array<vk::Sampler, static_cast<size_t>(BindlessSampler::eCount)> m_Samplers {};
+
+    std::array<SlotAllocator, static_cast<size_t>(BindlessType::eCount)> m_Slots {};
+
+    [[nodiscard]] vk::Result create_samplers();
+    [[nodiscard]] std::optional<uint32_t> allocate(BindlessType type);
+    // DeferredDeleter release function, value packs the type above the index
+    static void free_slot(void* heap, uint64_t value);
+};
+
+}
@@ -0,0 +1,134 @@
+#include "chunk.hpp"
+
+namespace Minecraft {
+
+static uint32_t count_non_air(const std::span<const BlockId> blocks)
+{
+    return static_cast<uint32_t>(std::ranges::count_if(blocks, [](const BlockId block) { return block != BLOCK_AIR; }));
+}
+
+BlockId Chunk::get(const uint32_t x, const uint32_t y, const uint32_t z) const
+{
+    assert(y < HEIGHT);
+    return m_Sections[y / ChunkSection::SIZE].get(x, y % ChunkSection::SIZE, z);
+}
+
+void Chunk::set(const uint32_t x, const uint32_t y, const uint32_t z, const BlockId block)
+{
+    assert(y < HEIGHT);
+    const uint32_t section = y / ChunkSection::SIZE;
+    const uint32_t local_y = y % ChunkSection::SIZE;
+
+    ChunkSection& target = m_Sections[section];
+    const BlockId previous = target.get(x, local_y, z);
+    if (previous == block) {
+        return;
+    }
+
+    target.set(x, local_y, z, block);
+    m_NonAirCounts[section] += static_cast<uint16_t>((block != BLOCK_AIR) - (previous != BLOCK_AIR));
+    mark_dirty(section, local_y);
+}
+
+void Chunk::set_section(const uint32_t section, const std::span<const BlockId, ChunkSection::VOLUME> blocks)
+{
+    m_Sections[section].set_all(blocks);
+    m_NonAirCounts[section] = static_cast<uint16_t>(count_non_air(blocks));
+    mark_dirty(section, 0);
+    mark_dirty(section, ChunkSection::SIZE - 1);
+}
+
+void Chunk::fill_section(const uint32_t section, const BlockId block)
+{
+    m_Sections[section].fill(block);
+    m_NonAirCounts[section] = block != BLOCK_AIR ? ChunkSection::VOLUME : 0;
+    mark_dirty(section, 0);
+    mark_dirty(section, ChunkSection::SIZE - 1);
+}
+
+void Chunk::mark_dirty(const uint32_t section, const uint32_t local_y)
+{
+    m_DirtyMask |= 1u << section;
+    if (local_y == 0 && section > 0) {
+        m_DirtyMask |= 1u << (section - 1);
+    } else if (local_y == ChunkSection::SIZE - 1 && section + 1 < SECTION_COUNT) {
+        m_DirtyMask |= 1u << (section + 1);
+    }
+}
+
+void Chunk::gather_padded(const uint32_t section, const Neighbors& neighbors, const std::span<BlockId, PADDED_VOLUME> out) const
+{
+    constexpr uint32_t size = ChunkSection::SIZE;
+    const auto padded = [](const uint32_t x, const uint32_t y, const uint32_t z) {
+        return x + z * PADDED_SIZE + y * PADDED_AREA;
+    };
+
+    std::ranges::fill(out, BLOCK_AIR);
+
+    std::array<BlockId, ChunkSection::VOLUME> blocks;
+    m_Sections[section].get_all(blocks);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t z = 0; z < size; z++) {
+            const BlockId* row = &blocks[ChunkSection::index(0, y, z)];
+            std::copy_n(row, size, &out[padded(1, y + 1, z + 1)]);
+        }
+    }
+
+    // Each neighbor shows the layer facing us, the one on its opposite face
+    std::array<BlockId, ChunkSection::AREA> layer;
+    if (section + 1 < SECTION_COUNT) {
+        m_Sections[section + 1].get_layer(BlockFace::eNegY, layer);
+        for (uint32_t i = 0; i < ChunkSection::AREA; i++) {
+            out[padded(i % size + 1, size + 1, i / size + 1)] = layer[i];
+        }
+    }
+    if (section > 0) {
+        m_Sections[section - 1].get_layer(BlockFace::ePosY, layer);
+        for (uint32_t i = 0; i < ChunkSection::AREA; i++) {
+            out[padded(i % size + 1, 0, i / size + 1)] = layer[i];
+        }
+    }
+
+    if (const Chunk* chunk = neighbors[static_cast<size_t>(BlockFace::ePosX)]) {
+        chunk->m_Sections[section].get_layer(BlockFace::eNegX, layer);
+        for (uint32_t i = 0; i < ChunkSection::AREA; i++) {
+            out[padded(size + 1, i / size + 1, i % size + 1)] = layer[i];
+        }
+    }
+    if (const Chunk* chunk = neighbors[static_cast<size_t>(BlockFace::eNegX)]) {
+        chunk->m_Sections[section].get_layer(BlockFace::ePosX, layer);
+        for (uint32_t i = 0; i < ChunkSection::AREA; i++) {
+            out[padded(0, i / size + 1, i % size + 1)] = layer[i];
+        }
+    }
+    if (const Chunk* chunk = neighbors[static_cast<size_t>(BlockFace::ePosZ)]) {
+        chunk->m_Sections[section].get_layer(BlockFace::eNegZ, layer);
+        for (uint32_t i = 0; i < ChunkSection::AREA; i++) {
+            out[padded(i % size + 1, i / size + 1, size + 1)] = layer[i];
+        }
+    }
+    if (const Chunk* chunk = neighbors[static_cast<size_t>(BlockFace::eNegZ)]) {
+        chunk->m_Sections[section].get_layer(BlockFace::ePosZ, layer);
+        for (uint32_t i = 0; i < ChunkSection::AREA; i++) {
+            out[padded(i % size + 1, i / size + 1, 0)] = layer[i];
+        }
+    }
+}
+
+void Chunk::compact()
+{
+    for (ChunkSection& section : m_Sections) {
+        section.compact();
+    }
+}
+
+size_t Chunk::memory_usage() const
+{
+    size_t bytes = sizeof(Chunk) - sizeof(m_Sections);
+    for (const ChunkSection& section : m_Sections) {
+        bytes += section.memory_usage();
+    }
+    return bytes;
+}
+
+}
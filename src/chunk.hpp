@@ -0,0 +1,55 @@
+#pragma once
+#include "chunk_section.hpp"
+
+namespace Minecraft {
+
+/*
+ * Column of ChunkSection, SECTION_COUNT high.
+ * Per section bookkeeping (non air counts, dirty bits) lives in its own small arrays rather than in the
+ * sections, scanning a column for empty or changed sections never touches the block payloads.
+ *
+ * Edits mark their section dirty along with the vertical neighbor when they land on its border,
+ * horizontal neighbors live in other chunks and are the caller's business.
+ */
+class Chunk {
+public:
+    static constexpr uint32_t SECTION_COUNT = 16;
+    static constexpr uint32_t HEIGHT = SECTION_COUNT * ChunkSection::SIZE;
+
+    // Section with a one block border taken from its neighbors, what meshing needs to cull faces.
+    // Indexed (x + 1) + (z + 1) * PADDED_SIZE + (y + 1) * PADDED_AREA, edges and corners are left as air
+    static constexpr uint32_t PADDED_SIZE = ChunkSection::SIZE + 2;
+    static constexpr uint32_t PADDED_AREA = PADDED_SIZE * PADDED_SIZE;
+    static constexpr uint32_t PADDED_VOLUME = PADDED_AREA * PADDED_SIZE;
+
+    // Indexed by BlockFace, null reads as air. The Y entries are unused, those neighbors are sections of this chunk
+    using Neighbors = std::array<const Chunk*, 6>;
+
+    [[nodiscard]] BlockId get(uint32_t x, uint32_t y, uint32_t z) const;
+    void set(uint32_t x, uint32_t y, uint32_t z, BlockId block);
+
+    void set_section(uint32_t section, std::span<const BlockId, ChunkSection::VOLUME> blocks);
+    void fill_section(uint32_t section, BlockId block);
+    [[nodiscard]] const ChunkSection& get_section(const uint32_t section) const { return m_Sections[section]; }
+
+    void gather_padded(uint32_t section, const Neighbors& neighbors, std::span<BlockId, PADDED_VOLUME> out) const;
+
+    [[nodiscard]] bool is_section_empty(const uint32_t section) const { return m_NonAirCounts[section] == 0; }
+    [[nodiscard]] uint32_t get_non_air_count(const uint32_t section) const { return m_NonAirCounts[section]; }
+    // Bit per section changed since its last clear_dirty
+    [[nodiscard]] uint32_t get_dirty_mask() const { return m_DirtyMask; }
+    void clear_dirty(const uint32_t section) { m_DirtyMask &= ~(1u << section); }
+
+    // Compacts every section palette
+    void compact();
+    [[nodiscard]] size_t memory_usage() const;
+
+private:
+    std::array<uint16_t, SECTION_COUNT> m_NonAirCounts {};
+    uint32_t m_DirtyMask { 0 };
+    std::array<ChunkSection, SECTION_COUNT> m_Sections {};
+
+    void mark_dirty(uint32_t section, uint32_t local_y);
+};
+
+}
@@ -0,0 +1,236 @@
+#include "chunk_mesher.hpp"
+
+namespace Minecraft {
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define CHUNK_MESHER_SSE2 1
+#endif
+
+static_assert(BLOCK_AIR == 0, "solid_mask compares against zero");
+
+static constexpr uint32_t PADDED_SIZE = Chunk::PADDED_SIZE;
+static constexpr uint32_t PADDED_AREA = Chunk::PADDED_AREA;
+static constexpr uint32_t INNER_MASK = 0xFFFF;
+
+static constexpr uint32_t axis_of(const BlockFace face) { return static_cast<uint32_t>(face) / 2; }
+static constexpr bool is_positive(const BlockFace face) { return (static_cast<uint32_t>(face) & 1) == 0; }
+
+// Local coordinates of a point on the planes of an axis: X planes are (z, y), Y planes (x, z), Z planes (x, y)
+static glm::uvec3 to_local(const uint32_t axis, const uint32_t slice, const uint32_t a, const uint32_t b)
+{
+    switch (axis) {
+    case 0:
+        return { slice, b, a };
+    case 1:
+        return { a, slice, b };
+    default:
+        return { a, b, slice };
+    }
+}
+
+static uint32_t padded_index(const glm::uvec3 local)
+{
+    return (local.x + 1) + (local.z + 1) * PADDED_SIZE + (local.y + 1) * PADDED_AREA;
+}
+
+// Bit per non air block of a padded row along X
+static uint32_t solid_mask(const BlockId* row)
+{
+#ifdef CHUNK_MESHER_SSE2
+    const __m128i air = _mm_setzero_si128();
+    const __m128i low = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)), air);
+    const __m128i high = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 8)), air);
+    uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(low, high))) & INNER_MASK;
+#else
+    uint32_t mask = 0;
+    for (uint32_t x = 0; x < 16; x++) {
+        mask |= static_cast<uint32_t>(row[x] != BLOCK_AIR) << x;
+    }
+#endif
+    mask |= static_cast<uint32_t>(row[16] != BLOCK_AIR) << 16 | static_cast<uint32_t>(row[17] != BLOCK_AIR) << 17;
+    return mask;
+}
+
+ChunkMesher::ChunkMesher(const std::span<const BlockFaceTextures> textures)
+    : m_Textures(textures)
+{
+}
+
+void ChunkMesher::mesh(const Chunk& chunk, const uint32_t section, const Chunk::Neighbors& neighbors, ChunkMesh& out)
+{
+    if (chunk.is_section_empty(section)) {
+        out.clear();
+        return;
+    }
+
+    chunk.gather_padded(section, neighbors, m_Padded);
+    mesh(m_Padded, out);
+}
+
+void ChunkMesher::mesh(const std::span<const BlockId, Chunk::PADDED_VOLUME> padded, ChunkMesh& out)
+{
+    out.clear();
+    build_columns(padded);
+    cull_faces();
+
+    for (uint32_t face = 0; face < 6; face++) {
+        merge_faces(static_cast<BlockFace>(face), padded, out);
+    }
+}
+
+#pragma region Culling
+
+void ChunkMesher::build_columns(const std::span<const BlockId, Chunk::PADDED_VOLUME> padded)
+{
+    auto& x_columns = m_Columns[0];
+    auto& y_columns = m_Columns[1];
+    auto& z_columns = m_Columns[2];
+    std::ranges::fill(y_columns, 0u);
+    std::ranges::fill(z_columns, 0u);
+
+    // Rows along X are contiguous, the other two axes are scattered from their set bits
+    for (uint32_t y = 0; y < PADDED_SIZE; y++) {
+        for (uint32_t z = 0; z < PADDED_SIZE; z++) {
+            const uint32_t bits = solid_mask(&padded[z * PADDED_SIZE + y * PADDED_AREA]);
+            x_columns[z + y * PADDED_SIZE] = bits;
+
+            for (uint32_t rest = bits; rest != 0; rest &= rest - 1) {
+                const uint32_t x = std::countr_zero(rest);
+                y_columns[x + z * PADDED_SIZE] |= 1u << y;
+                z_columns[x + y * PADDED_SIZE] |= 1u << z;
+            }
+        }
+    }
+}
+
+void ChunkMesher::cull_faces()
+{
+    // A face shows where the next block along the axis is air, then the padding bits are dropped
+    for (uint32_t axis = 0; axis < 3; axis++) {
+        const auto& columns = m_Columns[axis];
+        auto& positive = m_Visible[axis * 2];
+        auto& negative = m_Visible[axis * 2 + 1];
+
+        uint32_t i = 0;
+#ifdef CHUNK_MESHER_SSE2
+        const __m128i inner = _mm_set1_epi32(INNER_MASK);
+        for (; i + 4 <= COLUMN_COUNT; i += 4) {
+            const __m128i column = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&columns[i]));
+            const __m128i pos = _mm_andnot_si128(_mm_srli_epi32(column, 1), column);
+            const __m128i neg = _mm_andnot_si128(_mm_slli_epi32(column, 1), column);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&positive[i]), _mm_and_si128(_mm_srli_epi32(pos, 1), inner));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&negative[i]), _mm_and_si128(_mm_srli_epi32(neg, 1), inner));
+        }
+#endif
+        for (; i < COLUMN_COUNT; i++) {
+            const uint32_t column = columns[i];
+            positive[i] = (column & ~(column >> 1)) >> 1 & INNER_MASK;
+            negative[i] = (column & ~(column << 1)) >> 1 & INNER_MASK;
+        }
+    }
+}
+
+#pragma endregion
+
+#pragma region Greedy merging
+
+void ChunkMesher::merge_faces(const BlockFace face, const std::span<const BlockId, Chunk::PADDED_VOLUME> padded, ChunkMesh& out)
+{
+    const uint32_t axis = axis_of(face);
+    const auto& visible = m_Visible[static_cast<uint32_t>(face)];
+
+    // Transpose the columns into slices: row b of slice s gets bit a when the face at (s, a, b) shows
+    std::ranges::fill(m_Planes, uint16_t { 0 });
+    bool any = false;
+    for (uint32_t b = 0; b < SIZE; b++) {
+        for (uint32_t a = 0; a < SIZE; a++) {
+            for (uint32_t bits = visible[(a + 1) + (b + 1) * PADDED_SIZE]; bits != 0; bits &= bits - 1) {
+                m_Planes[std::countr_zero(bits) * SIZE + b] |= static_cast<uint16_t>(1u << a);
+                any = true;
+            }
+        }
+    }
+
+    if (!any) {
+        return;
+    }
+
+    const auto block_at = [&](const uint32_t slice, const uint32_t a, const uint32_t b) {
+        return padded[padded_index(to_local(axis, slice, a, b))];
+    };
+
+    for (uint32_t slice = 0; slice < SIZE; slice++) {
+        uint16_t* plane = &m_Planes[slice * SIZE];
+
+        for (uint32_t b = 0; b < SIZE; b++) {
+            uint32_t row = plane[b];
+            while (row != 0) {
+                const uint32_t a = std::countr_zero(row);
+                const BlockId block = block_at(slice, a, b);
+
+                uint32_t width = 1;
+                while (a + width < SIZE && (row >> (a + width) & 1) != 0 && block_at(slice, a + width, b) == block) {
+                    width++;
+                }
+
+                const uint32_t run = ((1u << width) - 1) << a;
+                row &= ~run;
+
+                // Grow across the next rows while they show the whole run with the same block
+                uint32_t height = 1;
+                for (; b + height < SIZE; height++) {
+                    uint16_t& next = plane[b + height];
+                    if ((next & run) != run) {
+                        break;
+                    }
+
+                    bool same = true;
+                    for (uint32_t i = a; i < a + width && same; i++) {
+                        same = block_at(slice, i, b + height) == block;
+                    }
+
+                    if (!same) {
+                        break;
+                    }
+
+                    next &= static_cast<uint16_t>(~run);
+                }
+
+                emit_quad(face, slice, a, b, width, height, block, out);
+            }
+        }
+    }
+}
+
+void ChunkMesher::emit_quad(const BlockFace face, const uint32_t slice, const uint32_t a, const uint32_t b, const uint32_t width, const uint32_t height,
+    const BlockId block, ChunkMesh& out) const
+{
+    const uint32_t axis = axis_of(face);
+    const bool positive = is_positive(face);
+    // Positive faces sit on the far side of their block
+    const uint32_t plane = slice + (positive ? 1 : 0);
+    const uint32_t texture = get_texture(block, face);
+
+    // (a, b, normal) is right handed on Z planes and left handed on X and Y ones,
+    // the corner order is reversed when it would be clockwise seen from the normal
+    const bool flip = (axis == 2) != positive;
+    static constexpr std::array<glm::uvec2, 4> corners { glm::uvec2 { 0, 0 }, glm::uvec2 { 1, 0 }, glm::uvec2 { 1, 1 }, glm::uvec2 { 0, 1 } };
+    static constexpr std::array<uint32_t, 4> forward { 0, 1, 2, 3 };
+    static constexpr std::array<uint32_t, 4> reversed { 0, 3, 2, 1 };
+
+    const auto base = static_cast<uint32_t>(out.Vertices.size());
+    for (const uint32_t corner : flip ? reversed : forward) {
+        const uint32_t u = corners[corner].x * width;
+        const uint32_t v = corners[corner].y * height;
+        const glm::uvec3 position = to_local(axis, plane, a + u, b + v);
+        // Side textures run top to bottom along +Y
+        const uint32_t tex_v = axis == 1 ? v : height - v;
+        out.Vertices.push_back(PackedChunkVertex::pack(position.x, position.y, position.z, face, 0, u, tex_v, texture));
+    }
+
+    out.Indices.insert(out.Indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+}
+
+#pragma endregion
+
+}
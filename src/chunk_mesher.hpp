@@ -0,0 +1,75 @@
+#pragma once
+#include "chunk.hpp"
+
+namespace Minecraft {
+
+// Texture array layer of each face of a block type, indexed by BlockFace
+using BlockFaceTextures = std::array<uint16_t, 6>;
+
+struct ChunkMesh {
+    // Four per quad, drawn with VertexLayoutPackedChunk
+    std::vector<PackedChunkVertex> Vertices;
+    // Two triangles per quad, 32 bit like MeshManager takes them
+    std::vector<uint32_t> Indices;
+
+    void clear()
+    {
+        Vertices.clear();
+        Indices.clear();
+    }
+
+    [[nodiscard]] bool empty() const { return Vertices.empty(); }
+    [[nodiscard]] uint32_t get_quad_count() const { return static_cast<uint32_t>(Vertices.size() / 4); }
+};
+
+/*
+ * Turns a chunk section into quads of PackedChunkVertex, one section at a time.
+ *
+ * Occupancy is kept as bit columns, one 18 bit column per padded row along each axis, so hidden
+ * faces are culled for a whole column with a shift and an and-not, four columns per SSE2 instruction.
+ * The faces left are transposed into one 16x16 bitmask plane per slice, where runs of the same
+ * block are greedily grown along the row then across rows into a single quad.
+ *
+ * Every non air block is opaque and ambient occlusion is not computed, so faces only merge by block type.
+ * Quads are counter-clockwise seen from outside the block. A mesher owns its scratch memory,
+ * keep one per thread.
+ */
+class ChunkMesher {
+public:
+    // Blocks past the end of the table use their id as texture layer.
+    // The table is not copied, it has to outlive the mesher or the next set_textures()
+    explicit ChunkMesher(std::span<const BlockFaceTextures> textures = {});
+
+    void set_textures(const std::span<const BlockFaceTextures> textures) { m_Textures = textures; }
+
+    // Replaces out with the mesh of the section, empty when nothing is visible
+    void mesh(const Chunk& chunk, uint32_t section, const Chunk::Neighbors& neighbors, ChunkMesh& out);
+    void mesh(std::span<const BlockId, Chunk::PADDED_VOLUME> padded, ChunkMesh& out);
+
+private:
+    static constexpr uint32_t SIZE = ChunkSection::SIZE;
+    static constexpr uint32_t COLUMN_COUNT = Chunk::PADDED_AREA;
+
+    std::span<const BlockFaceTextures> m_Textures;
+
+    std::array<BlockId, Chunk::PADDED_VOLUME> m_Padded {};
+    // Indexed by axis then by the two other padded coordinates: X columns z + y * 18, Y columns x + z * 18,
+    // Z columns x + y * 18. Bit i is the block at padded coordinate i along the axis
+    std::array<std::array<uint32_t, COLUMN_COUNT>, 3> m_Columns {};
+    // Same indexing by BlockFace, bit i is a visible face of the block at local coordinate i
+    std::array<std::array<uint32_t, COLUMN_COUNT>, 6> m_Visible {};
+    // One slice after the other, a 16 bit row per line of the slice
+    std::array<uint16_t, SIZE * SIZE> m_Planes {};
+
+    void build_columns(std::span<const BlockId, Chunk::PADDED_VOLUME> padded);
+    void cull_faces();
+    void merge_faces(BlockFace face, std::span<const BlockId, Chunk::PADDED_VOLUME> padded, ChunkMesh& out);
+    void emit_quad(BlockFace face, uint32_t slice, uint32_t a, uint32_t b, uint32_t width, uint32_t height, BlockId block, ChunkMesh& out) const;
+
+    [[nodiscard]] uint16_t get_texture(const BlockId block, const BlockFace face) const
+    {
+        return block < m_Textures.size() ? m_Textures[block][static_cast<uint32_t>(face)] : block;
+    }
+};
+
+}
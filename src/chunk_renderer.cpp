@@ -0,0 +1,506 @@
+#include "chunk_renderer.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+// Gribb and Hartmann, rows of a [0, 1] depth projection. Normals point inside and are normalized
+static std::array<glm::vec4, 6> extract_frustum_planes(const glm::mat4& m)
+{
+    const glm::vec4 row0 { m[0][0], m[1][0], m[2][0], m[3][0] };
+    const glm::vec4 row1 { m[0][1], m[1][1], m[2][1], m[3][1] };
+    const glm::vec4 row2 { m[0][2], m[1][2], m[2][2], m[3][2] };
+    const glm::vec4 row3 { m[0][3], m[1][3], m[2][3], m[3][3] };
+
+    std::array planes { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row2, row3 - row2 };
+    for (glm::vec4& plane : planes) {
+        plane /= glm::length(glm::vec3 { plane });
+    }
+    return planes;
+}
+
+vk::Result ChunkRenderer::init(GpuManager& gpu, UploadManager& uploads, BindlessHeap& heap, const ChunkRendererSpec& spec)
+{
+    m_Gpu = &gpu;
+    m_Uploads = &uploads;
+    m_Heap = &heap;
+    m_Allocator = gpu.get_allocator();
+    m_Spec = spec;
+
+    constexpr vk::BufferUsageFlags vertex_usage { vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress | vk::BufferUsageFlagBits::eTransferDst };
+    constexpr vk::BufferUsageFlags index_usage { vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst };
+    constexpr vk::BufferUsageFlags record_usage { vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst };
+    constexpr vk::BufferUsageFlags command_usage { vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst };
+
+    const vk::DeviceSize record_count = get_max_draws();
+    const std::array<std::pair<AllocatedBuffer*, std::pair<vk::DeviceSize, vk::BufferUsageFlags>>, 5> buffers { {
+        { &m_VertexArena, { m_Spec.VertexCapacity, vertex_usage } },
+        { &m_IndexArena, { m_Spec.IndexCapacity, index_usage } },
+        { &m_Records, { record_count * sizeof(ChunkSectionRecord), record_usage } },
+        { &m_Commands, { record_count * sizeof(vk::DrawIndexedIndirectCommand), command_usage } },
+        { &m_Count, { sizeof(uint32_t), command_usage } },
+    } };
+
+    for (const auto& [buffer, desc] : buffers) {
+        const auto res = create_buffer(desc.first, desc.second);
+        if (!res.has_value()) {
+            destroy();
+            return res.error();
+        }
+        *buffer = res.value();
+    }
+
+    const vk::BufferDeviceAddressInfo address_info { m_VertexArena.Buffer };
+    m_VertexAddress = gpu.get_device().getBufferAddress(address_info);
+
+    VmaVirtualBlockCreateInfo block_info {};
+    block_info.size = m_Spec.VertexCapacity;
+    if (const VkResult res = vmaCreateVirtualBlock(&block_info, &m_VertexBlock); res != VK_SUCCESS) {
+        destroy();
+        return static_cast<vk::Result>(res);
+    }
+
+    block_info.size = m_Spec.IndexCapacity;
+    if (const VkResult res = vmaCreateVirtualBlock(&block_info, &m_IndexBlock); res != VK_SUCCESS) {
+        destroy();
+        return static_cast<vk::Result>(res);
+    }
+
+    const auto records_index = heap.add_storage_buffer(m_Records.Buffer);
+    const auto commands_index = heap.add_storage_buffer(m_Commands.Buffer);
+    const auto count_index = heap.add_storage_buffer(m_Count.Buffer);
+    if (!records_index.has_value() || !commands_index.has_value() || !count_index.has_value()) {
+        LOG_ERROR("No storage buffer slot left for the chunk renderer");
+        destroy();
+        return vk::Result::eErrorOutOfPoolMemory;
+    }
+    m_RecordsIndex = records_index.value();
+    m_CommandsIndex = commands_index.value();
+    m_CountIndex = count_index.value();
+
+    m_Slots.reserve(m_Spec.MaxChunks);
+    return vk::Result::eSuccess;
+}
+
+void ChunkRenderer::destroy()
+{
+    // Retired ranges call back into the blocks, the device is idle by now
+    if (m_Gpu) {
+        m_Gpu->get_deleter().flush();
+    }
+    for (const ChunkSlot& slot : m_Slots) {
+        free_ranges(slot);
+    }
+    m_Slots.clear();
+    m_FreeSlots.clear();
+    m_PendingWrites.clear();
+    m_ChunkCount = 0;
+    m_CompactRequested = false;
+    m_CompactCursor = UINT32_MAX;
+
+    if (m_VertexBlock) {
+        vmaDestroyVirtualBlock(m_VertexBlock);
+        m_VertexBlock = nullptr;
+    }
+    if (m_IndexBlock) {
+        vmaDestroyVirtualBlock(m_IndexBlock);
+        m_IndexBlock = nullptr;
+    }
+
+    for (AllocatedBuffer* buffer : { &m_VertexArena, &m_IndexArena, &m_Records, &m_Commands, &m_Count }) {
+        destroy_buffer(*buffer);
+    }
+    m_VertexAddress = 0;
+}
+
+std::expected<AllocatedBuffer, vk::Result> ChunkRenderer::create_buffer(const vk::DeviceSize size, const vk::BufferUsageFlags usage) const
+{
+    const vk::BufferCreateInfo buffer_info {
+        {},
+        size,
+        usage,
+        vk::SharingMode::eExclusive
+    };
+
+    VmaAllocationCreateInfo alloc_info {};
+    alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    alloc_info.requiredFlags = static_cast<VkMemoryPropertyFlags>(vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    VkBuffer buffer;
+    VmaAllocation allocation;
+    const VkResult res = vmaCreateBuffer(m_Allocator, reinterpret_cast<const VkBufferCreateInfo*>(&buffer_info), &alloc_info,
+        &buffer, &allocation, nullptr);
+    if (res != VK_SUCCESS) {
+        return std::unexpected(static_cast<vk::Result>(res));
+    }
+
+    m_Gpu->get_memory().track(MemoryCategory::eMeshes, allocation);
+    return AllocatedBuffer { buffer, allocation, size };
+}
+
+void ChunkRenderer::destroy_buffer(AllocatedBuffer& buffer) const
+{
+    if (buffer.Buffer) {
+        m_Gpu->get_memory().untrack(MemoryCategory::eMeshes, buffer.Allocation);
+        vmaDestroyBuffer(m_Allocator, buffer.Buffer, buffer.Allocation);
+    }
+    buffer = {};
+}
+
+void ChunkRenderer::free_ranges(const ChunkSlot& slot) const
+{
+    if (slot.Vertices) {
+        vmaVirtualFree(m_VertexBlock, slot.Vertices);
+    }
+    if (slot.Indices) {
+        vmaVirtualFree(m_IndexBlock, slot.Indices);
+    }
+}
+
+void ChunkRenderer::retire_ranges(const VmaVirtualAllocation vertices, const VmaVirtualAllocation indices)
+{
+    DeferredDeleter& deleter = m_Gpu->get_deleter();
+    if (vertices) {
+        deleter.push(&ChunkRenderer::free_vertex_range, this, std::bit_cast<uint64_t>(vertices));
+    }
+    if (indices) {
+        deleter.push(&ChunkRenderer::free_index_range, this, std::bit_cast<uint64_t>(indices));
+    }
+}
+
+void ChunkRenderer::free_vertex_range(void* const renderer, const uint64_t value)
+{
+    vmaVirtualFree(static_cast<ChunkRenderer*>(renderer)->m_VertexBlock, std::bit_cast<VmaVirtualAllocation>(value));
+}
+
+void ChunkRenderer::free_index_range(void* const renderer, const uint64_t value)
+{
+    vmaVirtualFree(static_cast<ChunkRenderer*>(renderer)->m_IndexBlock, std::bit_cast<VmaVirtualAllocation>(value));
+}
+
+std::expected<ChunkRenderHandle, vk::Result> ChunkRenderer::add(const int32_t chunk_x, const int32_t chunk_z, const std::span<const PackedChunkVertex> vertices,
+    const std::span<const uint32_t> indices, const std::span<const SectionDraw, Chunk::SECTION_COUNT> sections)
+{
+    if (vertices.empty() || indices.empty()) {
+        return std::unexpected(vk::Result::eErrorUnknown);
+    }
+
+    if (m_FreeSlots.empty() && m_Slots.size() >= m_Spec.MaxChunks) {
+        return std::unexpected(vk::Result::eErrorOutOfPoolMemory);
+    }
+
+    // Vertex ranges are aligned on whole vertices, VertexOffset counts them
+    ChunkSlot slot {};
+    VkDeviceSize vertex_offset;
+    VmaVirtualAllocationCreateInfo vertex_info {};
+    vertex_info.size = vertices.size_bytes();
+    vertex_info.alignment = sizeof(PackedChunkVertex);
+    if (vmaVirtualAllocate(m_VertexBlock, &vertex_info, &slot.Vertices, &vertex_offset) != VK_SUCCESS) {
+        return std::unexpected(vk::Result::eErrorOutOfDeviceMemory);
+    }
+
+    VkDeviceSize index_offset;
+    VmaVirtualAllocationCreateInfo index_info {};
+    index_info.size = indices.size_bytes();
+    index_info.alignment = sizeof(uint32_t);
+    if (vmaVirtualAllocate(m_IndexBlock, &index_info, &slot.Indices, &index_offset) != VK_SUCCESS) {
+        free_ranges(slot);
+        return std::unexpected(vk::Result::eErrorOutOfDeviceMemory);
+    }
+
+    const auto vertex_ticket = m_Uploads->enqueue_buffer(m_VertexArena.Buffer, vertex_offset, std::as_bytes(vertices),
+        vk::PipelineStageFlagBits2::eVertexShader, vk::AccessFlagBits2::eShaderStorageRead);
+    const auto index_ticket = m_Uploads->enqueue_buffer(m_IndexArena.Buffer, index_offset, std::as_bytes(indices),
+        vk::PipelineStageFlagBits2::eIndexInput, vk::AccessFlagBits2::eIndexRead);
+
+    slot.Ticket = std::max(vertex_ticket.value_or(0), index_ticket.value_or(0));
+
+    if (!vertex_ticket.has_value() || !index_ticket.has_value()) {
+        // One of the copies may already be queued. It is flushed before this frame is submitted and the
+        // frame waits on it, so the ranges are free to reuse once the frame completes
+        retire_ranges(slot.Vertices, slot.Indices);
+        return std::unexpected(vk::Result::eErrorOutOfDeviceMemory);
+    }
+
+    uint32_t index;
+    if (!m_FreeSlots.empty()) {
+        index = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+        m_Slots[index] = slot;
+    } else {
+        index = static_cast<uint32_t>(m_Slots.size());
+        m_Slots.push_back(slot);
+    }
+    m_ChunkCount++;
+
+    RecordWrite& write = m_PendingWrites.emplace_back(RecordWrite { index });
+    const auto first_index = static_cast<uint32_t>(index_offset / sizeof(uint32_t));
+    const auto base_vertex = static_cast<int32_t>(vertex_offset / sizeof(PackedChunkVertex));
+    for (uint32_t section = 0; section < Chunk::SECTION_COUNT; section++) {
+        const SectionDraw& draw = sections[section];
+        write.Records[section] = ChunkSectionRecord {
+            .Origin = glm::ivec3 { chunk_x, static_cast<int32_t>(section), chunk_z } * static_cast<int32_t>(ChunkSection::SIZE),
+            .IndexCount = draw.IndexCount,
+            .FirstIndex = first_index + draw.FirstIndex,
+            .VertexOffset = base_vertex + draw.VertexOffset,
+        };
+    }
+    m_Slots[index].Records = write.Records;
+
+    return ChunkRenderHandle { index };
+}
+
+void ChunkRenderer::remove(const ChunkRenderHandle handle)
+{
+    if (!handle.is_valid() || handle.Index >= m_Slots.size() || !m_Slots[handle.Index].Vertices) {
+        return;
+    }
+
+    // Records without indices are skipped by the cull pass, the slot itself can be taken right away
+    m_PendingWrites.push_back(RecordWrite { handle.Index });
+    retire_ranges(m_Slots[handle.Index].Vertices, m_Slots[handle.Index].Indices);
+    m_Slots[handle.Index] = {};
+    m_FreeSlots.push_back(handle.Index);
+    m_ChunkCount--;
+}
+
+#pragma region Compaction
+
+std::optional<ChunkRenderer::RangeMove> ChunkRenderer::move_range(const VmaVirtualBlock block, VmaVirtualAllocation& allocation, const vk::DeviceSize alignment) const
+{
+    VmaVirtualAllocationInfo info;
+    vmaGetVirtualAllocationInfo(block, allocation, &info);
+
+    VmaVirtualAllocationCreateInfo create_info {};
+    create_info.size = info.size;
+    create_info.alignment = alignment;
+    create_info.flags = VMA_VIRTUAL_ALLOCATION_CREATE_STRATEGY_MIN_OFFSET_BIT;
+
+    VmaVirtualAllocation moved;
+    VkDeviceSize offset;
+    if (vmaVirtualAllocate(block, &create_info, &moved, &offset) != VK_SUCCESS) {
+        return std::nullopt;
+    }
+
+    if (offset >= info.offset) {
+        vmaVirtualFree(block, moved);
+        return std::nullopt;
+    }
+
+    const RangeMove move { allocation, info.offset, offset, info.size };
+    allocation = moved;
+    return move;
+}
+
+void ChunkRenderer::compact(const vk::CommandBuffer cmd, const bool idle)
+{
+    if (!idle) {
+        return;
+    }
+
+    if (m_CompactCursor == UINT32_MAX) {
+        if (!m_CompactRequested) {
+            return;
+        }
+        m_CompactRequested = false;
+        m_CompactCursor = 0;
+        m_CompactedChunks = 0;
+        m_CompactedBytes = 0;
+    }
+
+    std::vector<vk::BufferCopy> vertex_copies;
+    std::vector<vk::BufferCopy> index_copies;
+    vk::DeviceSize copied = 0;
+    while (m_CompactCursor < m_Slots.size() && copied < COMPACT_MAX_BYTES_PER_FRAME) {
+        const uint32_t index = m_CompactCursor++;
+        ChunkSlot& slot = m_Slots[index];
+
+        // The upload must be done and owned by the graphics queue before the copy reads it
+        if (!slot.Vertices || !m_Uploads->is_acquired(slot.Ticket) || !m_Uploads->is_complete(slot.Ticket)) {
+            continue;
+        }
+
+        const auto vertex_move = move_range(m_VertexBlock, slot.Vertices, sizeof(PackedChunkVertex));
+        const auto index_move = move_range(m_IndexBlock, slot.Indices, sizeof(uint32_t));
+        if (!vertex_move.has_value() && !index_move.has_value()) {
+            continue;
+        }
+
+        // Retired with this frame, its copies are the last reads of the old ranges
+        retire_ranges(vertex_move.has_value() ? vertex_move->Source : nullptr, index_move.has_value() ? index_move->Source : nullptr);
+
+        if (vertex_move.has_value()) {
+            vertex_copies.emplace_back(vertex_move->SourceOffset, vertex_move->DestinationOffset, vertex_move->Size);
+            copied += vertex_move->Size;
+
+            const auto source_vertex = static_cast<int32_t>(vertex_move->SourceOffset / sizeof(PackedChunkVertex));
+            const auto destination_vertex = static_cast<int32_t>(vertex_move->DestinationOffset / sizeof(PackedChunkVertex));
+            for (ChunkSectionRecord& record : slot.Records) {
+                record.VertexOffset = record.VertexOffset - source_vertex + destination_vertex;
+            }
+        }
+
+        if (index_move.has_value()) {
+            index_copies.emplace_back(index_move->SourceOffset, index_move->DestinationOffset, index_move->Size);
+            copied += index_move->Size;
+
+            const auto source_index = static_cast<uint32_t>(index_move->SourceOffset / sizeof(uint32_t));
+            const auto destination_index = static_cast<uint32_t>(index_move->DestinationOffset / sizeof(uint32_t));
+            for (ChunkSectionRecord& record : slot.Records) {
+                record.FirstIndex = record.FirstIndex - source_index + destination_index;
+            }
+        }
+
+        m_PendingWrites.push_back(RecordWrite { index, slot.Records });
+        m_CompactedChunks++;
+    }
+    m_CompactedBytes += copied;
+
+    if (!vertex_copies.empty() || !index_copies.empty()) {
+        // The uploads were made visible to the draws only, extend that to the copies reading them
+        constexpr vk::MemoryBarrier2 read_barrier {
+            vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eIndexInput,
+            vk::AccessFlagBits2::eNone,
+            vk::PipelineStageFlagBits2::eCopy,
+            vk::AccessFlagBits2::eTransferRead
+        };
+        vk::DependencyInfo read_dependency {};
+        read_dependency.setMemoryBarriers(read_barrier);
+        cmd.pipelineBarrier2(read_dependency);
+
+        // Destinations were free, none of them overlaps a source
+        if (!vertex_copies.empty()) {
+            cmd.copyBuffer(m_VertexArena.Buffer, m_VertexArena.Buffer, vertex_copies);
+        }
+        if (!index_copies.empty()) {
+            cmd.copyBuffer(m_IndexArena.Buffer, m_IndexArena.Buffer, index_copies);
+        }
+
+        constexpr vk::MemoryBarrier2 write_barrier {
+            vk::PipelineStageFlagBits2::eCopy,
+            vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eIndexInput,
+            vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eIndexRead
+        };
+        vk::DependencyInfo write_dependency {};
+        write_dependency.setMemoryBarriers(write_barrier);
+        cmd.pipelineBarrier2(write_dependency);
+    }
+
+    if (m_CompactCursor >= m_Slots.size()) {
+        m_CompactCursor = UINT32_MAX;
+        LOG("Chunk compaction moved {} chunks ({} bytes), fragmentation now {:.0f}%", m_CompactedChunks, m_CompactedBytes, get_fragmentation() * 100.0f);
+    }
+}
+
+float ChunkRenderer::get_fragmentation() const
+{
+    float fragmentation = 0.0f;
+    for (const VmaVirtualBlock block : { m_VertexBlock, m_IndexBlock }) {
+        if (block) {
+            VmaDetailedStatistics stats;
+            vmaCalculateVirtualBlockStatistics(block, &stats);
+            fragmentation = std::max(fragmentation, MemoryManager::get_fragmentation(stats));
+        }
+    }
+    return fragmentation;
+}
+
+#pragma endregion
+
+void ChunkRenderer::record_cull(const vk::CommandBuffer cmd, const vk::Pipeline pipeline, const glm::mat4& view_projection)
+{
+    // Earlier frames read the records and commands, and wrote the commands and the count
+    constexpr vk::MemoryBarrier2 reuse_barrier {
+        vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eDrawIndirect
+            | vk::PipelineStageFlagBits2::eAllTransfer,
+        vk::AccessFlagBits2::eShaderStorageWrite | vk::AccessFlagBits2::eTransferWrite,
+        vk::PipelineStageFlagBits2::eAllTransfer | vk::PipelineStageFlagBits2::eComputeShader,
+        vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eShaderStorageWrite
+    };
+    vk::DependencyInfo reuse_dependency {};
+    reuse_dependency.setMemoryBarriers(reuse_barrier);
+    cmd.pipelineBarrier2(reuse_dependency);
+
+    // A slot removed then taken again within a frame is written twice, in order
+    for (const RecordWrite& write : m_PendingWrites) {
+        cmd.updateBuffer(m_Records.Buffer, write.Slot * sizeof(write.Records), sizeof(write.Records), write.Records.data());
+    }
+    m_PendingWrites.clear();
+    cmd.fillBuffer(m_Count.Buffer, 0, sizeof(uint32_t), 0);
+
+    constexpr vk::MemoryBarrier2 write_barrier {
+        vk::PipelineStageFlagBits2::eAllTransfer,
+        vk::AccessFlagBits2::eTransferWrite,
+        vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eVertexShader,
+        vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite
+    };
+    vk::DependencyInfo write_dependency {};
+    write_dependency.setMemoryBarriers(write_barrier);
+    cmd.pipelineBarrier2(write_dependency);
+
+    const auto record_count = static_cast<uint32_t>(m_Slots.size()) * Chunk::SECTION_COUNT;
+    if (pipeline && record_count > 0) {
+        const ChunkCullPushConstants push_constants {
+            .FrustumPlanes = extract_frustum_planes(view_projection),
+            .RecordsIndex = m_RecordsIndex,
+            .CommandsIndex = m_CommandsIndex,
+            .CountIndex = m_CountIndex,
+            .RecordCount = record_count,
+        };
+
+        static_assert(sizeof(ChunkCullPushConstants) <= BindlessHeap::PUSH_CONSTANT_SIZE);
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+        cmd.pushConstants(m_Heap->get_pipeline_layout(), BindlessHeap::PUSH_CONSTANT_STAGES, 0, sizeof(ChunkCullPushConstants), &push_constants);
+        cmd.dispatch((record_count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+    }
+
+    constexpr vk::MemoryBarrier2 indirect_barrier {
+        vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eAllTransfer,
+        vk::AccessFlagBits2::eShaderStorageWrite | vk::AccessFlagBits2::eTransferWrite,
+        vk::PipelineStageFlagBits2::eDrawIndirect,
+        vk::AccessFlagBits2::eIndirectCommandRead
+    };
+    vk::DependencyInfo indirect_dependency {};
+    indirect_dependency.setMemoryBarriers(indirect_barrier);
+    cmd.pipelineBarrier2(indirect_dependency);
+}
+
+void ChunkRenderer::record_draw(const vk::CommandBuffer cmd, const vk::Pipeline pipeline, const glm::mat4& view_projection, const std::optional<uint32_t> texture_index) const
+{
+    if (!pipeline || m_Slots.empty()) {
+        return;
+    }
+
+    const ChunkDrawPushConstants push_constants {
+        .ViewProjection = view_projection,
+        .Vertices = m_VertexAddress,
+        .RecordsIndex = m_RecordsIndex,
+        .TextureIndex = texture_index.value_or(UINT32_MAX),
+    };
+
+    static_assert(sizeof(ChunkDrawPushConstants) <= BindlessHeap::PUSH_CONSTANT_SIZE);
+    cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+    cmd.pushConstants(m_Heap->get_pipeline_layout(), BindlessHeap::PUSH_CONSTANT_STAGES, 0, sizeof(ChunkDrawPushConstants), &push_constants);
+    cmd.bindIndexBuffer(m_IndexArena.Buffer, 0, vk::IndexType::eUint32);
+    cmd.drawIndexedIndirectCount(m_Commands.Buffer, 0, m_Count.Buffer, 0, get_max_draws(), sizeof(vk::DrawIndexedIndirectCommand));
+}
+
+std::string ChunkRenderer::summary() const
+{
+    VmaStatistics vertex_stats {};
+    VmaStatistics index_stats {};
+    if (m_VertexBlock) {
+        vmaGetVirtualBlockStatistics(m_VertexBlock, &vertex_stats);
+    }
+    if (m_IndexBlock) {
+        vmaGetVirtualBlockStatistics(m_IndexBlock, &index_stats);
+    }
+
+    return fmt::format("Chunk renderer: {} of {} chunks, vertices {:.1f} / {:.0f} MiB, indices {:.1f} / {:.0f} MiB, fragmentation {:.0f}%",
+        m_ChunkCount, m_Spec.MaxChunks,
+        static_cast<double>(vertex_stats.allocationBytes) / (1024.0 * 1024.0), static_cast<double>(m_Spec.VertexCapacity) / (1024.0 * 1024.0),
+        static_cast<double>(index_stats.allocationBytes) / (1024.0 * 1024.0), static_cast<double>(m_Spec.IndexCapacity) / (1024.0 * 1024.0),
+        get_fragmentation() * 100.0f);
+}
+
+}
@@ -0,0 +1,177 @@
+#pragma once
+#include "bindless_heap.hpp"
+#include "chunk.hpp"
+#include "upload_manager.hpp"
+
+namespace Minecraft::VkEngine {
+
+struct ChunkRendererSpec {
+    // Arena sizes, every chunk mesh is sub-allocated from one vertex and one index buffer
+    vk::DeviceSize VertexCapacity { 64ull * 1024 * 1024 };
+    vk::DeviceSize IndexCapacity { 48ull * 1024 * 1024 };
+    // Chunks drawn at once, each one owns Chunk::SECTION_COUNT section records
+    uint32_t MaxChunks { 1024 };
+};
+
+// Range of one section in its chunk mesh, indices are relative to VertexOffset
+struct SectionDraw {
+    uint32_t FirstIndex { 0 };
+    uint32_t IndexCount { 0 };
+    int32_t VertexOffset { 0 };
+};
+
+// One section as chunk.glsl sees it, ranges are absolute in the arenas. An empty or free section has no indices
+struct ChunkSectionRecord {
+    glm::ivec3 Origin { 0 };
+    uint32_t IndexCount { 0 };
+    uint32_t FirstIndex { 0 };
+    int32_t VertexOffset { 0 };
+    std::array<uint32_t, 2> Padding {};
+};
+
+static_assert(sizeof(ChunkSectionRecord) == 32);
+
+// chunk_cull.comp push constants
+struct ChunkCullPushConstants {
+    // World space, normals pointing inside
+    std::array<glm::vec4, 6> FrustumPlanes {};
+    uint32_t RecordsIndex { 0 };
+    uint32_t CommandsIndex { 0 };
+    uint32_t CountIndex { 0 };
+    uint32_t RecordCount { 0 };
+};
+
+// chunk.vert and chunk.frag push constants
+struct ChunkDrawPushConstants {
+    glm::mat4 ViewProjection { 1.0f };
+    vk::DeviceAddress Vertices { 0 };
+    uint32_t RecordsIndex { 0 };
+    // Block texture array, UINT32_MAX shades the faces with a flat color
+    uint32_t TextureIndex { UINT32_MAX };
+};
+
+struct ChunkRenderHandle {
+    uint32_t Index { UINT32_MAX };
+
+    [[nodiscard]] bool is_valid() const { return Index != UINT32_MAX; }
+};
+
+/*
+ * GPU driven chunk rendering, the CPU never records a draw per chunk.
+ *
+ * Chunk meshes live in two arenas, one vertex buffer pulled through its device address and one index buffer,
+ * with ranges handed out by VMA virtual blocks. Every section of every chunk has a ChunkSectionRecord in one
+ * storage buffer. Each frame a compute pass tests the records against the view frustum and appends a
+ * VkDrawIndexedIndirectCommand per visible section, then a single drawIndexedIndirectCount draws them all.
+ * The record index travels in firstInstance, so the vertex shader finds the section origin from gl_InstanceIndex.
+ *
+ * Geometry goes through the UploadManager, record changes are written on the graphics queue at the start of
+ * the cull pass, after the frames still reading the old ones. Arena ranges of removed chunks are reused once
+ * the frames that may draw them are complete.
+ *
+ * Chunks come and go all the time, so the free space of the arenas splits up over a long session. VMA can't
+ * defragment virtual blocks, compact() sweeps the chunks instead and copies each range it can into the lowest
+ * free range of its arena, a few per idle frame. The records are rewritten and the old ranges retired like
+ * those of a removed chunk.
+ */
+class ChunkRenderer {
+public:
+    // chunk_cull.comp local size
+    static constexpr uint32_t CULL_GROUP_SIZE = 64;
+    // compact() stops taking chunks once a frame copied this much
+    static constexpr vk::DeviceSize COMPACT_MAX_BYTES_PER_FRAME = 8 * 1024 * 1024;
+
+    [[nodiscard]] vk::Result init(GpuManager& gpu, UploadManager& uploads, BindlessHeap& heap, const ChunkRendererSpec& spec);
+    void destroy();
+
+    // Queues the geometry upload and the section records, chunk_x and chunk_z in chunks.
+    // Fails when an arena, the records or the staging ring are full, the caller can retry on a later frame
+    [[nodiscard]] std::expected<ChunkRenderHandle, vk::Result> add(int32_t chunk_x, int32_t chunk_z, std::span<const PackedChunkVertex> vertices,
+        std::span<const uint32_t> indices, std::span<const SectionDraw, Chunk::SECTION_COUNT> sections);
+    // Stops drawing the chunk from the next recorded frame, its ranges go to the DeferredDeleter
+    void remove(ChunkRenderHandle handle);
+
+    // Outside of any rendering: writes the pending records, then fills the indirect commands and their count
+    void record_cull(vk::CommandBuffer cmd, vk::Pipeline pipeline, const glm::mat4& view_projection);
+    // Inside the rendering of the color target, with viewport and scissor set
+    void record_draw(vk::CommandBuffer cmd, vk::Pipeline pipeline, const glm::mat4& view_projection, std::optional<uint32_t> texture_index) const;
+
+    // Starts a compaction sweep over the chunks, ignored while one is running
+    void request_compaction() { m_CompactRequested = true; }
+    [[nodiscard]] bool is_compacting() const { return m_CompactCursor != UINT32_MAX; }
+    // Before record_cull, does nothing on busy frames. Moves chunks toward the start of the arenas until
+    // COMPACT_MAX_BYTES_PER_FRAME are copied, the new records go out with the next cull pass
+    void compact(vk::CommandBuffer cmd, bool idle);
+    // Worst of both arenas, 0 when their free space is one contiguous range, towards 1 as it splits up
+    [[nodiscard]] float get_fragmentation() const;
+
+    [[nodiscard]] uint32_t get_chunk_count() const { return m_ChunkCount; }
+    [[nodiscard]] uint32_t get_max_draws() const { return m_Spec.MaxChunks * Chunk::SECTION_COUNT; }
+    [[nodiscard]] std::string summary() const;
+
+private:
+    struct ChunkSlot {
+        VmaVirtualAllocation Vertices { nullptr };
+        VmaVirtualAllocation Indices { nullptr };
+        UploadTicket Ticket { 0 };
+        // As last written, compaction shifts their ranges when it moves the chunk
+        std::array<ChunkSectionRecord, Chunk::SECTION_COUNT> Records {};
+    };
+
+    // One range copied to a lower offset of the same arena
+    struct RangeMove {
+        VmaVirtualAllocation Source { nullptr };
+        vk::DeviceSize SourceOffset { 0 };
+        vk::DeviceSize DestinationOffset { 0 };
+        vk::DeviceSize Size { 0 };
+    };
+
+    struct RecordWrite {
+        uint32_t Slot { 0 };
+        std::array<ChunkSectionRecord, Chunk::SECTION_COUNT> Records {};
+    };
+
+    GpuManager* m_Gpu { nullptr };
+    UploadManager* m_Uploads { nullptr };
+    BindlessHeap* m_Heap { nullptr };
+    VmaAllocator m_Allocator { nullptr };
+    ChunkRendererSpec m_Spec {};
+
+    AllocatedBuffer m_VertexArena {};
+    AllocatedBuffer m_IndexArena {};
+    vk::DeviceAddress m_VertexAddress { 0 };
+    VmaVirtualBlock m_VertexBlock { nullptr };
+    VmaVirtualBlock m_IndexBlock { nullptr };
+
+    // Section records, and what the cull pass makes of them each frame
+    AllocatedBuffer m_Records {};
+    AllocatedBuffer m_Commands {};
+    AllocatedBuffer m_Count {};
+    uint32_t m_RecordsIndex { 0 };
+    uint32_t m_CommandsIndex { 0 };
+    uint32_t m_CountIndex { 0 };
+
+    std::vector<ChunkSlot> m_Slots;
+    std::vector<uint32_t> m_FreeSlots;
+    std::vector<RecordWrite> m_PendingWrites;
+    uint32_t m_ChunkCount { 0 };
+
+    // Compaction
+    bool m_CompactRequested { false };
+    // Next slot the sweep looks at, UINT32_MAX when no sweep is running
+    uint32_t m_CompactCursor { UINT32_MAX };
+    uint32_t m_CompactedChunks { 0 };
+    vk::DeviceSize m_CompactedBytes { 0 };
+
+    [[nodiscard]] std::expected<AllocatedBuffer, vk::Result> create_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage) const;
+    void destroy_buffer(AllocatedBuffer& buffer) const;
+    void free_ranges(const ChunkSlot& slot) const;
+    // Freed once the frame being recorded completes, either may be null
+    void retire_ranges(VmaVirtualAllocation vertices, VmaVirtualAllocation indices);
+    static void free_vertex_range(void* renderer, uint64_t value);
+    static void free_index_range(void* renderer, uint64_t value);
+    // Takes the lowest free range of block that fits, the allocation then points at it. Nothing when none is lower
+    [[nodiscard]] std::optional<RangeMove> move_range(VmaVirtualBlock block, VmaVirtualAllocation& allocation, vk::DeviceSize alignment) const;
+};
+
+}
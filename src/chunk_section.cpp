@@ -0,0 +1,247 @@
+#include "chunk_section.hpp"
+
+namespace Minecraft {
+
+// Fixed width so the inner loop unrolls, Direct skips the palette
+template<uint8_t Bits, bool Direct>
+static void decode(const std::span<const uint64_t> data, const std::span<const BlockId> palette, const std::span<BlockId, ChunkSection::VOLUME> out)
+{
+    constexpr uint32_t per_word = 64 / Bits;
+    constexpr uint64_t mask = (uint64_t { 1 } << Bits) - 1;
+
+    BlockId* dst = out.data();
+    for (const uint64_t word : data) {
+        for (uint32_t i = 0; i < per_word; i++) {
+            const auto raw = static_cast<uint32_t>(word >> (i * Bits) & mask);
+            *dst++ = Direct ? static_cast<BlockId>(raw) : palette[raw];
+        }
+    }
+}
+
+uint8_t ChunkSection::bits_for(const size_t palette_size)
+{
+    if (palette_size <= 1) {
+        return 0;
+    }
+    if (palette_size <= 2) {
+        return 1;
+    }
+    if (palette_size <= 4) {
+        return 2;
+    }
+    if (palette_size <= 16) {
+        return 4;
+    }
+    if (palette_size <= MAX_PALETTE_SIZE) {
+        return 8;
+    }
+    return DIRECT_BITS;
+}
+
+BlockId ChunkSection::get(const uint32_t index) const
+{
+    assert(index < VOLUME);
+    if (m_Bits == 0) {
+        return m_Uniform;
+    }
+
+    const uint32_t raw = get_raw(index);
+    return m_Bits == DIRECT_BITS ? static_cast<BlockId>(raw) : m_Palette[raw];
+}
+
+void ChunkSection::set(const uint32_t index, const BlockId block)
+{
+    assert(index < VOLUME);
+    if (m_Bits == 0) {
+        if (block == m_Uniform) {
+            return;
+        }
+
+        // Every other block keeps index 0
+        m_Palette = { m_Uniform, block };
+        m_Bits = 1;
+        m_Data.assign(VOLUME / 64, 0);
+        set_raw(index, 1);
+        return;
+    }
+
+    if (m_Bits == DIRECT_BITS) {
+        set_raw(index, block);
+        return;
+    }
+
+    const auto it = std::ranges::find(m_Palette, block);
+    uint32_t value = static_cast<uint32_t>(it - m_Palette.begin());
+    if (it == m_Palette.end()) {
+        m_Palette.push_back(block);
+        if (const uint8_t bits = bits_for(m_Palette.size()); bits != m_Bits) {
+            repack(bits);
+        }
+
+        if (m_Bits == DIRECT_BITS) {
+            value = block;
+        }
+    }
+
+    set_raw(index, value);
+}
+
+void ChunkSection::repack(const uint8_t bits)
+{
+    std::array<BlockId, VOLUME> values;
+    for (uint32_t i = 0; i < VOLUME; i++) {
+        values[i] = static_cast<BlockId>(get_raw(i));
+    }
+
+    if (bits == DIRECT_BITS) {
+        for (BlockId& value : values) {
+            value = m_Palette[value];
+        }
+        m_Palette.clear();
+        m_Palette.shrink_to_fit();
+    }
+
+    m_Bits = bits;
+    m_Data.assign(VOLUME * bits / 64, 0);
+    for (uint32_t i = 0; i < VOLUME; i++) {
+        set_raw(i, values[i]);
+    }
+}
+
+void ChunkSection::get_all(const std::span<BlockId, VOLUME> out) const
+{
+    switch (m_Bits) {
+    case 0:
+        std::ranges::fill(out, m_Uniform);
+        break;
+    case 1:
+        decode<1, false>(m_Data, m_Palette, out);
+        break;
+    case 2:
+        decode<2, false>(m_Data, m_Palette, out);
+        break;
+    case 4:
+        decode<4, false>(m_Data, m_Palette, out);
+        break;
+    case 8:
+        decode<8, false>(m_Data, m_Palette, out);
+        break;
+    default:
+        decode<DIRECT_BITS, true>(m_Data, m_Palette, out);
+        break;
+    }
+}
+
+void ChunkSection::set_all(const std::span<const BlockId, VOLUME> blocks)
+{
+    // Palette index + 1 of every id seen so far, only the entries of this section are touched and reset
+    thread_local std::array<uint16_t, std::numeric_limits<BlockId>::max() + 1> slots {};
+
+    std::vector<BlockId> palette;
+    for (const BlockId block : blocks) {
+        if (slots[block] == 0) {
+            palette.push_back(block);
+            slots[block] = static_cast<uint16_t>(palette.size());
+        }
+    }
+
+    const uint8_t bits = bits_for(palette.size());
+    if (bits == 0) {
+        slots[palette[0]] = 0;
+        fill(palette[0]);
+        return;
+    }
+
+    const bool direct = bits == DIRECT_BITS;
+    const uint32_t per_word = 64 / bits;
+    m_Data.resize(VOLUME * bits / 64);
+    m_Data.shrink_to_fit();
+    for (size_t w = 0; w < m_Data.size(); w++) {
+        uint64_t word = 0;
+        for (uint32_t i = 0; i < per_word; i++) {
+            const BlockId block = blocks[w * per_word + i];
+            const uint64_t value = direct ? block : slots[block] - 1u;
+            word |= value << (i * bits);
+        }
+        m_Data[w] = word;
+    }
+
+    for (const BlockId block : palette) {
+        slots[block] = 0;
+    }
+
+    m_Bits = bits;
+    if (direct) {
+        m_Palette.clear();
+    } else {
+        m_Palette = std::move(palette);
+    }
+    m_Palette.shrink_to_fit();
+}
+
+void ChunkSection::fill(const BlockId block)
+{
+    m_Uniform = block;
+    m_Bits = 0;
+    m_Data.clear();
+    m_Data.shrink_to_fit();
+    m_Palette.clear();
+    m_Palette.shrink_to_fit();
+}
+
+void ChunkSection::get_layer(const BlockFace face, const std::span<BlockId, AREA> out) const
+{
+    if (m_Bits == 0) {
+        std::ranges::fill(out, m_Uniform);
+        return;
+    }
+
+    switch (face) {
+    case BlockFace::ePosX:
+    case BlockFace::eNegX: {
+        const uint32_t x = face == BlockFace::ePosX ? SIZE - 1 : 0;
+        for (uint32_t y = 0; y < SIZE; y++) {
+            for (uint32_t z = 0; z < SIZE; z++) {
+                out[z + y * SIZE] = get(index(x, y, z));
+            }
+        }
+        break;
+    }
+    case BlockFace::ePosY:
+    case BlockFace::eNegY: {
+        const uint32_t y = face == BlockFace::ePosY ? SIZE - 1 : 0;
+        for (uint32_t i = 0; i < AREA; i++) {
+            out[i] = get(y * AREA + i);
+        }
+        break;
+    }
+    case BlockFace::ePosZ:
+    case BlockFace::eNegZ: {
+        const uint32_t z = face == BlockFace::ePosZ ? SIZE - 1 : 0;
+        for (uint32_t y = 0; y < SIZE; y++) {
+            for (uint32_t x = 0; x < SIZE; x++) {
+                out[x + y * SIZE] = get(index(x, y, z));
+            }
+        }
+        break;
+    }
+    }
+}
+
+void ChunkSection::compact()
+{
+    if (m_Bits == 0) {
+        return;
+    }
+
+    std::array<BlockId, VOLUME> blocks;
+    get_all(blocks);
+    set_all(blocks);
+}
+
+size_t ChunkSection::memory_usage() const
+{
+    return sizeof(ChunkSection) + m_Data.capacity() * sizeof(uint64_t) + m_Palette.capacity() * sizeof(BlockId);
+}
+
+}
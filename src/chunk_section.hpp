@@ -0,0 +1,82 @@
+#pragma once
+#include "chunk_vertex.hpp"
+
+namespace Minecraft {
+
+using BlockId = uint16_t;
+inline constexpr BlockId BLOCK_AIR = 0;
+
+/*
+ * 16³ blocks stored as indices into a per section palette, packed at the narrowest width that fits:
+ * - one block type: no indices at all, the value is kept inline (all air, all stone...)
+ * - up to 2, 4, 16 or 256 types: 1, 2, 4 or 8 bit indices
+ * - more than 256: the ids themselves, 16 bits each
+ * Widths divide 64 so no index straddles two words, a lookup is a shift and a mask.
+ *
+ * Palettes only grow on set(), compact() drops the entries nothing refers to anymore.
+ * Blocks are ordered y, z then x, rows along x are contiguous.
+ */
+class ChunkSection {
+public:
+    static constexpr uint32_t SIZE = 16;
+    static constexpr uint32_t AREA = SIZE * SIZE;
+    static constexpr uint32_t VOLUME = AREA * SIZE;
+    static constexpr uint32_t MAX_PALETTE_SIZE = 256;
+    static constexpr uint8_t DIRECT_BITS = 16;
+
+    [[nodiscard]] static constexpr uint32_t index(const uint32_t x, const uint32_t y, const uint32_t z) { return y << 8 | z << 4 | x; }
+
+    [[nodiscard]] BlockId get(const uint32_t x, const uint32_t y, const uint32_t z) const { return get(index(x, y, z)); }
+    [[nodiscard]] BlockId get(uint32_t index) const;
+    void set(const uint32_t x, const uint32_t y, const uint32_t z, const BlockId block) { set(index(x, y, z), block); }
+    void set(uint32_t index, BlockId block);
+
+    // Bulk access in index order, much faster than VOLUME get / set calls
+    void get_all(std::span<BlockId, VOLUME> out) const;
+    // Rebuilds the palette from scratch, so it is also the tightest encoding of blocks
+    void set_all(std::span<const BlockId, VOLUME> blocks);
+    void fill(BlockId block);
+
+    // The 16x16 blocks touching a face, as seen by the neighbor on that side.
+    // X faces are indexed z + y * 16, Y faces x + z * 16, Z faces x + y * 16
+    void get_layer(BlockFace face, std::span<BlockId, AREA> out) const;
+
+    // Drops unused palette entries, down to a single inline value when only one is left
+    void compact();
+
+    [[nodiscard]] bool is_uniform() const { return m_Bits == 0; }
+    // Only meaningful when is_uniform()
+    [[nodiscard]] BlockId get_uniform() const { return m_Uniform; }
+    [[nodiscard]] uint32_t get_bits_per_block() const { return m_Bits; }
+    // Empty when uniform or storing ids directly
+    [[nodiscard]] std::span<const BlockId> get_palette() const { return m_Palette; }
+    // This object plus what it owns on the heap
+    [[nodiscard]] size_t memory_usage() const;
+
+private:
+    std::vector<uint64_t> m_Data;
+    std::vector<BlockId> m_Palette;
+    BlockId m_Uniform { BLOCK_AIR };
+    uint8_t m_Bits { 0 };
+
+    [[nodiscard]] static uint8_t bits_for(size_t palette_size);
+
+    [[nodiscard]] uint32_t get_raw(const uint32_t index) const
+    {
+        const uint32_t bit = index * m_Bits;
+        return static_cast<uint32_t>(m_Data[bit >> 6] >> (bit & 63)) & ((1u << m_Bits) - 1);
+    }
+
+    void set_raw(const uint32_t index, const uint32_t value)
+    {
+        const uint32_t bit = index * m_Bits;
+        const uint64_t mask = ((uint64_t { 1 } << m_Bits) - 1) << (bit & 63);
+        uint64_t& word = m_Data[bit >> 6];
+        word = (word & ~mask) | (static_cast<uint64_t>(value) << (bit & 63) & mask);
+    }
+
+    // Re-encodes every index at the new width, palette ids become direct ones at DIRECT_BITS
+    void repack(uint8_t bits);
+};
+
+}
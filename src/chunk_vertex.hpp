@@ -0,0 +1,91 @@
+#pragma once
+#include "vertex_layout.hpp"
+
+namespace Minecraft {
+
+enum class BlockFace : uint8_t {
+    ePosX,
+    eNegX,
+    ePosY,
+    eNegY,
+    ePosZ,
+    eNegZ
+};
+
+/*
+ * 8 byte voxel vertex, a third of Vertex.
+ * Positions are chunk section local corners, 0..16 inclusive, the section origin comes from the draw.
+ * UVs count whole blocks so greedy quads repeat their texture.
+ *
+ * Geometry: x:5 y:5 z:5 face:3 ao:2 u:5 v:5 (2 spare)
+ * Material: texture:16 sky light:4 block light:4 (8 spare)
+ */
+struct PackedChunkVertex {
+    uint32_t Geometry;
+    uint32_t Material;
+
+    static constexpr uint32_t MAX_COORD = 16;
+    static constexpr uint32_t MAX_TEXTURE = 0xFFFF;
+
+    [[nodiscard]] static constexpr PackedChunkVertex pack(const uint32_t x, const uint32_t y, const uint32_t z, const BlockFace face, const uint32_t ao,
+        const uint32_t u, const uint32_t v, const uint32_t texture, const uint32_t sky_light = 15, const uint32_t block_light = 0)
+    {
+        return PackedChunkVertex {
+            (x & 0x1F) | (y & 0x1F) << 5 | (z & 0x1F) << 10 | (static_cast<uint32_t>(face) & 0x7) << 15 | (ao & 0x3) << 18 | (u & 0x1F) << 20 | (v & 0x1F) << 25,
+            (texture & 0xFFFF) | (sky_light & 0xF) << 16 | (block_light & 0xF) << 20
+        };
+    }
+
+    [[nodiscard]] constexpr uint32_t x() const { return Geometry & 0x1F; }
+    [[nodiscard]] constexpr uint32_t y() const { return Geometry >> 5 & 0x1F; }
+    [[nodiscard]] constexpr uint32_t z() const { return Geometry >> 10 & 0x1F; }
+    [[nodiscard]] constexpr BlockFace face() const { return static_cast<BlockFace>(Geometry >> 15 & 0x7); }
+    [[nodiscard]] constexpr uint32_t ao() const { return Geometry >> 18 & 0x3; }
+    [[nodiscard]] constexpr uint32_t u() const { return Geometry >> 20 & 0x1F; }
+    [[nodiscard]] constexpr uint32_t v() const { return Geometry >> 25 & 0x1F; }
+    [[nodiscard]] constexpr uint32_t texture() const { return Material & 0xFFFF; }
+    [[nodiscard]] constexpr uint32_t sky_light() const { return Material >> 16 & 0xF; }
+    [[nodiscard]] constexpr uint32_t block_light() const { return Material >> 20 & 0xF; }
+};
+
+static_assert(sizeof(PackedChunkVertex) == 8);
+static_assert(PackedChunkVertex::pack(16, 3, 9, BlockFace::eNegZ, 2, 16, 5, 1234, 7, 11).z() == 9);
+static_assert(PackedChunkVertex::pack(16, 3, 9, BlockFace::eNegZ, 2, 16, 5, 1234, 7, 11).face() == BlockFace::eNegZ);
+static_assert(PackedChunkVertex::pack(16, 3, 9, BlockFace::eNegZ, 2, 16, 5, 1234, 7, 11).block_light() == 11);
+
+using VertexLayoutPackedChunk = VertexLayout<PackedChunkVertex,
+    VERTEX_ATTRIBUTE(PackedChunkVertex, Geometry),
+    VERTEX_ATTRIBUTE(PackedChunkVertex, Material)>;
+
+/*
+ * 12 byte vertex for geometry that does not sit on the block grid (slabs, plants, torches).
+ * Position and UV are in 1/POSITION_SCALE block units relative to the section origin,
+ * Position.w packs face:3 ao:2 texture:11.
+ */
+struct QuantizedChunkVertex {
+    glm::u16vec4 Position;
+    glm::u16vec2 Uv;
+
+    static constexpr float POSITION_SCALE = 256.0f;
+    static constexpr uint32_t MAX_TEXTURE = 0x7FF;
+
+    [[nodiscard]] static QuantizedChunkVertex pack(const glm::vec3 position, const glm::vec2 uv, const BlockFace face, const uint32_t ao, const uint32_t texture)
+    {
+        const glm::vec3 scaled = glm::clamp(position * POSITION_SCALE, 0.0f, 65535.0f);
+        const glm::vec2 scaled_uv = glm::clamp(uv * POSITION_SCALE, 0.0f, 65535.0f);
+        const auto packed = static_cast<uint16_t>((static_cast<uint32_t>(face) & 0x7) | (ao & 0x3) << 3 | (texture & MAX_TEXTURE) << 5);
+
+        return QuantizedChunkVertex {
+            glm::u16vec4 { glm::u16vec3 { glm::round(scaled) }, packed },
+            glm::u16vec2 { glm::round(scaled_uv) }
+        };
+    }
+};
+
+static_assert(sizeof(QuantizedChunkVertex) == 12);
+
+using VertexLayoutQuantizedChunk = VertexLayout<QuantizedChunkVertex,
+    VERTEX_ATTRIBUTE(QuantizedChunkVertex, Position),
+    VERTEX_ATTRIBUTE(QuantizedChunkVertex, Uv)>;
+
+}
@@ -0,0 +1,187 @@
+#include "compositor.hpp"
+#include "helper.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+static bool is_bgra(const vk::Format format)
+{
+    return format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+}
+
+vk::Result Compositor::init(GpuManager& gpu, BindlessHeap& heap, const CompositeSpec& spec)
+{
+    m_Gpu = &gpu;
+    m_Heap = &heap;
+    m_Device = gpu.get_device();
+    m_Allocator = gpu.get_allocator();
+    m_Spec = spec;
+
+    const SwapchainBundle& swapchain = gpu.get_swapchain();
+    m_WritesSwapchain = swapchain.Storage;
+
+    // Outputs are UNORM, the swapchain color space is sRGB either way
+    m_Flags = FLAG_ENCODE_SRGB;
+    if (m_Spec.Tonemap) {
+        m_Flags |= FLAG_TONEMAP;
+    }
+
+    if (m_WritesSwapchain) {
+        LOG("Compositing straight into the {} swapchain", vk::to_string(swapchain.ImageFormat));
+        return vk::Result::eSuccess;
+    }
+
+    // Same channel order as the swapchain keeps the copy a plain one, RGBA8 storage is always supported
+    const vk::FormatFeatureFlags features = gpu.get_physical_device().getFormatProperties(vk::Format::eB8G8R8A8Unorm).optimalTilingFeatures;
+    m_IntermediateFormat = features & vk::FormatFeatureFlagBits::eStorageImage ? vk::Format::eB8G8R8A8Unorm : vk::Format::eR8G8B8A8Unorm;
+    if (is_bgra(m_IntermediateFormat) != is_bgra(swapchain.ImageFormat)) {
+        m_Flags |= FLAG_SWAP_RED_BLUE;
+    }
+
+    LOG("Swapchain has no storage usage, compositing into a {} image copied to it", vk::to_string(m_IntermediateFormat));
+    return vk::Result::eSuccess;
+}
+
+void Compositor::destroy()
+{
+    if (m_Intermediate.Image) {
+        m_Device.destroyImageView(m_Intermediate.ImageView);
+        m_Gpu->get_memory().untrack(MemoryCategory::eDrawTargets, m_Intermediate.Allocation);
+        vmaDestroyImage(m_Allocator, m_Intermediate.Image, m_Intermediate.Allocation);
+        m_Intermediate = {};
+    }
+
+    m_Outputs.clear();
+    m_OutputIndices.clear();
+    m_SourceIndex.reset();
+    m_SourceView = nullptr;
+    m_SwapchainGeneration = 0;
+}
+
+void Compositor::update(const DrawImageBundle& source)
+{
+    if (source.ImageView != m_SourceView) {
+        if (m_SourceIndex.has_value()) {
+            m_Heap->release(BindlessType::eSampledImage, m_SourceIndex.value());
+        }
+
+        m_SourceIndex = m_Heap->add_sampled_image(source.ImageView);
+        m_SourceView = source.ImageView;
+    }
+    m_SourceExtent = vk::Extent2D { source.Extent.width, source.Extent.height };
+
+    update_outputs();
+}
+
+void Compositor::update_outputs()
+{
+    const SwapchainBundle& swapchain = m_Gpu->get_swapchain();
+    if (swapchain.Generation == m_SwapchainGeneration) {
+        return;
+    }
+
+    release_outputs();
+    m_SwapchainGeneration = swapchain.Generation;
+    m_OutputExtent = swapchain.Extent;
+
+    if (!m_WritesSwapchain) {
+        if (const vk::Result res = create_intermediate(m_OutputExtent); res != vk::Result::eSuccess) {
+            LOG_ERROR("Failed to allocate the composite image: {}", vk::to_string(res));
+            return;
+        }
+
+        if (const auto index = m_Heap->add_storage_image(m_Intermediate.ImageView); index.has_value()) {
+            m_Outputs.push_back(m_Intermediate.Image);
+            m_OutputIndices.push_back(index.value());
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < swapchain.Images.size(); i++) {
+        const auto index = m_Heap->add_storage_image(swapchain.ImageViews[i]);
+        if (!index.has_value()) {
+            LOG_ERROR("No storage image slot left for swapchain image {}", i);
+            continue;
+        }
+
+        m_Outputs.push_back(swapchain.Images[i]);
+        m_OutputIndices.push_back(index.value());
+    }
+}
+
+void Compositor::release_outputs()
+{
+    for (const uint32_t index : m_OutputIndices) {
+        m_Heap->release(BindlessType::eStorageImage, index);
+    }
+    m_Outputs.clear();
+    m_OutputIndices.clear();
+
+    // Frames in flight may still write the previous one
+    if (m_Intermediate.Image) {
+        m_Gpu->get_memory().untrack(MemoryCategory::eDrawTargets, m_Intermediate.Allocation);
+        m_Gpu->get_deleter().push(m_Intermediate.ImageView);
+        m_Gpu->get_deleter().push(m_Intermediate.Image, m_Intermediate.Allocation);
+        m_Intermediate = {};
+    }
+}
+
+vk::Result Compositor::create_intermediate(const vk::Extent2D extent)
+{
+    AllocatedImage image {};
+    image.Format = m_IntermediateFormat;
+    image.Extent = vk::Extent3D { std::max(extent.width, 1u), std::max(extent.height, 1u), 1 };
+
+    const vk::ImageCreateInfo image_info = VkInit::image_create_info(image.Format,
+        vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc, image.Extent);
+    VmaAllocationCreateInfo alloc_info = {};
+    alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    alloc_info.requiredFlags = static_cast<VkMemoryPropertyFlags>(vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    VkImage image_c;
+    const VkResult alloc_res = vmaCreateImage(m_Allocator, reinterpret_cast<const VkImageCreateInfo*>(&image_info), &alloc_info,
+        &image_c, &image.Allocation, nullptr);
+    if (alloc_res != VK_SUCCESS) {
+        return static_cast<vk::Result>(alloc_res);
+    }
+    image.Image = image_c;
+
+    const vk::ImageViewCreateInfo view_info = VkInit::imageview_create_info(image.Format, image.Image, vk::ImageAspectFlagBits::eColor);
+    if (const vk::Result res = m_Device.createImageView(&view_info, nullptr, &image.ImageView); res != vk::Result::eSuccess) {
+        vmaDestroyImage(m_Allocator, image.Image, image.Allocation);
+        return res;
+    }
+
+    m_Intermediate = image;
+    m_Gpu->get_memory().track(MemoryCategory::eDrawTargets, image.Allocation);
+    return vk::Result::eSuccess;
+}
+
+void Compositor::record(const vk::CommandBuffer cmd, const vk::Pipeline pipeline, const vk::Extent2D source_extent, const vk::Image output) const
+{
+    const auto it = std::ranges::find(m_Outputs, output);
+    if (!pipeline || !m_SourceIndex.has_value() || it == m_Outputs.end()) {
+        return;
+    }
+
+    const glm::vec2 source_size { static_cast<float>(m_SourceExtent.width), static_cast<float>(m_SourceExtent.height) };
+    const glm::vec2 drawn_size { static_cast<float>(source_extent.width), static_cast<float>(source_extent.height) };
+
+    const CompositePushConstants push_constants {
+        .SourceIndex = m_SourceIndex.value(),
+        .OutputIndex = m_OutputIndices[static_cast<size_t>(it - m_Outputs.begin())],
+        .Flags = m_Flags,
+        .Exposure = m_Spec.Exposure,
+        .UvScale = drawn_size / source_size,
+        // Bilinear taps past the drawn region would pull in stale texels from a larger scale
+        .UvMax = (drawn_size - 0.5f) / source_size,
+        .OutputExtent = glm::uvec2 { m_OutputExtent.width, m_OutputExtent.height },
+    };
+
+    static_assert(sizeof(CompositePushConstants) <= BindlessHeap::PUSH_CONSTANT_SIZE);
+    cmd.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+    cmd.pushConstants(m_Heap->get_pipeline_layout(), BindlessHeap::PUSH_CONSTANT_STAGES, 0, sizeof(CompositePushConstants), &push_constants);
+    cmd.dispatch((m_OutputExtent.width + GROUP_SIZE - 1) / GROUP_SIZE, (m_OutputExtent.height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "bindless_heap.hpp"
+#include "gpu_manager.hpp"
+
+namespace Minecraft::VkEngine {
+
+struct CompositeSpec {
+    // ACES fitted curve, off passes the draw image through clamped
+    bool Tonemap { true };
+    float Exposure { 1.0f };
+};
+
+// composite.comp push constants
+struct CompositePushConstants {
+    uint32_t SourceIndex { 0 };
+    uint32_t OutputIndex { 0 };
+    uint32_t Flags { 0 };
+    float Exposure { 1.0f };
+    // Output uv to draw image uv, then the last texel center of the drawn region
+    glm::vec2 UvScale { 1.0f };
+    glm::vec2 UvMax { 1.0f };
+    glm::uvec2 OutputExtent { 0 };
+};
+
+/*
+ * Last step of a frame: one compute dispatch samples the draw image, upscales the drawn region
+ * bilinearly, tonemaps, encodes sRGB and stores straight into the swapchain image.
+ * When the swapchain has no storage usage it stores into an intermediate 8 bit image instead,
+ * which the caller copies to the swapchain (a raw copy, no format conversion).
+ *
+ * Outputs and the draw image live in the BindlessHeap, their slots follow the swapchain and draw image
+ * as they get recreated.
+ */
+class Compositor {
+public:
+    static constexpr uint32_t GROUP_SIZE = 8;
+
+    static constexpr uint32_t FLAG_TONEMAP = 1u << 0;
+    static constexpr uint32_t FLAG_ENCODE_SRGB = 1u << 1;
+    static constexpr uint32_t FLAG_SWAP_RED_BLUE = 1u << 2;
+
+    [[nodiscard]] vk::Result init(GpuManager& gpu, BindlessHeap& heap, const CompositeSpec& spec);
+    void destroy();
+
+    // Decided once at init, the graph is built around it
+    [[nodiscard]] bool writes_swapchain() const { return m_WritesSwapchain; }
+    // Null when writing the swapchain directly
+    [[nodiscard]] const AllocatedImage& get_intermediate() const { return m_Intermediate; }
+
+    // Before recording, picks up a recreated swapchain or draw image
+    void update(const DrawImageBundle& source);
+
+    // output is the swapchain image or the intermediate one, source_extent the drawn region of the draw image
+    void record(vk::CommandBuffer cmd, vk::Pipeline pipeline, vk::Extent2D source_extent, vk::Image output) const;
+
+private:
+    GpuManager* m_Gpu { nullptr };
+    BindlessHeap* m_Heap { nullptr };
+    vk::Device m_Device { nullptr };
+    VmaAllocator m_Allocator { nullptr };
+    CompositeSpec m_Spec {};
+    bool m_WritesSwapchain { false };
+    uint32_t m_Flags { 0 };
+
+    vk::ImageView m_SourceView { nullptr };
+    vk::Extent2D m_SourceExtent {};
+    std::optional<uint32_t> m_SourceIndex;
+
+    uint64_t m_SwapchainGeneration { 0 };
+    vk::Extent2D m_OutputExtent {};
+    // One slot per swapchain image, or a single one for the intermediate
+    std::vector<vk::Image> m_Outputs;
+    std::vector<uint32_t> m_OutputIndices;
+
+    vk::Format m_IntermediateFormat { vk::Format::eUndefined };
+    AllocatedImage m_Intermediate {};
+
+    void update_outputs();
+    void release_outputs();
+    [[nodiscard]] vk::Result create_intermediate(vk::Extent2D extent);
+};
+
+}
@@ -0,0 +1,246 @@
+#include "cpu_profiler.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+#pragma region State
+
+namespace {
+
+    // Written only by its owning thread, the head is published with release so exports see whole events
+    struct ThreadBuffer {
+        std::string Name;
+        uint32_t Id { 0 };
+        std::array<CpuProfiler::ZoneEvent, CpuProfiler::RING_CAPACITY> Events {};
+        std::atomic<uint64_t> Head { 0 };
+    };
+
+    std::atomic<bool> s_Enabled { true };
+    std::atomic<uint64_t> s_FrameNumber { 0 };
+
+    std::mutex s_BuffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> s_Buffers;
+
+    thread_local ThreadBuffer* t_Buffer { nullptr };
+    thread_local uint32_t t_Depth { 0 };
+
+    // Frame bookkeeping, owned by the thread driving begin_frame/end_frame
+    double s_FrameBudgetMs { 1000.0 / 60.0 };
+    int64_t s_FrameStartNs { 0 };
+
+    std::mutex s_StatsMutex;
+    std::deque<CpuProfiler::FlaggedFrame> s_FlaggedFrames;
+    uint64_t s_FrameCount { 0 };
+    uint64_t s_OverBudgetCount { 0 };
+    double s_WorstFrameMs { 0.0 };
+    int64_t s_LastLogNs { 0 };
+    // Flagged since the last one logged
+    uint64_t s_UnloggedCount { 0 };
+
+    ThreadBuffer& get_thread_buffer()
+    {
+        if (!t_Buffer) {
+            std::lock_guard lock { s_BuffersMutex };
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->Id = static_cast<uint32_t>(s_Buffers.size() + 1);
+            buffer->Name = fmt::format("Thread {}", buffer->Id);
+            t_Buffer = buffer.get();
+            s_Buffers.push_back(std::move(buffer));
+        }
+        return *t_Buffer;
+    }
+
+    void record(const char* name, const int64_t start_ns, const int64_t end_ns, const uint32_t depth)
+    {
+        ThreadBuffer& buffer = get_thread_buffer();
+        const uint64_t head = buffer.Head.load(std::memory_order_relaxed);
+        buffer.Events[head % CpuProfiler::RING_CAPACITY] = CpuProfiler::ZoneEvent {
+            name, start_ns, end_ns, s_FrameNumber.load(std::memory_order_relaxed), depth
+        };
+        buffer.Head.store(head + 1, std::memory_order_release);
+    }
+
+}
+
+#pragma endregion
+
+int64_t CpuProfiler::now_ns()
+{
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+int64_t CpuProfiler::enter()
+{
+    if (!s_Enabled.load(std::memory_order_relaxed)) {
+        return -1;
+    }
+
+    t_Depth++;
+    return now_ns();
+}
+
+void CpuProfiler::leave(const char* name, const int64_t start_ns)
+{
+    if (start_ns < 0) {
+        return;
+    }
+
+    t_Depth--;
+    record(name, start_ns, now_ns(), t_Depth);
+}
+
+void CpuProfiler::set_enabled(const bool enabled)
+{
+    s_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::is_enabled()
+{
+    return s_Enabled.load(std::memory_order_relaxed);
+}
+
+void CpuProfiler::set_frame_budget(const double budget_ms)
+{
+    s_FrameBudgetMs = budget_ms;
+}
+
+void CpuProfiler::set_thread_name(const char* name)
+{
+    ThreadBuffer& buffer = get_thread_buffer();
+    std::lock_guard lock { s_BuffersMutex };
+    buffer.Name = name;
+}
+
+void CpuProfiler::begin_frame(const uint64_t frame_number)
+{
+    s_FrameNumber.store(frame_number, std::memory_order_relaxed);
+    s_FrameStartNs = now_ns();
+    t_Depth++;
+}
+
+void CpuProfiler::end_frame()
+{
+    const int64_t end_ns = now_ns();
+    t_Depth--;
+
+    if (!s_Enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    record("Frame", s_FrameStartNs, end_ns, t_Depth);
+
+    const double frame_ms = static_cast<double>(end_ns - s_FrameStartNs) / 1e6;
+
+    std::lock_guard lock { s_StatsMutex };
+    s_FrameCount++;
+    s_WorstFrameMs = std::max(s_WorstFrameMs, frame_ms);
+
+    if (frame_ms <= s_FrameBudgetMs * BUDGET_TOLERANCE) {
+        return;
+    }
+
+    // Walk back over this frame's zones, only the direct children of the frame are compared
+    const ThreadBuffer& buffer = get_thread_buffer();
+    const uint64_t head = buffer.Head.load(std::memory_order_relaxed) - 1;
+    const uint64_t oldest = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+
+    FlaggedFrame flagged { s_FrameNumber.load(std::memory_order_relaxed), s_FrameStartNs, frame_ms, "CPU", 0.0 };
+    for (uint64_t i = head; i > oldest; i--) {
+        const ZoneEvent& event = buffer.Events[(i - 1) % RING_CAPACITY];
+        if (event.StartNs < s_FrameStartNs) {
+            break;
+        }
+
+        const double zone_ms = static_cast<double>(event.EndNs - event.StartNs) / 1e6;
+        if (event.Depth == t_Depth + 1 && zone_ms > flagged.LongestZoneMs) {
+            flagged.LongestZone = event.Name;
+            flagged.LongestZoneMs = zone_ms;
+        }
+    }
+
+    if (static_cast<double>(end_ns - s_LastLogNs) / 1e6 >= LOG_INTERVAL_MS) {
+        LOG("Frame {} took {:.3f}ms over a {:.3f}ms budget, longest zone {} {:.3f}ms, {} more flagged since the last report",
+            flagged.FrameNumber, frame_ms, s_FrameBudgetMs, flagged.LongestZone, flagged.LongestZoneMs, s_UnloggedCount);
+        s_LastLogNs = end_ns;
+        s_UnloggedCount = 0;
+    } else {
+        s_UnloggedCount++;
+    }
+
+    s_OverBudgetCount++;
+    s_FlaggedFrames.push_back(flagged);
+    if (s_FlaggedFrames.size() > MAX_FLAGGED_FRAMES) {
+        s_FlaggedFrames.pop_front();
+    }
+}
+
+std::vector<CpuProfiler::FlaggedFrame> CpuProfiler::get_flagged_frames()
+{
+    std::lock_guard lock { s_StatsMutex };
+    return { s_FlaggedFrames.begin(), s_FlaggedFrames.end() };
+}
+
+std::string CpuProfiler::summary()
+{
+    std::lock_guard lock { s_StatsMutex };
+    std::string out = fmt::format("CPU: {} of {} frames more than {:.0f}% over the {:.3f}ms budget, worst {:.3f}ms",
+        s_OverBudgetCount, s_FrameCount, (BUDGET_TOLERANCE - 1.0) * 100.0, s_FrameBudgetMs, s_WorstFrameMs);
+
+    // Which zone dominates the hitches says whether the CPU or the wait on the GPU is to blame
+    std::unordered_map<std::string_view, uint32_t> culprits;
+    for (const auto& frame : s_FlaggedFrames) {
+        culprits[frame.LongestZone]++;
+    }
+    for (const auto& [zone, count] : culprits) {
+        out += fmt::format(" | {} x{}", zone, count);
+    }
+    return out;
+}
+
+bool CpuProfiler::export_chrome_trace(const std::filesystem::path& path)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR("Unable to open trace file: {}", path.string());
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    const auto separator = [&] {
+        const char* sep = first ? "" : ",";
+        first = false;
+        return sep;
+    };
+
+    {
+        std::lock_guard lock { s_BuffersMutex };
+        for (const auto& buffer : s_Buffers) {
+            file << separator()
+                 << fmt::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+                        buffer->Id, buffer->Name);
+
+            const uint64_t head = buffer->Head.load(std::memory_order_acquire);
+            const uint64_t oldest = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+            for (uint64_t i = oldest; i < head; i++) {
+                const ZoneEvent& event = buffer->Events[i % RING_CAPACITY];
+                file << separator()
+                     << fmt::format(R"({{"name":"{}","cat":"cpu","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"frame":{}}}}})",
+                            event.Name, buffer->Id, static_cast<double>(event.StartNs) / 1e3,
+                            static_cast<double>(event.EndNs - event.StartNs) / 1e3, event.FrameNumber);
+            }
+        }
+    }
+
+    for (const auto& frame : get_flagged_frames()) {
+        file << separator()
+             << fmt::format(R"({{"name":"Over budget","cat":"hitch","ph":"i","s":"g","pid":1,"ts":{:.3f},"args":{{"frame":{},"ms":{:.3f},"longest":"{}","longest_ms":{:.3f}}}}})",
+                    static_cast<double>(frame.StartNs) / 1e3, frame.FrameNumber, frame.FrameMs, frame.LongestZone, frame.LongestZoneMs);
+    }
+
+    file << "]}\n";
+    return file.good();
+}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+/*
+ * Scoped CPU zone profiler, always compiled in.
+ * Every thread writes its zones into its own fixed ring, the only shared state on the hot path
+ * is an atomic frame counter, so recording a zone is two clock reads and a store.
+ * The main thread brackets frames with begin_frame/end_frame, frames above the budget are
+ * flagged together with their longest zone to tell a CPU hitch from a wait on the GPU.
+ * Frames paced by vsync land right around the budget, only those past BUDGET_TOLERANCE count,
+ * and at most one of them per LOG_INTERVAL_MS reaches the log. The flagged ring keeps them all.
+ * Zone names are kept by pointer, string literals are expected.
+ */
+class CpuProfiler {
+public:
+    static constexpr size_t RING_CAPACITY = 8192;
+    static constexpr size_t MAX_FLAGGED_FRAMES = 64;
+    static constexpr double BUDGET_TOLERANCE = 1.1;
+    static constexpr double LOG_INTERVAL_MS = 1000.0;
+
+    struct ZoneEvent {
+        const char* Name { nullptr };
+        int64_t StartNs { 0 };
+        int64_t EndNs { 0 };
+        uint64_t FrameNumber { 0 };
+        uint32_t Depth { 0 };
+    };
+
+    struct FlaggedFrame {
+        uint64_t FrameNumber { 0 };
+        int64_t StartNs { 0 };
+        double FrameMs { 0.0 };
+        const char* LongestZone { nullptr };
+        double LongestZoneMs { 0.0 };
+    };
+
+    class Zone {
+    public:
+        explicit Zone(const char* name)
+            : m_Name(name)
+            , m_Start(enter())
+        {
+        }
+
+        ~Zone() { leave(m_Name, m_Start); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* m_Name;
+        int64_t m_Start;
+    };
+
+    static void set_enabled(bool enabled);
+    [[nodiscard]] static bool is_enabled();
+
+    static void set_frame_budget(double budget_ms);
+    // Names the calling thread in the trace
+    static void set_thread_name(const char* name);
+
+    static void begin_frame(uint64_t frame_number);
+    static void end_frame();
+
+    [[nodiscard]] static std::vector<FlaggedFrame> get_flagged_frames();
+    [[nodiscard]] static std::string summary();
+
+    // Meant for quiet points like shutdown, zones recorded meanwhile may overwrite the oldest ones read
+    [[nodiscard]] static bool export_chrome_trace(const std::filesystem::path& path);
+
+    [[nodiscard]] static int64_t now_ns();
+
+private:
+    static int64_t enter();
+    static void leave(const char* name, int64_t start_ns);
+};
+
+}
+
+#define CPU_ZONE_CONCAT_INNER(a, b) a##b
+#define CPU_ZONE_CONCAT(a, b) CPU_ZONE_CONCAT_INNER(a, b)
+#define CPU_ZONE(name) \
+    const ::Minecraft::VkEngine::CpuProfiler::Zone CPU_ZONE_CONCAT(cpu_zone_, __LINE__) { name }
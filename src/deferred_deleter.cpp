@@ -0,0 +1,155 @@
+#include "deferred_deleter.hpp"
+#include "frame_scheduler.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+template<typename T>
+static T to_handle(const uint64_t handle)
+{
+    return T { std::bit_cast<typename T::CType>(handle) };
+}
+
+void DeferredDeleter::init(const vk::Device device, const VmaAllocator allocator, const size_t capacity)
+{
+    m_Device = device;
+    m_Allocator = allocator;
+
+    m_Records.resize(std::bit_ceil(std::max<size_t>(capacity, 1)));
+    m_Mask = m_Records.size() - 1;
+    m_Head = 0;
+    m_Tail = 0;
+}
+
+void DeferredDeleter::destroy()
+{
+    free_all();
+    m_Records.clear();
+    m_Records.shrink_to_fit();
+}
+
+void DeferredDeleter::begin_frame(FrameScheduler& scheduler, const uint64_t current_frame)
+{
+    // Pushes are stamped in frame order, the first pending frame stops the walk
+    while (m_Tail != m_Head) {
+        const Record& record = m_Records[m_Tail & m_Mask];
+        if (!scheduler.is_frame_complete(record.Frame)) {
+            break;
+        }
+
+        free(record);
+        m_Tail++;
+    }
+
+    m_CurrentFrame = current_frame;
+}
+
+void DeferredDeleter::push(const VmaAllocation allocation)
+{
+    if (allocation) {
+        push_record(vk::ObjectType::eUnknown, 0, allocation);
+    }
+}
+
+void DeferredDeleter::push(const ReleaseFunction release, void* const owner, const uint64_t value)
+{
+    assert(release);
+    push_record(vk::ObjectType::eUnknown, value, nullptr, release, owner);
+}
+
+void DeferredDeleter::flush()
+{
+    free_all();
+}
+
+void DeferredDeleter::push_record(const vk::ObjectType type, const uint64_t handle, const VmaAllocation allocation, const ReleaseFunction release, void* const owner)
+{
+    if (m_Head - m_Tail == m_Records.size()) {
+        LOG_ERROR("Deferred deletion ring full ({} records), waiting for the device", m_Records.size());
+        const auto _ = m_Device.waitIdle();
+        (void)_;
+        free_all();
+    }
+
+    m_Records[m_Head & m_Mask] = Record { m_CurrentFrame, handle, allocation, release, owner, type };
+    m_Head++;
+}
+
+void DeferredDeleter::free_all()
+{
+    for (; m_Tail != m_Head; m_Tail++) {
+        free(m_Records[m_Tail & m_Mask]);
+    }
+}
+
+void DeferredDeleter::free(const Record& record) const
+{
+    if (record.Release) {
+        record.Release(record.Owner, record.Handle);
+        return;
+    }
+
+    switch (record.Type) {
+    case vk::ObjectType::eUnknown:
+        vmaFreeMemory(m_Allocator, record.Allocation);
+        break;
+    case vk::ObjectType::eBuffer:
+        if (record.Allocation) {
+            vmaDestroyBuffer(m_Allocator, to_handle<vk::Buffer>(record.Handle), record.Allocation);
+        } else {
+            m_Device.destroyBuffer(to_handle<vk::Buffer>(record.Handle));
+        }
+        break;
+    case vk::ObjectType::eImage:
+        if (record.Allocation) {
+            vmaDestroyImage(m_Allocator, to_handle<vk::Image>(record.Handle), record.Allocation);
+        } else {
+            m_Device.destroyImage(to_handle<vk::Image>(record.Handle));
+        }
+        break;
+    case vk::ObjectType::eBufferView:
+        m_Device.destroyBufferView(to_handle<vk::BufferView>(record.Handle));
+        break;
+    case vk::ObjectType::eImageView:
+        m_Device.destroyImageView(to_handle<vk::ImageView>(record.Handle));
+        break;
+    case vk::ObjectType::eSampler:
+        m_Device.destroySampler(to_handle<vk::Sampler>(record.Handle));
+        break;
+    case vk::ObjectType::ePipeline:
+        m_Device.destroyPipeline(to_handle<vk::Pipeline>(record.Handle));
+        break;
+    case vk::ObjectType::ePipelineLayout:
+        m_Device.destroyPipelineLayout(to_handle<vk::PipelineLayout>(record.Handle));
+        break;
+    case vk::ObjectType::eShaderModule:
+        m_Device.destroyShaderModule(to_handle<vk::ShaderModule>(record.Handle));
+        break;
+    case vk::ObjectType::eDescriptorPool:
+        m_Device.destroyDescriptorPool(to_handle<vk::DescriptorPool>(record.Handle));
+        break;
+    case vk::ObjectType::eDescriptorSetLayout:
+        m_Device.destroyDescriptorSetLayout(to_handle<vk::DescriptorSetLayout>(record.Handle));
+        break;
+    case vk::ObjectType::eQueryPool:
+        m_Device.destroyQueryPool(to_handle<vk::QueryPool>(record.Handle));
+        break;
+    case vk::ObjectType::eCommandPool:
+        m_Device.destroyCommandPool(to_handle<vk::CommandPool>(record.Handle));
+        break;
+    case vk::ObjectType::eSemaphore:
+        m_Device.destroySemaphore(to_handle<vk::Semaphore>(record.Handle));
+        break;
+    case vk::ObjectType::eFence:
+        m_Device.destroyFence(to_handle<vk::Fence>(record.Handle));
+        break;
+    case vk::ObjectType::eEvent:
+        m_Device.destroyEvent(to_handle<vk::Event>(record.Handle));
+        break;
+    default:
+        LOG_ERROR("Deferred deletion of {} is not supported, leaking it", vk::to_string(record.Type));
+        break;
+    }
+}
+
+}
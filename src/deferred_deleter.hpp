@@ -0,0 +1,79 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+class FrameScheduler;
+
+/*
+ * Frees Vulkan handles and VMA allocations once the GPU is done with the frame that last used them.
+ * Records are fixed size and live in a ring allocated once, pushing never allocates nor captures anything.
+ * Handles are pushed with the frame being recorded and freed when the FrameScheduler reports it complete,
+ * a full ring waits for the device to go idle. Main thread only.
+ *
+ * What isn't a Vulkan handle, descriptor slots or arena ranges, goes through a release function called
+ * under the same rule, so every owner retires its resources the same way.
+ *
+ * DeletionQueue stays for the init / shutdown ordering, this is for what is freed while frames are in flight.
+ */
+class DeferredDeleter {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    // capacity is rounded up to a power of two
+    void init(vk::Device device, VmaAllocator allocator, size_t capacity = DEFAULT_CAPACITY);
+    // Frees everything left, the device must be idle
+    void destroy();
+
+    // Frees what completed frames released, then stamps the next pushes with current_frame
+    void begin_frame(FrameScheduler& scheduler, uint64_t current_frame);
+
+    // Any non dispatchable handle, with the allocation backing it for buffers and images
+    template<typename T>
+    void push(const T handle, const VmaAllocation allocation = nullptr)
+    {
+        static_assert(sizeof(typename T::CType) == sizeof(uint64_t), "Only non dispatchable handles can be deferred");
+        if (handle) {
+            push_record(T::objectType, std::bit_cast<uint64_t>(static_cast<typename T::CType>(handle)), allocation);
+        }
+    }
+
+    // Memory not bound to any handle pushed here
+    void push(VmaAllocation allocation);
+
+    // Called with owner and value once the frame completes. The owner flushes before it goes away
+    using ReleaseFunction = void (*)(void* owner, uint64_t value);
+    void push(ReleaseFunction release, void* owner, uint64_t value);
+
+    // Frees everything pending right away, the device must be idle
+    void flush();
+
+    [[nodiscard]] size_t get_pending() const { return static_cast<size_t>(m_Head - m_Tail); }
+
+private:
+    struct Record {
+        // Frame being recorded when it was pushed, that frame and the earlier ones may still use it
+        uint64_t Frame;
+        // Or the value handed to Release
+        uint64_t Handle;
+        VmaAllocation Allocation;
+        ReleaseFunction Release;
+        void* Owner;
+        vk::ObjectType Type;
+    };
+
+    vk::Device m_Device { nullptr };
+    VmaAllocator m_Allocator { nullptr };
+
+    // m_Head and m_Tail only grow and are masked on access
+    std::vector<Record> m_Records;
+    uint64_t m_Mask { 0 };
+    uint64_t m_Head { 0 };
+    uint64_t m_Tail { 0 };
+    uint64_t m_CurrentFrame { 0 };
+
+    void push_record(vk::ObjectType type, uint64_t handle, VmaAllocation allocation, ReleaseFunction release = nullptr, void* owner = nullptr);
+    void free(const Record& record) const;
+    void free_all();
+};
+
+}
@@ -11,22 +11,43 @@ Engine::~Engine()
     m_GpuManager.wait_idle();
     m_MainDeletionQueue.flush();
 
-    glfwDestroyWindow(m_Window);
-    glfwTerminate();
+    if (m_Window) {
+        glfwDestroyWindow(m_Window);
+    }
+
+    if (!m_Spec.Headless) {
+        glfwTerminate();
+    }
 }
 
-bool Engine::init(const uint32_t width, const uint32_t height)
+bool Engine::init(const EngineSpec& spec)
 {
     if (m_IsInitialized) {
         LOG_ERROR("Engine already init");
         return false;
     }
 
-    if (!init_window(width, height))
+    m_Spec = spec;
+    m_FramesInFlight = std::clamp(m_Spec.FramesInFlight, 1u, MAX_FRAMES_IN_FLIGHT);
+    if (m_FramesInFlight != m_Spec.FramesInFlight) {
+        LOG_ERROR("{} frames in flight requested, using {}", m_Spec.FramesInFlight, m_FramesInFlight);
+    }
+
+    if (!m_Spec.Headless && !init_window(m_Spec.Width, m_Spec.Height))
         return false;
 
     init_vulkan();
 
+    if (!init_descriptors()) {
+        LOG_ERROR("Failed to initialize descriptors");
+        return false;
+    }
+
+    if (!init_pipeline_cache()) {
+        LOG_ERROR("Failed to initialize pipeline cache");
+        return false;
+    }
+
     if (!init_pipelines()) {
         LOG_ERROR("Failed to initialize pipelines");
         return false;
@@ -42,6 +63,36 @@ bool Engine::init(const uint32_t width, const uint32_t height)
         return false;
     }
 
+    if (!init_uploads()) {
+        LOG_ERROR("Failed to initialize upload manager");
+        return false;
+    }
+
+    if (!init_meshes()) {
+        LOG_ERROR("Failed to initialize meshes");
+        return false;
+    }
+
+    if (!init_textures()) {
+        LOG_ERROR("Failed to initialize textures");
+        return false;
+    }
+
+    if (!init_world()) {
+        LOG_ERROR("Failed to initialize world");
+        return false;
+    }
+
+    if (!init_render_graph()) {
+        LOG_ERROR("Failed to initialize render graph");
+        return false;
+    }
+
+    if (!init_profilers()) {
+        LOG_ERROR("Failed to initialize profilers");
+        return false;
+    }
+
     m_IsInitialized = true;
     return true;
 }
@@ -52,6 +103,14 @@ static void framebuffer_resize_callback(GLFWwindow* window, [[maybe_unused]] con
     engine->ResizeRequested = true;
 }
 
+static void key_callback(GLFWwindow* window, const int key, [[maybe_unused]] const int scancode, const int action, [[maybe_unused]] const int mods)
+{
+    const auto engine = static_cast<Engine*>(glfwGetWindowUserPointer(window));
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+        engine->MemoryStatsRequested = true;
+    }
+}
+
 bool Engine::init_window(const uint32_t width, const uint32_t height)
 {
     if (!glfwInit()) {
@@ -73,59 +132,139 @@ bool Engine::init_window(const uint32_t width, const uint32_t height)
 
     glfwSetWindowUserPointer(m_Window, this);
     glfwSetFramebufferSizeCallback(m_Window, framebuffer_resize_callback);
+    glfwSetKeyCallback(m_Window, key_callback);
     return true;
 }
 
 void Engine::init_vulkan()
 {
-    const GpuManagerSpec spec {
+    GpuManagerSpec spec {
         "Minecraft",
         true,
         Logger::debug_callback,
-        m_Window
+        m_Window,
+        vk::Extent2D { m_Spec.Width, m_Spec.Height }
     };
+    spec.PresentMode = m_Spec.PresentMode;
+    spec.MinImageCount = m_FramesInFlight + 1;
+    spec.DrawImageFormat = m_Spec.DrawImageFormat;
+    spec.MaxDrawExtent = m_Spec.MaxDrawExtent;
+    spec.SwapchainStorage = m_Spec.SwapchainStorage;
 
     const auto& [device, draw_image] = m_GpuManager.init(spec);
     m_Device = device;
     m_DrawImageBundle = draw_image;
+    m_ImageStates.track(m_DrawImageBundle.Image, vk::ImageAspectFlagBits::eColor);
+    m_ImageStates.track(m_DrawImageBundle.DepthImage, vk::ImageAspectFlagBits::eDepth);
 
     m_MainDeletionQueue.push_function("GpuManager", [&] {
         m_GpuManager.destroy();
     });
 }
 
+bool Engine::init_descriptors()
+{
+    VK_CHECK(m_BindlessHeap.init(m_Device, m_GpuManager.get_physical_device(), m_GpuManager.get_deleter()));
+
+    m_MainDeletionQueue.push_function("Bindless Heap", [&] {
+        m_BindlessHeap.destroy();
+    });
+
+    return true;
+}
+
+bool Engine::init_pipeline_cache()
+{
+    if (m_Spec.PipelineCachePath.empty()) {
+        return true;
+    }
+
+    VK_CHECK(m_PipelineCache.init(m_Device, m_GpuManager.get_physical_device(), m_Spec.PipelineCachePath));
+
+    m_MainDeletionQueue.push_function("Pipeline Cache", [&] {
+        if (!m_PipelineCache.save()) {
+            LOG_ERROR("Failed to save pipeline cache");
+        }
+        m_PipelineCache.destroy();
+    });
+
+    return true;
+}
+
 bool Engine::init_pipelines()
 {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Registry workers may still be compiling with the modules, so it has to go first
+    m_ShaderLibrary.init(m_Device, m_Spec.ShaderDirectory);
+    m_MainDeletionQueue.push_function("Shader Library", [&] {
+        m_ShaderLibrary.destroy();
+    });
+
+    m_PipelineRegistry.init(m_Device, m_PipelineCache.get_handle() ? &m_PipelineCache : nullptr);
+    m_MainDeletionQueue.push_function("Pipeline Registry", [&] {
+        m_PipelineRegistry.destroy();
+    });
+
     if (!init_triangle_pipeline()) {
         LOG_ERROR("Failed to initialize triangle pipeline");
         return false;
     }
 
+    if (!init_chunk_pipelines()) {
+        LOG_ERROR("Failed to initialize chunk pipelines");
+        return false;
+    }
+
+    if (!m_Spec.Headless && !init_composite_pipeline()) {
+        LOG_ERROR("Failed to initialize composite pipeline");
+        return false;
+    }
+
+    // Everything above was only queued, compilation runs in parallel on the registry workers
+    if (!m_PipelineRegistry.wait_all()) {
+        LOG_ERROR("Failed to compile pipelines");
+        return false;
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    fmt::println("{} pipelines from {} shader modules built in {:.3f}ms ({} cache). {}",
+        m_PipelineRegistry.get_pipeline_count(), m_ShaderLibrary.get_module_count(), elapsed.count(),
+        m_PipelineCache.was_loaded() ? "warm" : "cold", m_PipelineCache.summary());
+
     return true;
 }
 
 bool Engine::init_triangle_pipeline()
 {
-    const auto vert_result = VkUtil::load_shader_module("../resources/shaders/basic.vert.spv", m_Device);
+    const auto vert_result = m_ShaderLibrary.load("basic.vert.spv");
     if (!vert_result.has_value()) {
         LOG_ERROR("Failed to create shader module: {}", vert_result.error());
         return false;
     }
-    const vk::ShaderModule vertex_module = vert_result.value();
 
-    const auto frag_result = VkUtil::load_shader_module("../resources/shaders/basic.frag.spv", m_Device);
+    const auto frag_result = m_ShaderLibrary.load("basic.frag.spv");
     if (!frag_result.has_value()) {
         LOG_ERROR("Failed to create shader module: {}", frag_result.error());
         return false;
     }
-    const vk::ShaderModule fragment_module = frag_result.value();
 
-    const vk::PipelineLayoutCreateInfo pipeline_layout_info = VkInit::pipeline_layout_create_info();
-    VK_CHECK(m_Device.createPipelineLayout(&pipeline_layout_info, nullptr, &m_TrianglePipeline.Layout));
+    const auto pull_result = m_ShaderLibrary.load("mesh_pull.vert.spv");
+    if (!pull_result.has_value()) {
+        LOG_ERROR("Failed to create shader module: {}", pull_result.error());
+        return false;
+    }
+
+    const std::array shaders { vert_result.value(), frag_result.value() };
+    const std::array pulled_shaders { pull_result.value(), frag_result.value() };
+
+    constexpr std::array bindings { VertexLayoutBasic::binding_description() };
+    constexpr auto attributes = VertexLayoutBasic::attribute_descriptions();
 
     PipelineBuilder builder;
     builder
-        .set_shaders(vertex_module, fragment_module)
+        .set_shaders(m_ShaderLibrary.get_module(shaders[0]), m_ShaderLibrary.get_module(shaders[1]))
+        .set_vertex_input(bindings, attributes)
         .set_input_topology(vk::PrimitiveTopology::eTriangleList)
         .set_polygon_mode(vk::PolygonMode::eFill)
         .set_cull_mode(vk::CullModeFlagBits::eNone, vk::FrontFace::eClockwise)
@@ -133,32 +272,112 @@ bool Engine::init_triangle_pipeline()
         .disable_blending()
         .disable_depth_test()
         .set_color_attachment_format(m_DrawImageBundle.Format)
-        .set_depth_format(vk::Format::eUndefined);
+        .set_depth_format(m_DrawImageBundle.DepthFormat);
 
-    const auto pipeline_result = builder.build_pipeline(m_Device, m_TrianglePipeline.Layout);
-    if (!pipeline_result.has_value()) {
-        LOG_ERROR("Failed to create triangle pipeline: {}", vk::to_string(pipeline_result.error()));
+    // Shared by both paths, the fixed function one simply ignores the push constants
+    static_assert(sizeof(MeshPushConstants) <= BindlessHeap::PUSH_CONSTANT_SIZE);
+    m_TrianglePipeline = m_PipelineRegistry.request(builder, m_BindlessHeap.get_pipeline_layout(), shaders);
+
+    builder
+        .set_shaders(m_ShaderLibrary.get_module(pulled_shaders[0]), m_ShaderLibrary.get_module(pulled_shaders[1]))
+        .set_vertex_input({}, {});
+    m_PulledTrianglePipeline = m_PipelineRegistry.request(builder, m_BindlessHeap.get_pipeline_layout(), pulled_shaders);
+    return true;
+}
+
+bool Engine::init_chunk_pipelines()
+{
+    const auto vert_result = m_ShaderLibrary.load("chunk.vert.spv");
+    if (!vert_result.has_value()) {
+        LOG_ERROR("Failed to create shader module: {}", vert_result.error());
         return false;
     }
 
-    m_TrianglePipeline.Handle = pipeline_result.value();
+    const auto frag_result = m_ShaderLibrary.load("chunk.frag.spv");
+    if (!frag_result.has_value()) {
+        LOG_ERROR("Failed to create shader module: {}", frag_result.error());
+        return false;
+    }
 
-    m_Device.destroyShaderModule(vertex_module);
-    m_Device.destroyShaderModule(fragment_module);
+    const auto cull_result = m_ShaderLibrary.load("chunk_cull.comp.spv");
+    if (!cull_result.has_value()) {
+        LOG_ERROR("Failed to create shader module: {}", cull_result.error());
+        return false;
+    }
 
-    m_MainDeletionQueue.push_function("Triangle Pipeline", [&] {
-        m_Device.destroyPipelineLayout(m_TrianglePipeline.Layout);
-        m_Device.destroyPipeline(m_TrianglePipeline.Handle);
-    });
+    const std::array shaders { vert_result.value(), frag_result.value() };
+    const std::array cull_shaders { cull_result.value() };
+
+    // Vertices are pulled from the arena, quads are counter-clockwise seen from outside.
+    // Sections are drawn in no particular order, the depth buffer sorts them out
+    PipelineBuilder builder;
+    builder
+        .set_shaders(m_ShaderLibrary.get_module(shaders[0]), m_ShaderLibrary.get_module(shaders[1]))
+        .set_vertex_input({}, {})
+        .set_input_topology(vk::PrimitiveTopology::eTriangleList)
+        .set_polygon_mode(vk::PolygonMode::eFill)
+        .set_cull_mode(vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise)
+        .set_multisampling_none()
+        .disable_blending()
+        .enable_depth_test(true, vk::CompareOp::eLess)
+        .set_color_attachment_format(m_DrawImageBundle.Format)
+        .set_depth_format(m_DrawImageBundle.DepthFormat);
+    m_ChunkPipeline = m_PipelineRegistry.request(builder, m_BindlessHeap.get_pipeline_layout(), shaders);
+
+    PipelineBuilder cull_builder;
+    cull_builder.set_compute_shader(m_ShaderLibrary.get_module(cull_shaders[0]));
+    m_ChunkCullPipeline = m_PipelineRegistry.request(cull_builder, m_BindlessHeap.get_pipeline_layout(), cull_shaders);
+    return true;
+}
+
+bool Engine::init_composite_pipeline()
+{
+    const auto comp_result = m_ShaderLibrary.load("composite.comp.spv");
+    if (!comp_result.has_value()) {
+        LOG_ERROR("Failed to create shader module: {}", comp_result.error());
+        return false;
+    }
+
+    const std::array shaders { comp_result.value() };
+
+    PipelineBuilder builder;
+    builder.set_compute_shader(m_ShaderLibrary.get_module(shaders[0]));
+    m_CompositePipeline = m_PipelineRegistry.request(builder, m_BindlessHeap.get_pipeline_layout(), shaders);
     return true;
 }
 
+void Engine::update_pipelines()
+{
+    CPU_ZONE("Update Pipelines");
+
+    m_PipelineRegistry.collect_retired(m_GpuManager.get_deleter());
+    if (m_PipelineRegistry.is_idle()) {
+        m_ShaderLibrary.destroy_retired();
+    }
+
+    if (!m_Spec.HotReloadShaders) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - m_LastShaderPoll < SHADER_POLL_INTERVAL) {
+        return;
+    }
+    m_LastShaderPoll = now;
+
+    const std::vector<ShaderHandle> changed = m_ShaderLibrary.poll_changes();
+    if (!changed.empty()) {
+        [[maybe_unused]] const uint32_t count = m_PipelineRegistry.reload(changed, m_ShaderLibrary);
+        LOG("{} shaders changed, recompiling {} pipelines", changed.size(), count);
+    }
+}
+
 bool Engine::init_commands()
 {
     constexpr auto flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
     constexpr auto level = vk::CommandBufferLevel::ePrimary;
 
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (uint32_t i = 0; i < m_FramesInFlight; i++) {
         // Command pool
         const auto pres = m_GpuManager.create_command_pool(flags);
         if (!pres.has_value()) {
@@ -180,15 +399,18 @@ bool Engine::init_commands()
 bool Engine::create_sync_objects()
 {
     constexpr vk::SemaphoreCreateFlags semaphore_flags {};
-    constexpr vk::FenceCreateFlags fence_flags { vk::FenceCreateFlagBits::eSignaled };
 
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    const auto timeline_res = m_GpuManager.create_timeline_semaphore(0);
+    if (!timeline_res.has_value()) {
+        VK_CHECK(timeline_res.error());
+    }
+    m_FrameScheduler.init(m_Device, timeline_res.value());
 
-        const auto fence_res = m_GpuManager.create_fence(fence_flags);
-        if (!fence_res.has_value()) {
-            VK_CHECK(fence_res.error());
-        }
-        m_Frames[i].RenderFence = fence_res.value();
+    if (m_Spec.Headless) {
+        return true;
+    }
+
+    for (uint32_t i = 0; i < m_FramesInFlight; i++) {
 
         const auto semaphore1_res = m_GpuManager.create_semaphore(semaphore_flags);
         if (!semaphore1_res.has_value()) {
@@ -206,22 +428,188 @@ bool Engine::create_sync_objects()
     return true;
 }
 
-void Engine::draw_background(const vk::CommandBuffer cmd) const
+bool Engine::init_render_graph()
+{
+    m_RenderGraph.init(m_Device, m_GpuManager.get_allocator());
+
+    m_MainDeletionQueue.push_function("Render Graph", [&] {
+        m_RenderGraph.destroy();
+    });
+
+    // Fully redrawn every frame
+    m_GraphDrawImage = m_RenderGraph.import_image("Draw Image", vk::ImageAspectFlagBits::eColor, true);
+    m_GraphDepthImage = m_RenderGraph.import_image("Depth Image", vk::ImageAspectFlagBits::eDepth, true);
+
+    constexpr vk::ClearValue clear_value { vk::ClearColorValue { 0.0f, 0.0f, 0.0f, 1.0f } };
+    // Standard [0, 1] depth from perspectiveRH_ZO, the far plane is 1
+    constexpr vk::ClearValue depth_clear_value { vk::ClearDepthStencilValue { 1.0f, 0 } };
+    m_RenderGraph.add_pass("Geometry")
+        .write(m_GraphDrawImage, ImageUsage::eColorAttachment, clear_value)
+        .write(m_GraphDepthImage, ImageUsage::eDepthAttachment, depth_clear_value)
+        .execute([this](const vk::CommandBuffer cmd, const RenderGraphContext& ctx) {
+            draw_geometry(cmd, ctx.attachment(m_GraphDrawImage), ctx.attachment(m_GraphDepthImage));
+        });
+
+    if (!m_Spec.Headless) {
+        VK_CHECK(m_Compositor.init(m_GpuManager, m_BindlessHeap, CompositeSpec { .Tonemap = m_Spec.Tonemap, .Exposure = m_Spec.Exposure }));
+        m_MainDeletionQueue.push_function("Compositor", [&] {
+            m_Compositor.destroy();
+        });
+
+        m_GraphSwapchainImage = m_RenderGraph.import_image("Swapchain Image", vk::ImageAspectFlagBits::eColor, true);
+
+        // Reads the draw image once, everything up to the output format happens in the dispatch
+        if (!m_Compositor.writes_swapchain()) {
+            m_GraphCompositeImage = m_RenderGraph.import_image("Composite Image", vk::ImageAspectFlagBits::eColor, true);
+        }
+        const RenderGraphImage composite_target = m_Compositor.writes_swapchain() ? m_GraphSwapchainImage : m_GraphCompositeImage;
+
+        m_RenderGraph.add_pass("Composite")
+            .read(m_GraphDrawImage, ImageUsage::eComputeSampled)
+            .write(composite_target, ImageUsage::eComputeStorageWrite)
+            .execute([this, composite_target](const vk::CommandBuffer cmd, const RenderGraphContext& ctx) {
+                m_Compositor.record(cmd, m_PipelineRegistry.get(m_CompositePipeline).Handle, m_DrawExtent, ctx.image(composite_target));
+            });
+
+        if (!m_Compositor.writes_swapchain()) {
+            m_RenderGraph.add_pass("Copy To Swapchain")
+                .read(m_GraphCompositeImage, ImageUsage::eCopySrc)
+                .write(m_GraphSwapchainImage, ImageUsage::eCopyDst)
+                .execute([this](const vk::CommandBuffer cmd, const RenderGraphContext& ctx) {
+                    VkUtil::copy_image(cmd, ctx.image(m_GraphCompositeImage), ctx.image(m_GraphSwapchainImage), ctx.extent(m_GraphSwapchainImage));
+                });
+        }
+
+        m_RenderGraph.set_final_usage(m_GraphSwapchainImage, ImageUsage::ePresent);
+    }
+
+    return m_RenderGraph.compile();
+}
+
+bool Engine::init_uploads()
 {
-    constexpr vk::ClearColorValue clear_value = { 0.0f, 0.0f, 0.0f, 1.0f };
-    const vk::ImageSubresourceRange clear_range = VkUtil::image_subresource_range(vk::ImageAspectFlagBits::eColor);
+    VK_CHECK(m_UploadManager.init(m_GpuManager));
 
-    cmd.clearColorImage(m_DrawImageBundle.Image, vk::ImageLayout::eGeneral, &clear_value, 1, &clear_range);
+    m_MainDeletionQueue.push_function("Upload Manager", [&] {
+        m_UploadManager.destroy();
+    });
+
+    return true;
 }
 
-void Engine::draw_geometry(const vk::CommandBuffer cmd) const
+bool Engine::init_meshes()
 {
-    const vk::RenderingAttachmentInfo color_attachment = VkInit::attachment_info(m_DrawImageBundle.ImageView, nullptr, vk::ImageLayout::eColorAttachmentOptimal);
+    m_MeshManager.init(m_Device, m_GpuManager.get_memory(), m_UploadManager);
+    m_MainDeletionQueue.push_function("Mesh Manager", [&] {
+        m_MeshManager.destroy();
+    });
 
-    const vk::RenderingInfo rendering_info = VkInit::rendering_info(m_DrawExtent, &color_attachment, nullptr);
+    const std::array<Vertex, 3> vertices { {
+        { { 0.5f, 0.5f, 0.0f }, { 1.0f, 0.0f, 0.0f } },
+        { { -0.5f, 0.5f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+        { { 0.0f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+    } };
+    constexpr std::array<uint32_t, 3> indices { 0, 1, 2 };
+
+    const auto mesh = m_MeshManager.create<Vertex>(vertices, indices);
+    if (!mesh.has_value()) {
+        VK_CHECK(mesh.error());
+    }
+    m_TriangleMesh = mesh.value();
+
+    return true;
+}
+
+bool Engine::init_textures()
+{
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_Spec.TextureDirectory, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".ktx2") {
+            files.push_back(entry.path());
+        }
+    }
+
+    if (files.empty()) {
+        LOG("No block textures in {}", m_Spec.TextureDirectory.string());
+        return true;
+    }
+    std::ranges::sort(files);
+
+    // Files are loaded in the background, frames start with whatever is resident
+    VK_CHECK(m_BlockTextures.init(m_GpuManager, m_UploadManager, m_BindlessHeap, TextureArraySpec {
+        .Files = std::move(files),
+        .Extent = vk::Extent2D { m_Spec.BlockTextureSize, m_Spec.BlockTextureSize },
+        .Format = m_Spec.BlockTextureFormat,
+    }));
+
+    m_MainDeletionQueue.push_function("Block Textures", [&] {
+        m_BlockTextures.destroy();
+    });
+
+    return true;
+}
+
+bool Engine::init_world()
+{
+    // Room for every chunk in the square around the view circle
+    const uint32_t view_width = 2 * m_Spec.ViewDistance + 1;
+    VK_CHECK(m_ChunkRenderer.init(m_GpuManager, m_UploadManager, m_BindlessHeap, ChunkRendererSpec { .MaxChunks = view_width * view_width }));
+    m_MainDeletionQueue.push_function("Chunk Renderer", [&] {
+        m_ChunkRenderer.destroy();
+    });
+
+    m_Jobs.init(m_Spec.WorkerThreads);
+    m_MainDeletionQueue.push_function("Job System", [&] {
+        m_Jobs.destroy();
+    });
+
+    m_World.init(m_Jobs, m_ChunkRenderer, WorldSpec { .ViewDistance = m_Spec.ViewDistance });
+    m_MainDeletionQueue.push_function("World", [&] {
+        m_World.destroy();
+    });
+
+    LOG("{} job workers, view distance of {} chunks", m_Jobs.get_worker_count(), m_Spec.ViewDistance);
+    return true;
+}
+
+bool Engine::init_profilers()
+{
+    VK_CHECK(m_GpuProfiler.init(m_Device, m_GpuManager.get_physical_device(),
+        m_GpuManager.get_graphics_queue_family(), m_FramesInFlight));
+
+    m_MainDeletionQueue.push_function("GPU Profiler", [&] {
+        m_GpuProfiler.destroy();
+    });
+
+    // Timings come back a frame slot later, the first frame at a new scale is measured after as many frames
+    m_Resolution.init(ResolutionSpec {
+        .TargetMs = m_Spec.TargetGpuMs > 0.0 ? m_Spec.TargetGpuMs : m_Spec.FrameBudgetMs,
+        .MinScale = m_Spec.MinRenderScale,
+    }, m_FramesInFlight);
+
+    return true;
+}
+
+glm::mat4 Engine::get_view_projection() const
+{
+    // Looks down the direction of travel, tilted toward the ground
+    const glm::mat4 view = glm::lookAt(m_CameraPosition, m_CameraPosition + glm::vec3 { 1.0f, -0.35f, 0.0f }, glm::vec3 { 0.0f, 1.0f, 0.0f });
+
+    const float aspect = static_cast<float>(m_DrawExtent.width) / static_cast<float>(std::max(m_DrawExtent.height, 1u));
+    const float far_plane = static_cast<float>((m_Spec.ViewDistance + 1) * ChunkSection::SIZE) * 2.0f;
+    glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(m_Spec.FieldOfView), aspect, 0.1f, far_plane);
+    // Vulkan clip space has Y pointing down
+    projection[1][1] *= -1.0f;
+
+    return projection * view;
+}
+
+void Engine::draw_geometry(const vk::CommandBuffer cmd, const vk::RenderingAttachmentInfo& color_attachment, const vk::RenderingAttachmentInfo& depth_attachment) const
+{
+    const vk::RenderingInfo rendering_info = VkInit::rendering_info(m_DrawExtent, &color_attachment, &depth_attachment);
 
     cmd.beginRendering(&rendering_info);
-    cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, m_TrianglePipeline.Handle);
 
     vk::Viewport viewport {};
     viewport.x = 0;
@@ -239,12 +627,35 @@ void Engine::draw_geometry(const vk::CommandBuffer cmd) const
     scissor.extent.height = m_DrawExtent.height;
     cmd.setScissor(0, 1, &scissor);
 
-    cmd.draw(3, 1, 0, 0);
+    // Every visible chunk section in one call, the draws were written by the cull pass
+    m_ChunkRenderer.record_draw(cmd, m_PipelineRegistry.get(m_ChunkPipeline).Handle, m_ViewProjection, m_BlockTextures.get_bindless_index());
+
+    // Still compiling, skip the draw rather than stalling the frame
+    const PipelineBundle triangle_pipeline = m_PipelineRegistry.get(m_Spec.VertexPulling ? m_PulledTrianglePipeline : m_TrianglePipeline);
+    const GpuMesh* mesh = m_MeshManager.get(m_TriangleMesh);
+    if (!triangle_pipeline.Handle || !mesh) {
+        cmd.endRendering();
+        return;
+    }
+
+    cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, triangle_pipeline.Handle);
+
+    if (m_Spec.VertexPulling) {
+        const MeshPushConstants push_constants { mesh->VertexAddress };
+        cmd.pushConstants(triangle_pipeline.Layout, BindlessHeap::PUSH_CONSTANT_STAGES, 0, sizeof(MeshPushConstants), &push_constants);
+        cmd.bindIndexBuffer(mesh->IndexBuffer.Buffer, 0, vk::IndexType::eUint32);
+    } else {
+        m_MeshManager.bind(cmd, m_TriangleMesh);
+    }
+
+    cmd.drawIndexed(mesh->IndexCount, 1, 0, 0, 0);
     cmd.endRendering();
 }
 
 bool Engine::record_command_buffer(const vk::CommandBuffer cmd, const vk::Image swapchain_image, const vk::Extent2D swapchain_extent)
 {
+    CPU_ZONE("Record");
+
     constexpr auto flags {
         vk::CommandBufferUsageFlagBits::eOneTimeSubmit
     };
@@ -254,41 +665,114 @@ bool Engine::record_command_buffer(const vk::CommandBuffer cmd, const vk::Image
         nullptr
     };
 
-    m_DrawExtent.width = static_cast<uint32_t>(static_cast<float>(std::min(swapchain_extent.width, m_DrawImageBundle.Extent.width)) * m_RenderScale);
-    m_DrawExtent.height = static_cast<uint32_t>(static_cast<float>(std::min(swapchain_extent.height, m_DrawImageBundle.Extent.height)) * m_RenderScale);
+    // A resize reallocates the draw and depth images, the previous ones stay alive until older frames are done with them
+    if (const DrawImageBundle draw_image = m_GpuManager.get_draw_image(); draw_image.Image != m_DrawImageBundle.Image) {
+        m_ImageStates.forget(m_DrawImageBundle.Image);
+        m_ImageStates.forget(m_DrawImageBundle.DepthImage);
+        m_DrawImageBundle = draw_image;
+        m_ImageStates.track(m_DrawImageBundle.Image, vk::ImageAspectFlagBits::eColor);
+        m_ImageStates.track(m_DrawImageBundle.DepthImage, vk::ImageAspectFlagBits::eDepth);
+    }
+
+    m_DrawExtent.width = std::max(static_cast<uint32_t>(static_cast<float>(std::min(swapchain_extent.width, m_DrawImageBundle.Extent.width)) * m_RenderScale), 1u);
+    m_DrawExtent.height = std::max(static_cast<uint32_t>(static_cast<float>(std::min(swapchain_extent.height, m_DrawImageBundle.Extent.height)) * m_RenderScale), 1u);
 
     VK_CHECK(cmd.begin(create_info));
 
-    // TODO look into better layouts
+    // Take ownership of whatever the transfer queue delivered since the last frame
+    m_UploadManager.record_acquires(cmd);
+    // Moves meshes ahead of the record writes and draws of this frame
+    const bool idle = is_idle_frame();
+    m_MeshManager.defragment(cmd, m_FrameNumber, m_FrameScheduler, idle);
+    m_ChunkRenderer.compact(cmd, idle);
+    m_BlockTextures.record(cmd);
+
+    // Bound once, pipelines only differ in their push constants
+    m_BindlessHeap.bind(cmd, vk::PipelineBindPoint::eGraphics);
+    m_BindlessHeap.bind(cmd, vk::PipelineBindPoint::eCompute);
+
+    const vk::Extent2D draw_image_extent { m_DrawImageBundle.Extent.width, m_DrawImageBundle.Extent.height };
+    m_RenderGraph.bind_image(m_GraphDrawImage, m_DrawImageBundle.Image, m_DrawImageBundle.ImageView, draw_image_extent);
+    m_RenderGraph.bind_image(m_GraphDepthImage, m_DrawImageBundle.DepthImage, m_DrawImageBundle.DepthImageView, draw_image_extent);
+
+    if (swapchain_image) {
+        // The driver may hand out the same handle values again, drop what the destroyed images left behind
+        if (const SwapchainBundle& swapchain = m_GpuManager.get_swapchain(); swapchain.Generation != m_SwapchainGeneration) {
+            for (const vk::Image image : m_SwapchainImages) {
+                m_ImageStates.forget(image);
+            }
+            m_SwapchainGeneration = swapchain.Generation;
+            m_SwapchainImages.assign(swapchain.Images.begin(), swapchain.Images.end());
+        }
 
-    VkUtil::transition_image(cmd, m_DrawImageBundle.Image, vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral);
+        // Acquired images come with unknown content, the acquire semaphore is waited at color attachment output
+        m_ImageStates.track(swapchain_image, vk::ImageAspectFlagBits::eColor,
+            ImageState { vk::ImageLayout::eUndefined, vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eNone });
+        m_RenderGraph.bind_image(m_GraphSwapchainImage, swapchain_image, nullptr, swapchain_extent);
+
+        m_Compositor.update(m_DrawImageBundle);
+        if (const AllocatedImage& composite_image = m_Compositor.get_intermediate(); composite_image.Image) {
+            if (composite_image.Image != m_CompositeImage) {
+                m_ImageStates.forget(m_CompositeImage);
+                m_CompositeImage = composite_image.Image;
+                m_ImageStates.track(m_CompositeImage, vk::ImageAspectFlagBits::eColor);
+            }
+            m_RenderGraph.bind_image(m_GraphCompositeImage, composite_image.Image, composite_image.ImageView, swapchain_extent);
+        }
+    }
 
-    draw_background(cmd);
+    // The slot was waited on before recording, its previous timestamps are ready to read
+    m_GpuProfiler.begin_frame(cmd, get_current_frame_slot(), m_FrameNumber);
+    {
+        GpuProfiler::Scope frame_scope { &m_GpuProfiler, cmd, "Frame" };
 
-    VkUtil::transition_image(cmd, m_DrawImageBundle.Image, vk::ImageLayout::eGeneral, vk::ImageLayout::eColorAttachmentOptimal);
+        // Only touches buffers, so it stays out of the graph and ends with its own barrier to the indirect draw
+        m_ViewProjection = get_view_projection();
+        {
+            GpuProfiler::Scope cull_scope { &m_GpuProfiler, cmd, "Chunk Cull" };
+            m_ChunkRenderer.record_cull(cmd, m_PipelineRegistry.get(m_ChunkCullPipeline).Handle, m_ViewProjection);
+        }
 
-    draw_geometry(cmd);
+        m_RenderGraph.execute(cmd, m_ImageStates, &m_GpuProfiler);
+    }
 
-    // transition the draw image and the swapchain image into their correct transfer layouts
-    VkUtil::transition_image(cmd, m_DrawImageBundle.Image, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal);
-    VkUtil::transition_image(cmd, swapchain_image, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
+    VK_CHECK(cmd.end());
 
-    VkUtil::copy_image_to_image(cmd,
-        m_DrawImageBundle.Image, swapchain_image,
-        m_DrawExtent, swapchain_extent);
+    return true;
+}
 
-    VkUtil::transition_image(cmd, swapchain_image, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR);
+bool Engine::wait_for_frame_slot()
+{
+    // The slot we are about to record into was last used m_FramesInFlight frames ago
+    if (m_FrameNumber < m_FramesInFlight) {
+        return true;
+    }
 
-    VK_CHECK(cmd.end());
+    CPU_ZONE("Wait For Frame");
+    ScopedTimer timer { m_CurrentTimings.FrameWait };
+    VK_CHECK(m_FrameScheduler.wait_for_frame(m_FrameNumber - m_FramesInFlight, UINT64_MAX));
+    return true;
+}
 
+bool Engine::flush_uploads()
+{
+    VK_CHECK(m_UploadManager.flush());
     return true;
 }
 
 bool Engine::draw_frame()
 {
-    VK_CHECK(m_GpuManager.wait_fence(get_current_frame().RenderFence, UINT64_MAX));
+    if (!wait_for_frame_slot() || !flush_uploads()) {
+        return false;
+    }
+
+    std::expected<vk::Image, vk::Result> res;
+    {
+        CPU_ZONE("Acquire");
+        ScopedTimer timer { m_CurrentTimings.Acquire };
+        res = m_GpuManager.get_next_swapchain_image(get_current_frame().SwapChainSemaphore, UINT64_MAX);
+    }
 
-    const auto res = m_GpuManager.get_next_swapchain_image(get_current_frame().SwapChainSemaphore, UINT64_MAX);
     if (!res.has_value()) {
         LOG_ERROR("Failed to acquire swap chain image");
         return false;
@@ -297,8 +781,6 @@ bool Engine::draw_frame()
     const vk::Image swapchain_image = res.value();
     const vk::Extent2D swapchain_extent = m_GpuManager.get_swapchain_extent();
 
-    VK_CHECK(m_GpuManager.reset_fence(get_current_frame().RenderFence));
-
     const vk::CommandBuffer& cmd = get_current_frame().CommandBuffer;
     VK_CHECK(cmd.reset());
 
@@ -311,52 +793,248 @@ bool Engine::draw_frame()
         cmd, 0
     };
 
-    vk::SemaphoreSubmitInfo wait_info {
-        get_current_frame().SwapChainSemaphore, 1,
-        vk::PipelineStageFlagBits2KHR::eColorAttachmentOutput
+    std::array<vk::SemaphoreSubmitInfo, 2> wait_infos {
+        vk::SemaphoreSubmitInfo {
+            get_current_frame().SwapChainSemaphore, 1,
+            vk::PipelineStageFlagBits2KHR::eColorAttachmentOutput }
     };
+    uint32_t wait_count = 1;
+
+    if (const auto upload_wait = m_UploadManager.acquire_wait_info()) {
+        wait_infos[wait_count++] = upload_wait.value();
+    }
+
+    const std::array signal_infos {
+        vk::SemaphoreSubmitInfo {
+            get_current_frame().RenderSemaphore, 1,
+            vk::PipelineStageFlagBits2::eAllCommands },
+        m_FrameScheduler.signal_info(m_FrameNumber, vk::PipelineStageFlagBits2::eAllCommands)
+    };
+
+    const vk::SubmitInfo2 submit_info {
+        {},
+        wait_count, wait_infos.data(),
+        1, &cmd_info,
+        static_cast<uint32_t>(signal_infos.size()), signal_infos.data()
+    };
+
+    {
+        CPU_ZONE("Submit");
+        VK_CHECK(m_GpuManager.submit_to_queue(submit_info, nullptr));
+        m_FrameScheduler.mark_submitted(m_FrameNumber);
+    }
+
+    {
+        CPU_ZONE("Present");
+        ScopedTimer timer { m_CurrentTimings.Present };
+        VK_CHECK(m_GpuManager.present(1, &get_current_frame().RenderSemaphore));
+    }
 
-    vk::SemaphoreSubmitInfo signal_info {
-        get_current_frame().RenderSemaphore, 1,
-        vk::PipelineStageFlagBits2::eAllGraphics
+    m_FrameNumber++;
+    return true;
+}
+
+bool Engine::draw_frame_headless()
+{
+    if (!wait_for_frame_slot() || !flush_uploads()) {
+        return false;
+    }
+
+    const vk::CommandBuffer& cmd = get_current_frame().CommandBuffer;
+    VK_CHECK(cmd.reset());
+
+    if (!record_command_buffer(cmd, nullptr, m_GpuManager.get_swapchain_extent())) {
+        LOG_ERROR("Failed to record on the command buffer");
+        return false;
+    }
+
+    vk::CommandBufferSubmitInfo cmd_info {
+        cmd, 0
     };
 
+    const std::optional<vk::SemaphoreSubmitInfo> upload_wait = m_UploadManager.acquire_wait_info();
+    const vk::SemaphoreSubmitInfo signal_info = m_FrameScheduler.signal_info(m_FrameNumber, vk::PipelineStageFlagBits2::eAllCommands);
+
     const vk::SubmitInfo2 submit_info {
         {},
-        1, &wait_info,
+        upload_wait.has_value() ? 1u : 0u, upload_wait.has_value() ? &upload_wait.value() : nullptr,
         1, &cmd_info,
         1, &signal_info
     };
 
-    VK_CHECK(m_GpuManager.submit_to_queue(submit_info, get_current_frame().RenderFence));
-    VK_CHECK(m_GpuManager.present(1, &get_current_frame().RenderSemaphore));
+    {
+        CPU_ZONE("Submit");
+        VK_CHECK(m_GpuManager.submit_to_queue(submit_info, nullptr));
+        m_FrameScheduler.mark_submitted(m_FrameNumber);
+    }
 
     m_FrameNumber++;
     return true;
 }
 
+bool Engine::should_stop(const std::chrono::steady_clock::time_point start) const
+{
+    if (m_Spec.FrameCount > 0 && m_FrameNumber >= m_Spec.FrameCount) {
+        return true;
+    }
+
+    if (m_Spec.Duration > 0.0) {
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= m_Spec.Duration) {
+            return true;
+        }
+    }
+
+    return !m_Spec.Headless && glfwWindowShouldClose(m_Window);
+}
+
+bool Engine::is_idle_frame() const
+{
+    if (m_UploadManager.get_staging_in_use() != 0 || !m_World.is_idle() || m_Telemetry.sample_count() == 0) {
+        return false;
+    }
+
+    // Frame wall time includes the waits on the frame slot, acquire and present, which vsync stretches to the budget.
+    // Only the work left once they are taken out tells whether there is room to spare
+    const FrameTimings average = m_Telemetry.average();
+    const double cpu_work_ms = average.Frame - average.FrameWait - average.Acquire - average.Present;
+    // 0 without timestamp support, the CPU side then decides alone
+    const double gpu_work_ms = m_GpuProfiler.get_last_frame_ms();
+    const double idle_threshold_ms = m_Spec.FrameBudgetMs * 0.75;
+    return cpu_work_ms < idle_threshold_ms && gpu_work_ms < idle_threshold_ms;
+}
+
+void Engine::dump_memory_stats()
+{
+    if (m_Spec.MemoryStatsPath.empty()) {
+        return;
+    }
+
+    if (m_GpuManager.get_memory().dump_stats(m_Spec.MemoryStatsPath)) {
+        fmt::println("Memory statistics written to {}", m_Spec.MemoryStatsPath.string());
+    }
+}
+
 bool Engine::run()
 {
     m_Running = true;
     LOG("Engine started");
-    while (m_Running) {
 
-        if (ResizeRequested) {
-            int width, height;
-            glfwGetFramebufferSize(m_Window, &width, &height);
-            m_GpuManager.request_resize(width, height);
-            ResizeRequested = false;
+    CpuProfiler::set_thread_name("Main");
+    CpuProfiler::set_frame_budget(m_Spec.FrameBudgetMs);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    auto previous_frame_start = start;
+    while (m_Running) {
+        const auto frame_start = std::chrono::steady_clock::now();
+        const std::chrono::duration<float> delta = frame_start - previous_frame_start;
+        previous_frame_start = frame_start;
+        m_CurrentTimings = {};
+        CpuProfiler::begin_frame(m_FrameNumber);
+
+        // First, so everything released while this frame is built gets stamped with it
+        m_GpuManager.get_deleter().begin_frame(m_FrameScheduler, m_FrameNumber);
+        update_pipelines();
+        m_MeshManager.collect_retired(m_FrameScheduler);
+        m_GpuManager.get_memory().update(m_FrameNumber);
+        m_BlockTextures.update();
+
+        m_CameraPosition.x += m_Spec.CameraSpeed * delta.count();
+        m_World.update(m_CameraPosition);
+
+        if (m_Spec.DynamicResolution && !m_Spec.Headless) {
+            m_RenderScale = m_Resolution.update(m_GpuProfiler.get_last_frame_number(), m_GpuProfiler.get_last_frame_ms());
         }
 
-        glfwPollEvents();
+        if (m_Spec.Headless) {
+            if (!draw_frame_headless()) {
+                LOG_ERROR("Error in frame");
+                return false;
+            }
+        } else {
+            if (ResizeRequested) {
+                int width, height;
+                glfwGetFramebufferSize(m_Window, &width, &height);
+                m_GpuManager.request_resize(width, height);
+                ResizeRequested = false;
+            }
+
+            if (MemoryStatsRequested) {
+                dump_memory_stats();
+                MemoryStatsRequested = false;
+            }
+
+            {
+                CPU_ZONE("Poll Events");
+                glfwPollEvents();
+            }
+
+            if (!draw_frame()) {
+                LOG_ERROR("Error in frame");
+            }
+        }
 
-        if (!draw_frame()) {
-            LOG_ERROR("Error in frame");
+        CpuProfiler::end_frame();
+        const auto frame_end = std::chrono::steady_clock::now();
+        m_CurrentTimings.Frame = std::chrono::duration<double, std::milli>(frame_end - frame_start).count();
+        m_Telemetry.record(m_CurrentTimings);
+
+        if (frame_end - last_report >= std::chrono::seconds(1)) {
+            LOG("{}", m_Telemetry.summary());
+            LOG("{}", m_GpuProfiler.summary());
+            if (m_Spec.DynamicResolution && !m_Spec.Headless) {
+                LOG("Render scale {:.2f} ({}x{}), GPU {:.2f} ms", m_RenderScale, m_DrawExtent.width, m_DrawExtent.height, m_Resolution.get_smoothed_ms());
+            }
+
+            LOG("{}", m_World.summary());
+            LOG("{}", m_ChunkRenderer.summary());
+
+            const MemoryManager& memory = m_GpuManager.get_memory();
+            LOG("{}", memory.summary());
+            if (memory.get_budget_pressure() > 0.9f) {
+                LOG_ERROR("Device memory at {:.0f}% of its budget", memory.get_budget_pressure() * 100.0f);
+            }
+
+            if (m_Spec.DefragmentMeshes && !m_MeshManager.is_defragmenting() && memory.get_mesh_fragmentation() > m_Spec.DefragmentThreshold) {
+                m_MeshManager.request_defragmentation();
+            }
+            // Chunk meshes live in the renderer's arenas, not in the mesh pool
+            if (m_Spec.DefragmentMeshes && !m_ChunkRenderer.is_compacting() && m_ChunkRenderer.get_fragmentation() > m_Spec.DefragmentThreshold) {
+                m_ChunkRenderer.request_compaction();
+            }
+            last_report = frame_end;
         }
 
-        m_Running = !glfwWindowShouldClose(m_Window);
+        m_Running = !should_stop(start);
+    }
+
+    // Include the frames still in flight in the measurement
+    m_GpuManager.wait_idle();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double seconds = elapsed.count();
+    fmt::println("Rendered {} frames in {:.3f}s ({:.1f} fps, {:.3f} ms/frame)",
+        m_FrameNumber, seconds,
+        seconds > 0.0 ? m_FrameNumber / seconds : 0.0,
+        m_FrameNumber > 0 ? seconds * 1000.0 / m_FrameNumber : 0.0);
+    fmt::println("{} frames in flight, present mode {}", m_FramesInFlight,
+        m_Spec.Headless ? "none (headless)" : vk::to_string(m_GpuManager.get_present_mode()));
+    fmt::println("Last {} frames: {}", m_Telemetry.sample_count(), m_Telemetry.summary());
+    fmt::println("{}", CpuProfiler::summary());
+    fmt::println("{}", m_GpuProfiler.summary());
+
+    if (!m_Spec.CpuTracePath.empty() && CpuProfiler::export_chrome_trace(m_Spec.CpuTracePath)) {
+        fmt::println("CPU trace written to {}", m_Spec.CpuTracePath.string());
+    }
+
+    if (!m_Spec.GpuTracePath.empty() && m_GpuProfiler.export_chrome_trace(m_Spec.GpuTracePath)) {
+        fmt::println("GPU trace written to {}", m_Spec.GpuTracePath.string());
     }
 
+    fmt::println("Memory: {}", m_GpuManager.get_memory().summary());
+    dump_memory_stats();
+
     LOG("Engine stopped");
     return true;
 }
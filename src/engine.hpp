@@ -1,6 +1,24 @@
 #pragma once
 
+#include "bindless_heap.hpp"
+#include "chunk_renderer.hpp"
+#include "compositor.hpp"
+#include "cpu_profiler.hpp"
+#include "frame_scheduler.hpp"
+#include "frame_telemetry.hpp"
 #include "gpu_manager.hpp"
+#include "gpu_profiler.hpp"
+#include "image_state_tracker.hpp"
+#include "job_system.hpp"
+#include "mesh_manager.hpp"
+#include "pipeline_cache.hpp"
+#include "pipeline_registry.hpp"
+#include "render_graph.hpp"
+#include "resolution_controller.hpp"
+#include "shader_library.hpp"
+#include "texture_array.hpp"
+#include "upload_manager.hpp"
+#include "world_streamer.hpp"
 
 /*
  * TODO
@@ -21,27 +39,104 @@
  * - On each frame grab new swapchain image
  * - Reset Command Buffer
  * - Record new command:
- * -- Setup Allocated Image format for color clearing
- * -- Draw background with clear color
- * -- Setup Allocated Image format for geometry drawing
- * -- Draw geometry
- * -- Setup Allocated Image format for transfer src
- * -- Setup Swapchain Image format for transfer dst
- * -- Copy drawn image to swapchain image
- * -- end recording
+ * -- Chunk culling, a compute pass writing the indirect draws of the visible chunk sections
+ * - Then execute the render graph:
+ * -- Geometry pass, clears the draw image through its loadOp and draws the chunks with one indirect call
+ * -- Blit pass, copies the draw image to the swapchain image
+ * -- The graph orders passes and emits the layout transitions between them
  * - Send command
  * - Present swapchain image
  */
 
+#ifndef SHADER_DIR
+#define SHADER_DIR "../resources/shaders"
+#endif
+
+#ifndef TEXTURE_DIR
+#define TEXTURE_DIR "../resources/textures/blocks"
+#endif
+
 namespace Minecraft::VkEngine {
 
+struct EngineSpec {
+    uint32_t Width { 1280 };
+    uint32_t Height { 720 };
+
+    // Headless renders offscreen into the draw image, no window nor swapchain are created
+    bool Headless { false };
+
+    // Stop conditions, whichever is hit first ends the run. 0 means no limit
+    uint64_t FrameCount { 0 };
+    double Duration { 0.0 }; // seconds
+
+    // Latency vs throughput knobs, FramesInFlight is clamped to [1, Engine::MAX_FRAMES_IN_FLIGHT]
+    uint32_t FramesInFlight { 2 };
+    vk::PresentModeKHR PresentMode { vk::PresentModeKHR::eFifo };
+
+    // The draw image is sized from the window, MaxDrawExtent caps it when not zero.
+    // B10G11R11UfloatPack32 halves the bandwidth of the default RGBA16F at the cost of alpha and precision
+    vk::Format DrawImageFormat { vk::Format::eR16G16B16A16Sfloat };
+    vk::Extent2D MaxDrawExtent {};
+
+    // The composite pass writes the swapchain from a compute shader when the surface allows storage usage,
+    // otherwise it goes through an intermediate image copied to the swapchain
+    bool SwapchainStorage { true };
+    bool Tonemap { true };
+    float Exposure { 1.0f };
+
+    // Loaded on init and written back on shutdown, empty disables it
+    std::filesystem::path PipelineCachePath { "pipeline_cache.bin" };
+
+    std::filesystem::path ShaderDirectory { SHADER_DIR };
+    // Watch compiled shaders and rebuild the pipelines using them when they change
+    bool HotReloadShaders { true };
+
+    // Fetch vertices through their buffer device address instead of the vertex input stage
+    bool VertexPulling { false };
+
+    // Chrome trace (chrome://tracing, Perfetto) of the last GPU frames written on exit, empty disables it
+    std::filesystem::path GpuTracePath {};
+    // Same for the CPU zones of every thread, over budget frames are marked in it
+    std::filesystem::path CpuTracePath {};
+    // Frames slower than this are flagged along with their longest zone
+    double FrameBudgetMs { 1000.0 / 60.0 };
+
+    // Lower the render scale when the GPU frame time goes over TargetGpuMs (0 uses FrameBudgetMs),
+    // the frame is then upscaled to the swapchain. Windowed only, headless renders at full size
+    bool DynamicResolution { true };
+    double TargetGpuMs { 0.0 };
+    float MinRenderScale { 0.5f };
+
+    // VMA's JSON statistics, written on exit and when F9 is pressed, empty disables it
+    std::filesystem::path MemoryStatsPath {};
+    // Compact the mesh pool and the chunk arenas during idle frames once this much of their free space is scattered
+    bool DefragmentMeshes { true };
+    float DefragmentThreshold { 0.3f };
+
+    // Every *.ktx2 in here becomes a layer of the block texture array, in name order.
+    // Files must all be BlockTextureFormat at BlockTextureSize, the ones without mips get them generated
+    std::filesystem::path TextureDirectory { TEXTURE_DIR };
+    uint32_t BlockTextureSize { 16 };
+    vk::Format BlockTextureFormat { vk::Format::eR8G8B8A8Srgb };
+
+    // Workers generating and meshing the world, 0 leaves a core to the main thread
+    uint32_t WorkerThreads { 0 };
+    // In chunks around the camera
+    uint32_t ViewDistance { 8 };
+    // The camera flies along +X at this many blocks per second, to exercise streaming
+    float CameraSpeed { 0.0f };
+    // Vertical, in degrees
+    float FieldOfView { 70.0f };
+};
+
 struct FrameData {
     vk::CommandPool CommandPool { nullptr };
     vk::CommandBuffer CommandBuffer { nullptr };
 
+    // Binary semaphores are only needed to talk to the presentation engine,
+    // CPU/GPU frame pacing goes through the FrameScheduler timeline
     vk::Semaphore SwapChainSemaphore { nullptr };
     vk::Semaphore RenderSemaphore { nullptr };
-    vk::Fence RenderFence { nullptr };
 };
 
 //const std::vector<Vertex> vertices = {
@@ -52,15 +147,19 @@ struct FrameData {
 
 class Engine {
 public:
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
     ~Engine();
 
-    [[nodiscard]] bool init(uint32_t width, uint32_t height);
+    [[nodiscard]] bool init(const EngineSpec& spec);
     [[nodiscard]] bool run();
     bool ResizeRequested = false;
+    bool MemoryStatsRequested = false;
 
 private:
     bool m_IsInitialized = false;
     bool m_Running = false;
+    EngineSpec m_Spec {};
 
     DeletionQueue m_MainDeletionQueue;
 
@@ -68,32 +167,101 @@ private:
     GpuManager m_GpuManager {};
     vk::Device m_Device { nullptr };
     DrawImageBundle m_DrawImageBundle {};
+    ImageStateTracker m_ImageStates {};
+
+    // Render graph
+    RenderGraph m_RenderGraph {};
+    RenderGraphImage m_GraphDrawImage {};
+    RenderGraphImage m_GraphDepthImage {};
+    RenderGraphImage m_GraphSwapchainImage {};
+    // Images of the swapchain generation last tracked, forgotten once it is recreated
+    uint64_t m_SwapchainGeneration { 0 };
+    std::vector<vk::Image> m_SwapchainImages;
+    // Only used when the swapchain has no storage usage
+    RenderGraphImage m_GraphCompositeImage {};
+    vk::Image m_CompositeImage { nullptr };
+
+    // Tonemaps and upscales the draw image into the swapchain
+    Compositor m_Compositor {};
+    PipelineHandle m_CompositePipeline {};
 
     // Resizing
     vk::Extent2D m_DrawExtent {};
     float m_RenderScale = 1.0f;
+    ResolutionController m_Resolution {};
 
     // Pipelines
-    PipelineBundle m_TrianglePipeline {};
+    PipelineCache m_PipelineCache {};
+    ShaderLibrary m_ShaderLibrary {};
+    std::chrono::steady_clock::time_point m_LastShaderPoll {};
+    static constexpr std::chrono::milliseconds SHADER_POLL_INTERVAL { 500 };
+    PipelineRegistry m_PipelineRegistry {};
+    PipelineHandle m_TrianglePipeline {};
+    PipelineHandle m_PulledTrianglePipeline {};
+    PipelineHandle m_ChunkPipeline {};
+    PipelineHandle m_ChunkCullPipeline {};
+
+    // Descriptors, every pipeline uses the heap's layout
+    BindlessHeap m_BindlessHeap {};
+
+    // Uploads and geometry
+    UploadManager m_UploadManager {};
+    MeshManager m_MeshManager {};
+    MeshHandle m_TriangleMesh {};
+    TextureArray m_BlockTextures {};
+
+    // World streaming
+    JobSystem m_Jobs {};
+    WorldStreamer m_World {};
+    ChunkRenderer m_ChunkRenderer {};
+    glm::vec3 m_CameraPosition { 0.0f, 80.0f, 0.0f };
+    // Of the frame being recorded, shared by the cull and the draw
+    glm::mat4 m_ViewProjection { 1.0f };
 
     // Frame stuff
-    int m_FrameNumber { 0 };
-    static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+    FrameScheduler m_FrameScheduler {};
+    uint64_t m_FrameNumber { 0 };
+    uint32_t m_FramesInFlight { 2 };
     std::array<FrameData, MAX_FRAMES_IN_FLIGHT> m_Frames;
-    FrameData& get_current_frame() { return m_Frames[m_FrameNumber % MAX_FRAMES_IN_FLIGHT]; }
+    [[nodiscard]] uint32_t get_current_frame_slot() const { return static_cast<uint32_t>(m_FrameNumber % m_FramesInFlight); }
+    FrameData& get_current_frame() { return m_Frames[get_current_frame_slot()]; }
+
+    // Telemetry
+    GpuProfiler m_GpuProfiler {};
+    FrameTelemetry m_Telemetry {};
+    FrameTimings m_CurrentTimings {};
 
     [[nodiscard]] bool init_window(uint32_t width, uint32_t height);
     void init_vulkan();
+    [[nodiscard]] bool init_descriptors();
+    [[nodiscard]] bool init_pipeline_cache();
     bool init_pipelines();
     bool init_triangle_pipeline();
+    bool init_chunk_pipelines();
+    bool init_composite_pipeline();
+    void update_pipelines();
     [[nodiscard]] bool init_commands();
+    // swapchain_image is null when headless, the frame then ends in the draw image
     [[nodiscard]] bool record_command_buffer(vk::CommandBuffer cmd, vk::Image swapchain_image, vk::Extent2D swapchain_extent);
     [[nodiscard]] bool create_sync_objects();
+    [[nodiscard]] bool init_uploads();
+    [[nodiscard]] bool init_meshes();
+    [[nodiscard]] bool init_textures();
+    [[nodiscard]] bool init_world();
+    [[nodiscard]] bool init_render_graph();
+    [[nodiscard]] bool init_profilers();
 
+    [[nodiscard]] bool wait_for_frame_slot();
+    [[nodiscard]] bool flush_uploads();
     [[nodiscard]] bool draw_frame();
+    [[nodiscard]] bool draw_frame_headless();
+    [[nodiscard]] bool should_stop(std::chrono::steady_clock::time_point start) const;
+    // Spare CPU and GPU work time, not counting vsync waits, and nothing streaming: background GPU work can run
+    [[nodiscard]] bool is_idle_frame() const;
+    void dump_memory_stats();
 
-    void draw_background(vk::CommandBuffer cmd) const;
-    void draw_geometry(vk::CommandBuffer cmd) const;
+    [[nodiscard]] glm::mat4 get_view_projection() const;
+    void draw_geometry(vk::CommandBuffer cmd, const vk::RenderingAttachmentInfo& color_attachment, const vk::RenderingAttachmentInfo& depth_attachment) const;
 };
 
 }
@@ -0,0 +1,72 @@
+#include "frame_scheduler.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+void FrameScheduler::init(const vk::Device device, const vk::Semaphore timeline)
+{
+    m_Device = device;
+    m_Timeline = timeline;
+    m_SubmittedValue = 0;
+    m_CompletedValue = 0;
+}
+
+vk::SemaphoreSubmitInfo FrameScheduler::signal_info(const uint64_t frame, const vk::PipelineStageFlags2 stage) const
+{
+    return vk::SemaphoreSubmitInfo {
+        m_Timeline, value_of(frame), stage
+    };
+}
+
+void FrameScheduler::refresh()
+{
+    const auto [res, value] = m_Device.getSemaphoreCounterValue(m_Timeline);
+    if (res != vk::Result::eSuccess) {
+        LOG_ERROR("Failed to query frame timeline: {}", vk::to_string(res));
+        return;
+    }
+
+    m_CompletedValue = std::max(m_CompletedValue, value);
+}
+
+bool FrameScheduler::is_frame_complete(const uint64_t frame)
+{
+    if (m_CompletedValue >= value_of(frame)) {
+        return true;
+    }
+
+    refresh();
+    return m_CompletedValue >= value_of(frame);
+}
+
+vk::Result FrameScheduler::wait_for_frame(const uint64_t frame, const uint64_t timeout)
+{
+    const uint64_t value = value_of(frame);
+    if (m_CompletedValue >= value) {
+        return vk::Result::eSuccess;
+    }
+
+    const vk::SemaphoreWaitInfo wait_info {
+        {},
+        1, &m_Timeline,
+        &value
+    };
+
+    const vk::Result res = m_Device.waitSemaphores(wait_info, timeout);
+    if (res == vk::Result::eSuccess) {
+        m_CompletedValue = std::max(m_CompletedValue, value);
+    }
+
+    return res;
+}
+
+vk::Result FrameScheduler::wait_idle(const uint64_t timeout)
+{
+    if (m_SubmittedValue == 0) {
+        return vk::Result::eSuccess;
+    }
+
+    return wait_for_frame(m_SubmittedValue - 1, timeout);
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+/*
+ * Single source of truth for GPU progress.
+ * Every submitted frame signals one timeline semaphore with value frame + 1, so asking
+ * whether frame N is done is a counter comparison instead of a fence round-trip.
+ */
+class FrameScheduler {
+public:
+    void init(vk::Device device, vk::Semaphore timeline);
+
+    [[nodiscard]] vk::Semaphore get_semaphore() const { return m_Timeline; }
+
+    // Signal operation to append to the submission of the given frame
+    [[nodiscard]] vk::SemaphoreSubmitInfo signal_info(uint64_t frame, vk::PipelineStageFlags2 stage) const;
+
+    // Returns eTimeout if the frame did not complete within timeout nanoseconds
+    [[nodiscard]] vk::Result wait_for_frame(uint64_t frame, uint64_t timeout);
+    [[nodiscard]] vk::Result wait_idle(uint64_t timeout);
+
+    // Only queries the semaphore when the cached value is not enough to answer
+    [[nodiscard]] bool is_frame_complete(uint64_t frame);
+
+    // Number of frames the GPU has fully executed
+    [[nodiscard]] uint64_t completed_frames() const { return m_CompletedValue; }
+    [[nodiscard]] uint64_t submitted_frames() const { return m_SubmittedValue; }
+
+    void mark_submitted(uint64_t frame) { m_SubmittedValue = std::max(m_SubmittedValue, value_of(frame)); }
+
+private:
+    vk::Device m_Device { nullptr };
+    vk::Semaphore m_Timeline { nullptr };
+
+    uint64_t m_SubmittedValue { 0 };
+    uint64_t m_CompletedValue { 0 };
+
+    static uint64_t value_of(const uint64_t frame) { return frame + 1; }
+    void refresh();
+};
+
+}
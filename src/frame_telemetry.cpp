@@ -0,0 +1,64 @@
+#include "frame_telemetry.hpp"
+
+namespace Minecraft::VkEngine {
+
+void FrameTelemetry::record(const FrameTimings& timings)
+{
+    m_Samples[m_Next] = timings;
+    m_Next = (m_Next + 1) % WINDOW_SIZE;
+    m_Count = std::min(m_Count + 1, WINDOW_SIZE);
+}
+
+void FrameTelemetry::reset()
+{
+    m_Next = 0;
+    m_Count = 0;
+}
+
+FrameTimings FrameTelemetry::average() const
+{
+    FrameTimings avg {};
+    if (m_Count == 0) {
+        return avg;
+    }
+
+    for (size_t i = 0; i < m_Count; i++) {
+        avg.FrameWait += m_Samples[i].FrameWait;
+        avg.Acquire += m_Samples[i].Acquire;
+        avg.Present += m_Samples[i].Present;
+        avg.Frame += m_Samples[i].Frame;
+    }
+
+    const double count = static_cast<double>(m_Count);
+    avg.FrameWait /= count;
+    avg.Acquire /= count;
+    avg.Present /= count;
+    avg.Frame /= count;
+    return avg;
+}
+
+FrameTimings FrameTelemetry::max() const
+{
+    FrameTimings worst {};
+    for (size_t i = 0; i < m_Count; i++) {
+        worst.FrameWait = std::max(worst.FrameWait, m_Samples[i].FrameWait);
+        worst.Acquire = std::max(worst.Acquire, m_Samples[i].Acquire);
+        worst.Present = std::max(worst.Present, m_Samples[i].Present);
+        worst.Frame = std::max(worst.Frame, m_Samples[i].Frame);
+    }
+    return worst;
+}
+
+std::string FrameTelemetry::summary() const
+{
+    const FrameTimings avg = average();
+    const FrameTimings worst = max();
+
+    return fmt::format("frame {:.3f}ms (max {:.3f}) | wait {:.3f}ms (max {:.3f}) | acquire {:.3f}ms (max {:.3f}) | present {:.3f}ms (max {:.3f})",
+        avg.Frame, worst.Frame,
+        avg.FrameWait, worst.FrameWait,
+        avg.Acquire, worst.Acquire,
+        avg.Present, worst.Present);
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+// Host side durations of one frame, in milliseconds
+struct FrameTimings {
+    double FrameWait { 0.0 };
+    double Acquire { 0.0 };
+    double Present { 0.0 };
+    double Frame { 0.0 };
+};
+
+/*
+ * Keeps a rolling window of FrameTimings to expose averages and worst cases,
+ * enough to compare present modes and frames in flight settings against each other.
+ */
+class FrameTelemetry {
+public:
+    static constexpr size_t WINDOW_SIZE = 240;
+
+    void record(const FrameTimings& timings);
+    void reset();
+
+    [[nodiscard]] FrameTimings average() const;
+    [[nodiscard]] FrameTimings max() const;
+    [[nodiscard]] size_t sample_count() const { return m_Count; }
+
+    // One line summary of the current window
+    [[nodiscard]] std::string summary() const;
+
+private:
+    std::array<FrameTimings, WINDOW_SIZE> m_Samples {};
+    size_t m_Next { 0 };
+    size_t m_Count { 0 };
+};
+
+// Small helper to time a scope in milliseconds
+class ScopedTimer {
+public:
+    explicit ScopedTimer(double& out)
+        : m_Out(out)
+        , m_Start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_Start;
+        m_Out = elapsed.count();
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    double& m_Out;
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+}
@@ -40,16 +40,27 @@ void GpuManager::wait_idle() const
 ResourcesBundle GpuManager::init(const GpuManagerSpec& spec)
 {
     assert(!m_Initialized);
-
-    glfwGetFramebufferSize(spec.Window,
-        reinterpret_cast<int32_t*>(&m_WindowExtent.width),
-        reinterpret_cast<int32_t*>(&m_WindowExtent.height));
+    m_Headless = spec.Headless;
+    m_RequestedPresentMode = spec.PresentMode;
+    m_MinImageCount = spec.MinImageCount;
+    m_RequestedSwapchainStorage = spec.SwapchainStorage;
+    m_MaxDrawExtent = spec.MaxDrawExtent;
+    m_DrawImage.Format = spec.DrawImageFormat;
+
+    if (m_Headless) {
+        m_WindowExtent = spec.HeadlessExtent;
+    } else {
+        glfwGetFramebufferSize(spec.Window,
+            reinterpret_cast<int32_t*>(&m_WindowExtent.width),
+            reinterpret_cast<int32_t*>(&m_WindowExtent.height));
+    }
 
 #pragma region InstanceCreation
 
     vkb::InstanceBuilder builder;
     builder
         .set_app_name(spec.AppName)
+        .set_headless(m_Headless)
         .require_api_version(1, 3, 0);
 
     if (spec.EnableValidation) {
@@ -79,17 +90,26 @@ ResourcesBundle GpuManager::init(const GpuManagerSpec& spec)
 
 #pragma region SurfaceSetup
 
-    VkSurfaceKHR c_surface;
-    glfwCreateWindowSurface(m_Instance, spec.Window, nullptr, &c_surface);
-    m_Surface = c_surface;
-    m_DeletionQueue.push_function("Surface", [&] {
-        m_Instance.destroySurfaceKHR(m_Surface);
-    });
+    if (!m_Headless) {
+        VkSurfaceKHR c_surface;
+        glfwCreateWindowSurface(m_Instance, spec.Window, nullptr, &c_surface);
+        m_Surface = c_surface;
+        m_DeletionQueue.push_function("Surface", [&] {
+            m_Instance.destroySurfaceKHR(m_Surface);
+        });
+    }
 
 #pragma endregion
 
 #pragma region DeviceSetup
 
+    vk::PhysicalDeviceFeatures features;
+    // The bindless storage images have no GLSL format qualifier, the swapchain and the compositor output are 8 bit
+    features.shaderStorageImageWriteWithoutFormat = true;
+    // GPU driven chunk draws, the section record index travels in firstInstance
+    features.multiDrawIndirect = true;
+    features.drawIndirectFirstInstance = true;
+
     vk::PhysicalDeviceVulkan13Features features13;
     features13.dynamicRendering = true;
     features13.synchronization2 = true;
@@ -97,16 +117,36 @@ ResourcesBundle GpuManager::init(const GpuManagerSpec& spec)
     vk::PhysicalDeviceVulkan12Features features12;
     features12.bufferDeviceAddress = true;
     features12.descriptorIndexing = true;
+    features12.timelineSemaphore = true;
+    features12.drawIndirectCount = true;
+    // Bindless heap
+    features12.runtimeDescriptorArray = true;
+    features12.descriptorBindingPartiallyBound = true;
+    features12.descriptorBindingUpdateUnusedWhilePending = true;
+    features12.descriptorBindingSampledImageUpdateAfterBind = true;
+    features12.descriptorBindingStorageImageUpdateAfterBind = true;
+    features12.descriptorBindingStorageBufferUpdateAfterBind = true;
+    features12.shaderSampledImageArrayNonUniformIndexing = true;
+    features12.shaderStorageBufferArrayNonUniformIndexing = true;
 
     vkb::PhysicalDeviceSelector selector { vkb_instance };
     selector
-        .set_surface(m_Surface)
         .set_minimum_version(1, 3)
-        .require_present()
+        .set_required_features(features)
         .set_required_features_13(features13)
         .set_required_features_12(features12);
 
-    const vkb::PhysicalDevice vkb_physical_device = selector.select().value();
+    if (m_Headless) {
+        selector.require_present(false);
+    } else {
+        selector
+            .set_surface(m_Surface)
+            .require_present();
+    }
+
+    vkb::PhysicalDevice vkb_physical_device = selector.select().value();
+    // Lets VMA report the real per heap budget, including what other processes use
+    const bool memory_budget = vkb_physical_device.enable_extension_if_present(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
     const vkb::DeviceBuilder device_builder { vkb_physical_device };
 
     const vkb::Device vkb_device = device_builder.build().value();
@@ -128,6 +168,9 @@ ResourcesBundle GpuManager::init(const GpuManagerSpec& spec)
 
     VmaAllocatorCreateInfo allocator_create_info = {};
     allocator_create_info.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    if (memory_budget) {
+        allocator_create_info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
     allocator_create_info.vulkanApiVersion = VK_API_VERSION_1_3;
     allocator_create_info.physicalDevice = m_PhysicalDevice;
     allocator_create_info.device = m_Device;
@@ -139,6 +182,18 @@ ResourcesBundle GpuManager::init(const GpuManagerSpec& spec)
         vmaDestroyAllocator(m_Allocator);
     });
 
+    if (const vk::Result res = m_Memory.init(m_Allocator, memory_budget); res != vk::Result::eSuccess) {
+        LOG_ERROR("Failed to create the mesh memory pool: {}", vk::to_string(res));
+    }
+    m_DeletionQueue.push_function("Memory", [&] {
+        m_Memory.destroy();
+    });
+
+    m_Deleter.init(m_Device, m_Allocator);
+    m_DeletionQueue.push_function("Deferred Deleter", [&] {
+        m_Deleter.destroy();
+    });
+
 #pragma endregion
 
     init_swapchain();
@@ -150,16 +205,21 @@ ResourcesBundle GpuManager::init(const GpuManagerSpec& spec)
         vkb_device.get_queue_index(vkb::QueueType::graphics).value()
     };
 
-    const DrawImageBundle image_bundle = {
-        .Image = m_DrawImage.Image,
-        .ImageView = m_DrawImage.ImageView,
-        .Extent = m_DrawImage.Extent,
-        .Format = m_DrawImage.Format
-    };
+    // A transfer only family maps to the copy engines, uploads then overlap with rendering
+    const auto transfer_queue = vkb_device.get_dedicated_queue(vkb::QueueType::transfer);
+    if (transfer_queue.has_value()) {
+        m_TransferQueue = {
+            transfer_queue.value(),
+            vkb_device.get_dedicated_queue_index(vkb::QueueType::transfer).value()
+        };
+    } else {
+        m_TransferQueue = m_GraphicsQueue;
+    }
+    LOG("Transfer queue family {}{}", m_TransferQueue.FamilyIndex, has_dedicated_transfer_queue() ? " (dedicated)" : " (shared with graphics)");
 
     return ResourcesBundle {
         m_Device,
-        image_bundle
+        get_draw_image()
     };
 }
 
@@ -170,8 +230,15 @@ vk::Result GpuManager::submit_to_queue(const vk::SubmitInfo2& submit_info2, cons
     return m_GraphicsQueue.Queue.submit2(1, &submit_info2, render_fence);
 }
 
+vk::Result GpuManager::submit_to_transfer_queue(const vk::SubmitInfo2& submit_info2) const
+{
+    return m_TransferQueue.Queue.submit2(1, &submit_info2, nullptr);
+}
+
 vk::Result GpuManager::present(const uint32_t semaphores_count, vk::Semaphore* semaphores)
 {
+    assert(!m_Headless);
+
     const vk::PresentInfoKHR present_info {
         semaphores_count,
         semaphores,
@@ -193,9 +260,9 @@ vk::Result GpuManager::present(const uint32_t semaphores_count, vk::Semaphore* s
 
 #pragma region SyncStructs
 
-std::expected<vk::CommandPool, vk::Result> GpuManager::create_command_pool(const vk::CommandPoolCreateFlags flags)
+std::expected<vk::CommandPool, vk::Result> GpuManager::create_command_pool(const vk::CommandPoolCreateFlags flags, const std::optional<uint32_t> queue_family)
 {
-    const vk::CommandPoolCreateInfo info { flags, m_GraphicsQueue.FamilyIndex };
+    const vk::CommandPoolCreateInfo info { flags, queue_family.value_or(m_GraphicsQueue.FamilyIndex) };
     const auto [res, pool] = m_Device.createCommandPool(info);
 
     if (res != vk::Result::eSuccess) {
@@ -231,6 +298,20 @@ std::expected<vk::Semaphore, vk::Result> GpuManager::create_semaphore(const vk::
     return semaphore;
 }
 
+std::expected<vk::Semaphore, vk::Result> GpuManager::create_timeline_semaphore(const uint64_t initial_value)
+{
+    const vk::SemaphoreTypeCreateInfo type_info { vk::SemaphoreType::eTimeline, initial_value };
+    const vk::SemaphoreCreateInfo info { {}, &type_info };
+    const auto [res, semaphore] = m_Device.createSemaphore(info);
+
+    if (res != vk::Result::eSuccess) {
+        return std::unexpected(res);
+    }
+
+    m_Semaphores.push_back(semaphore);
+    return semaphore;
+}
+
 std::expected<vk::Fence, vk::Result> GpuManager::create_fence(const vk::FenceCreateFlags flags)
 {
     const vk::FenceCreateInfo info { flags };
@@ -264,7 +345,11 @@ void GpuManager::request_resize(const uint32_t width, const uint32_t height)
     m_WindowExtent.width = width;
     m_WindowExtent.height = height;
 
-    resize_swapchain();
+    if (!m_Headless) {
+        resize_swapchain();
+    } else {
+        resize_draw_image();
+    }
 }
 
 void GpuManager::resize_swapchain()
@@ -273,10 +358,13 @@ void GpuManager::resize_swapchain()
     destroy_swapchain();
 
     create_swapchain();
+    resize_draw_image();
 }
 
 std::expected<vk::Image, vk::Result> GpuManager::get_next_swapchain_image(const vk::Semaphore swapchain_semaphore, const uint64_t timeout)
 {
+    assert(!m_Headless);
+
     const vk::Result res = m_Device.acquireNextImageKHR(m_SwapchainBundle.Handle, timeout, swapchain_semaphore,
         VK_NULL_HANDLE, &m_CurrentSwapchainImageIndex);
 
@@ -293,6 +381,10 @@ std::expected<vk::Image, vk::Result> GpuManager::get_next_swapchain_image(const
 
 void GpuManager::destroy_swapchain()
 {
+    if (m_Headless) {
+        return;
+    }
+
     m_Device.destroySwapchainKHR(m_SwapchainBundle.Handle);
 
     for (const auto& image_view : m_SwapchainBundle.ImageViews) {
@@ -300,21 +392,65 @@ void GpuManager::destroy_swapchain()
     }
 }
 
+bool GpuManager::supports_swapchain_storage() const
+{
+    const auto [caps_res, capabilities] = m_PhysicalDevice.getSurfaceCapabilitiesKHR(m_Surface);
+    if (caps_res != vk::Result::eSuccess || !(capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eStorage)) {
+        return false;
+    }
+
+    const auto [formats_res, formats] = m_PhysicalDevice.getSurfaceFormatsKHR(m_Surface);
+    const bool has_format = formats_res == vk::Result::eSuccess && std::ranges::any_of(formats, [](const vk::SurfaceFormatKHR& f) {
+        return f.format == vk::Format::eB8G8R8A8Unorm && f.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear;
+    });
+
+    return has_format && (m_PhysicalDevice.getFormatProperties(vk::Format::eB8G8R8A8Unorm).optimalTilingFeatures & vk::FormatFeatureFlagBits::eStorageImage);
+}
+
+vk::PresentModeKHR GpuManager::select_present_mode(const vk::PresentModeKHR requested) const
+{
+    // FIFO is the only mode the spec guarantees
+    if (requested == vk::PresentModeKHR::eFifo) {
+        return requested;
+    }
+
+    const auto [res, supported_modes] = m_PhysicalDevice.getSurfacePresentModesKHR(m_Surface);
+    if (res == vk::Result::eSuccess && std::ranges::find(supported_modes, requested) != supported_modes.end()) {
+        return requested;
+    }
+
+    LOG_ERROR("Present mode {} not supported, falling back to {}", vk::to_string(requested), vk::to_string(vk::PresentModeKHR::eFifo));
+    return vk::PresentModeKHR::eFifo;
+}
+
 void GpuManager::create_swapchain()
 {
     vkb::SwapchainBuilder builder(m_PhysicalDevice, m_Device, m_Surface);
 
-    m_SwapchainBundle.ImageFormat = vk::Format::eB8G8R8A8Srgb; // UNORM for non srgb images such as noise maps and normal maps
+    m_PresentMode = select_present_mode(m_RequestedPresentMode);
+
+    // sRGB formats are never storage capable, storage swapchains are UNORM with the same color space
+    const bool storage = m_RequestedSwapchainStorage && supports_swapchain_storage();
+    const vk::Format format = storage ? vk::Format::eB8G8R8A8Unorm : vk::Format::eB8G8R8A8Srgb;
+
+    vk::ImageUsageFlags usage { vk::ImageUsageFlagBits::eTransferDst };
+    if (storage) {
+        usage |= vk::ImageUsageFlagBits::eStorage;
+    }
 
     builder
-        .set_desired_format(vk::SurfaceFormatKHR { m_SwapchainBundle.ImageFormat, vk::ColorSpaceKHR::eSrgbNonlinear })
-        .set_desired_present_mode(static_cast<VkPresentModeKHR>(vk::PresentModeKHR::eFifo))
+        .set_desired_format(vk::SurfaceFormatKHR { format, vk::ColorSpaceKHR::eSrgbNonlinear })
+        .set_desired_present_mode(static_cast<VkPresentModeKHR>(m_PresentMode))
+        .set_desired_min_image_count(m_MinImageCount)
         .set_desired_extent(m_WindowExtent.width, m_WindowExtent.height)
-        .add_image_usage_flags(static_cast<VkImageUsageFlags>(vk::ImageUsageFlagBits::eTransferDst))
+        .add_image_usage_flags(static_cast<VkImageUsageFlags>(usage))
         .set_composite_alpha_flags(static_cast<VkCompositeAlphaFlagBitsKHR>(vk::CompositeAlphaFlagBitsKHR::eOpaque));
 
     vkb::Swapchain vkb_swapchain = builder.build().value();
 
+    m_SwapchainBundle.ImageFormat = static_cast<vk::Format>(vkb_swapchain.image_format);
+    m_SwapchainBundle.Storage = storage;
+    m_SwapchainBundle.Generation++;
     m_SwapchainBundle.Handle = vkb_swapchain.swapchain;
     m_SwapchainBundle.Images = vkb_swapchain.get_images().value();
     m_SwapchainBundle.ImageViews = vkb_swapchain.get_image_views().value();
@@ -323,43 +459,161 @@ void GpuManager::create_swapchain()
 
 void GpuManager::init_swapchain()
 {
-    create_swapchain();
-    constexpr vk::Extent3D draw_image_extent { // TODO get maximum system supported resolution
-        7680,
-        4320,
-        1
+    if (!m_Headless) {
+        create_swapchain();
+    }
+
+    select_draw_image_format(m_DrawImage.Format);
+    if (const vk::Result res = create_draw_image(get_desired_draw_extent()); res != vk::Result::eSuccess) {
+        LOG_ERROR("Failed to allocate the draw image: {}", vk::to_string(res));
+    }
+
+    m_DeletionQueue.push_function("swapchain init", [&] {
+        destroy_image(m_DepthImage);
+        destroy_image(m_DrawImage);
+    });
+}
+
+#pragma endregion
+
+#pragma region DrawImage
+
+void GpuManager::select_draw_image_format(const vk::Format requested)
+{
+    constexpr vk::FormatFeatureFlags required_features {
+        vk::FormatFeatureFlagBits::eColorAttachment | vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eTransferSrc
+        // Sampled with linear filtering by the composite pass, which also upscales the scaled render
+        | vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eSampledImageFilterLinear
     };
 
-    m_DrawImage.Format = vk::Format::eR16G16B16A16Sfloat;
-    m_DrawImage.Extent = draw_image_extent;
+    vk::Format format = requested;
+    vk::FormatFeatureFlags features = m_PhysicalDevice.getFormatProperties(format).optimalTilingFeatures;
+    if ((features & required_features) != required_features) {
+        LOG_ERROR("Draw image format {} not supported, falling back to {}", vk::to_string(format), vk::to_string(vk::Format::eR16G16B16A16Sfloat));
+        format = vk::Format::eR16G16B16A16Sfloat;
+        features = m_PhysicalDevice.getFormatProperties(format).optimalTilingFeatures;
+    }
+
+    m_DrawImage.Format = format;
 
-    vk::ImageUsageFlags draw_image_usage {};
-    draw_image_usage |= vk::ImageUsageFlagBits::eTransferSrc;
-    draw_image_usage |= vk::ImageUsageFlagBits::eTransferDst;
-    draw_image_usage |= vk::ImageUsageFlagBits::eStorage;
-    draw_image_usage |= vk::ImageUsageFlagBits::eColorAttachment;
+    m_DrawImageUsage = {};
+    m_DrawImageUsage |= vk::ImageUsageFlagBits::eTransferSrc;
+    m_DrawImageUsage |= vk::ImageUsageFlagBits::eTransferDst;
+    m_DrawImageUsage |= vk::ImageUsageFlagBits::eColorAttachment;
+    m_DrawImageUsage |= vk::ImageUsageFlagBits::eSampled;
 
-    // Image Allocation
-    vk::ImageCreateInfo rimg_info = VkInit::image_create_info(m_DrawImage.Format, draw_image_usage, draw_image_extent);
-    VmaAllocationCreateInfo rimg_alloc_info = {};
-    rimg_alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-    rimg_alloc_info.requiredFlags = static_cast<VkMemoryPropertyFlags>(vk::MemoryPropertyFlagBits::eDeviceLocal);
+    // Packed float formats are only storage capable with shaderStorageImageExtendedFormats
+    if (features & vk::FormatFeatureFlagBits::eStorageImage) {
+        m_DrawImageUsage |= vk::ImageUsageFlagBits::eStorage;
+    }
+}
+
+vk::Extent3D GpuManager::get_desired_draw_extent() const
+{
+    vk::Extent2D extent = get_swapchain_extent();
+    if (m_MaxDrawExtent.width > 0 && m_MaxDrawExtent.height > 0) {
+        extent.width = std::min(extent.width, m_MaxDrawExtent.width);
+        extent.height = std::min(extent.height, m_MaxDrawExtent.height);
+    }
+
+    // A minimized window reports 0x0
+    return vk::Extent3D { std::max(extent.width, 1u), std::max(extent.height, 1u), 1 };
+}
+
+std::expected<AllocatedImage, vk::Result> GpuManager::allocate_image(const vk::Format format, const vk::ImageUsageFlags usage, const vk::ImageAspectFlags aspect,
+    const vk::Extent3D extent)
+{
+    AllocatedImage image {};
+    image.Format = format;
+    image.Extent = extent;
+
+    const vk::ImageCreateInfo image_info = VkInit::image_create_info(format, usage, extent);
+    VmaAllocationCreateInfo alloc_info = {};
+    alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    alloc_info.requiredFlags = static_cast<VkMemoryPropertyFlags>(vk::MemoryPropertyFlagBits::eDeviceLocal);
 
     VkImage image_c;
-    vmaCreateImage(m_Allocator, reinterpret_cast<VkImageCreateInfo*>(&rimg_info), &rimg_alloc_info,
-        &image_c, &m_DrawImage.Allocation, nullptr);
-    m_DrawImage.Image = image_c;
+    const VkResult alloc_res = vmaCreateImage(m_Allocator, reinterpret_cast<const VkImageCreateInfo*>(&image_info), &alloc_info,
+        &image_c, &image.Allocation, nullptr);
+    if (alloc_res != VK_SUCCESS) {
+        return std::unexpected(static_cast<vk::Result>(alloc_res));
+    }
+    image.Image = image_c;
 
-    // ImageView Allocation
-    const vk::ImageViewCreateInfo rview_info = VkInit::imageview_create_info(m_DrawImage.Format, m_DrawImage.Image, vk::ImageAspectFlagBits::eColor);
-    if (const vk::Result res = m_Device.createImageView(&rview_info, nullptr, &m_DrawImage.ImageView); res != vk::Result::eSuccess) {
-        LOG_ERROR("Failed to allocate Image View");
+    const vk::ImageViewCreateInfo view_info = VkInit::imageview_create_info(format, image.Image, aspect);
+    if (const vk::Result res = m_Device.createImageView(&view_info, nullptr, &image.ImageView); res != vk::Result::eSuccess) {
+        vmaDestroyImage(m_Allocator, image.Image, image.Allocation);
+        return std::unexpected(res);
     }
 
-    m_DeletionQueue.push_function("swapchain init", [&] {
-        m_Device.destroyImageView(m_DrawImage.ImageView);
-        vmaDestroyImage(m_Allocator, m_DrawImage.Image, m_DrawImage.Allocation);
-    });
+    m_Memory.track(MemoryCategory::eDrawTargets, image.Allocation);
+    return image;
+}
+
+vk::Result GpuManager::create_draw_image(const vk::Extent3D extent)
+{
+    const auto draw_image = allocate_image(m_DrawImage.Format, m_DrawImageUsage, vk::ImageAspectFlagBits::eColor, extent);
+    if (!draw_image.has_value()) {
+        return draw_image.error();
+    }
+
+    const auto depth_image = allocate_image(DEPTH_FORMAT, vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::ImageAspectFlagBits::eDepth, extent);
+    if (!depth_image.has_value()) {
+        destroy_image(draw_image.value());
+        return depth_image.error();
+    }
+
+    m_DrawImage = draw_image.value();
+    m_DepthImage = depth_image.value();
+    LOG("Draw image {}x{} {}, depth {}", extent.width, extent.height, vk::to_string(m_DrawImage.Format), vk::to_string(m_DepthImage.Format));
+    return vk::Result::eSuccess;
+}
+
+void GpuManager::destroy_image(const AllocatedImage& image)
+{
+    if (image.ImageView) {
+        m_Device.destroyImageView(image.ImageView);
+    }
+
+    if (image.Image) {
+        m_Memory.untrack(MemoryCategory::eDrawTargets, image.Allocation);
+        vmaDestroyImage(m_Allocator, image.Image, image.Allocation);
+    }
+}
+
+void GpuManager::resize_draw_image()
+{
+    const vk::Extent3D extent = get_desired_draw_extent();
+    if (extent == m_DrawImage.Extent) {
+        return;
+    }
+
+    // Frames in flight may still render into the old ones
+    const AllocatedImage previous = m_DrawImage;
+    const AllocatedImage previous_depth = m_DepthImage;
+    if (const vk::Result res = create_draw_image(extent); res != vk::Result::eSuccess) {
+        LOG_ERROR("Failed to reallocate the draw image: {}, keeping the previous one", vk::to_string(res));
+        return;
+    }
+
+    for (const AllocatedImage& image : { previous, previous_depth }) {
+        m_Memory.untrack(MemoryCategory::eDrawTargets, image.Allocation);
+        m_Deleter.push(image.ImageView);
+        m_Deleter.push(image.Image, image.Allocation);
+    }
+}
+
+DrawImageBundle GpuManager::get_draw_image() const
+{
+    return DrawImageBundle {
+        .Image = m_DrawImage.Image,
+        .ImageView = m_DrawImage.ImageView,
+        .Extent = m_DrawImage.Extent,
+        .Format = m_DrawImage.Format,
+        .DepthImage = m_DepthImage.Image,
+        .DepthImageView = m_DepthImage.ImageView,
+        .DepthFormat = m_DepthImage.Format
+    };
 }
 
 #pragma endregion
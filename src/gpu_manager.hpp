@@ -1,4 +1,6 @@
 #pragma once
+#include "deferred_deleter.hpp"
+#include "memory_manager.hpp"
 #include "types.hpp"
 
 namespace Minecraft::VkEngine {
@@ -10,20 +12,43 @@ public:
     void destroy();
     void wait_idle() const;
     void request_resize(uint32_t width, uint32_t height);
+    [[nodiscard]] bool is_headless() const { return m_Headless; }
+    [[nodiscard]] vk::Device get_device() const { return m_Device; }
+    [[nodiscard]] VmaAllocator get_allocator() const { return m_Allocator; }
+    [[nodiscard]] vk::PhysicalDevice get_physical_device() const { return m_PhysicalDevice; }
+    [[nodiscard]] MemoryManager& get_memory() { return m_Memory; }
+    // For handles freed while frames are in flight, the owner calls begin_frame once per frame
+    [[nodiscard]] DeferredDeleter& get_deleter() { return m_Deleter; }
+    [[nodiscard]] uint32_t get_graphics_queue_family() const { return m_GraphicsQueue.FamilyIndex; }
+    // Falls back to the graphics queue when the device has no transfer only family
+    [[nodiscard]] const QueueBundle& get_transfer_queue() const { return m_TransferQueue; }
+    [[nodiscard]] bool has_dedicated_transfer_queue() const { return m_TransferQueue.FamilyIndex != m_GraphicsQueue.FamilyIndex; }
 
     // Swapchain
     std::expected<vk::Image, vk::Result> get_next_swapchain_image(vk::Semaphore swapchain_semaphore, uint64_t timeout);
-    [[nodiscard]] vk::Extent2D get_swapchain_extent() const { return m_SwapchainBundle.Extent; }
+    [[nodiscard]] vk::PresentModeKHR get_present_mode() const { return m_PresentMode; }
+    [[nodiscard]] vk::Extent2D get_swapchain_extent() const { return m_Headless ? m_WindowExtent : m_SwapchainBundle.Extent; }
+    // Recreated on resize, compare Handle to notice it
+    [[nodiscard]] const SwapchainBundle& get_swapchain() const { return m_SwapchainBundle; }
+
+    // Draw image
+    // Reallocated along with the swapchain, callers must pick up the new handles every frame.
+    // The previous one goes through the DeferredDeleter. Comes with a depth image of the same size
+    static constexpr vk::Format DEPTH_FORMAT { vk::Format::eD32Sfloat };
+    [[nodiscard]] DrawImageBundle get_draw_image() const;
 
     // Queue
     [[nodiscard]] vk::Result submit_to_queue(const vk::SubmitInfo2& submit_info2, vk::Fence render_fence) const;
+    [[nodiscard]] vk::Result submit_to_transfer_queue(const vk::SubmitInfo2& submit_info2) const;
     vk::Result present(uint32_t semaphores_count, vk::Semaphore* semaphores);
 
     // Sync Structures
-    [[nodiscard]] std::expected<vk::CommandPool, vk::Result> create_command_pool(vk::CommandPoolCreateFlags flags);
+    // Pools default to the graphics queue family
+    [[nodiscard]] std::expected<vk::CommandPool, vk::Result> create_command_pool(vk::CommandPoolCreateFlags flags, std::optional<uint32_t> queue_family = {});
     // TODO make it support multiple command buffers allocations if needed
     [[nodiscard]] std::expected<vk::CommandBuffer, vk::Result> allocate_command_buffer(vk::CommandPool pool, vk::CommandBufferLevel level) const;
     std::expected<vk::Semaphore, vk::Result> create_semaphore(vk::SemaphoreCreateFlags flags);
+    std::expected<vk::Semaphore, vk::Result> create_timeline_semaphore(uint64_t initial_value);
     std::expected<vk::Fence, vk::Result> create_fence(vk::FenceCreateFlags flags);
 
     [[nodiscard]] vk::Result wait_fence(vk::Fence fence, uint64_t timeout) const;
@@ -31,6 +56,7 @@ public:
 
 private:
     bool m_Initialized { false };
+    bool m_Headless { false };
     DeletionQueue m_DeletionQueue;
 
     // Core
@@ -41,28 +67,49 @@ private:
     vk::Device m_Device { nullptr };
     vk::PhysicalDevice m_PhysicalDevice { nullptr };
     VmaAllocator m_Allocator {};
+    MemoryManager m_Memory;
+    DeferredDeleter m_Deleter;
 
     // Queue
     QueueBundle m_GraphicsQueue {};
+    QueueBundle m_TransferQueue {};
 
     // Sync structure handles
     std::vector<vk::CommandPool> m_CommandPools;
     std::vector<vk::Semaphore> m_Semaphores;
     std::vector<vk::Fence> m_Fences;
 
+    // Draw image
     AllocatedImage m_DrawImage {};
+    AllocatedImage m_DepthImage {};
+    vk::ImageUsageFlags m_DrawImageUsage {};
+    vk::Extent2D m_MaxDrawExtent {};
 
     // Swapchain stuff
     SwapchainBundle m_SwapchainBundle;
+    vk::PresentModeKHR m_RequestedPresentMode { vk::PresentModeKHR::eFifo };
+    vk::PresentModeKHR m_PresentMode { vk::PresentModeKHR::eFifo };
+    uint32_t m_MinImageCount { 3 };
+    bool m_RequestedSwapchainStorage { true };
     vk::Image m_CurrentSwapchainImage { nullptr };
     uint32_t m_CurrentSwapchainImageIndex {};
 
     // DeletionQueue m_SwapchainDeletionQueue;
 
+    [[nodiscard]] vk::PresentModeKHR select_present_mode(vk::PresentModeKHR requested) const;
+    [[nodiscard]] bool supports_swapchain_storage() const;
     void create_swapchain();
     void init_swapchain();
     void destroy_swapchain();
     void resize_swapchain();
+
+    void select_draw_image_format(vk::Format requested);
+    [[nodiscard]] vk::Extent3D get_desired_draw_extent() const;
+    [[nodiscard]] std::expected<AllocatedImage, vk::Result> allocate_image(vk::Format format, vk::ImageUsageFlags usage, vk::ImageAspectFlags aspect, vk::Extent3D extent);
+    // Both the draw and the depth image, neither is replaced unless both are allocated
+    [[nodiscard]] vk::Result create_draw_image(vk::Extent3D extent);
+    void destroy_image(const AllocatedImage& image);
+    void resize_draw_image();
 };
 
 }
@@ -0,0 +1,192 @@
+#include "gpu_profiler.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+// Weight of the newest sample in the rolling averages
+static constexpr double AVERAGE_WEIGHT = 0.05;
+
+vk::Result GpuProfiler::init(const vk::Device device, const vk::PhysicalDevice physical_device, const uint32_t queue_family, const uint32_t frame_slots)
+{
+    m_Device = device;
+
+    const auto families = physical_device.getQueueFamilyProperties();
+    const uint32_t valid_bits = queue_family < families.size() ? families[queue_family].timestampValidBits : 0;
+    if (valid_bits == 0) {
+        LOG_ERROR("Queue family {} does not support timestamps, GPU profiler disabled", queue_family);
+        return vk::Result::eSuccess;
+    }
+
+    m_TimestampMask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+    m_TimestampPeriod = physical_device.getProperties().limits.timestampPeriod;
+
+    const vk::QueryPoolCreateInfo info {
+        {},
+        vk::QueryType::eTimestamp,
+        MAX_SCOPES_PER_FRAME * 2
+    };
+
+    m_Slots.resize(frame_slots);
+    for (auto& slot : m_Slots) {
+        const auto [res, pool] = m_Device.createQueryPool(info);
+        if (res != vk::Result::eSuccess) {
+            destroy();
+            return res;
+        }
+        slot.Pool = pool;
+        slot.Scopes.reserve(MAX_SCOPES_PER_FRAME);
+    }
+
+    m_Enabled = true;
+    return vk::Result::eSuccess;
+}
+
+void GpuProfiler::destroy()
+{
+    for (const auto& slot : m_Slots) {
+        if (slot.Pool) {
+            m_Device.destroyQueryPool(slot.Pool);
+        }
+    }
+
+    m_Slots.clear();
+    m_Enabled = false;
+}
+
+void GpuProfiler::begin_frame(const vk::CommandBuffer cmd, const uint32_t frame_slot, const uint64_t frame_number)
+{
+    if (!m_Enabled) {
+        return;
+    }
+
+    m_CurrentSlot = frame_slot;
+    m_CurrentDepth = 0;
+
+    FrameSlot& slot = m_Slots[frame_slot];
+    if (slot.Recorded) {
+        resolve(slot);
+    }
+
+    slot.FrameNumber = frame_number;
+    slot.Scopes.clear();
+    slot.Recorded = true;
+    cmd.resetQueryPool(slot.Pool, 0, MAX_SCOPES_PER_FRAME * 2);
+}
+
+uint32_t GpuProfiler::begin_scope(const vk::CommandBuffer cmd, const char* name)
+{
+    if (!m_Enabled) {
+        return UINT32_MAX;
+    }
+
+    FrameSlot& slot = m_Slots[m_CurrentSlot];
+    if (slot.Scopes.size() >= MAX_SCOPES_PER_FRAME) {
+        return UINT32_MAX;
+    }
+
+    const auto index = static_cast<uint32_t>(slot.Scopes.size());
+    slot.Scopes.push_back(ScopeRecord { name, m_CurrentDepth++ });
+    cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, slot.Pool, index * 2);
+    return index;
+}
+
+void GpuProfiler::end_scope(const vk::CommandBuffer cmd, const uint32_t scope)
+{
+    if (!m_Enabled || scope == UINT32_MAX) {
+        return;
+    }
+
+    m_CurrentDepth--;
+    cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eBottomOfPipe, m_Slots[m_CurrentSlot].Pool, scope * 2 + 1);
+}
+
+void GpuProfiler::resolve(FrameSlot& slot)
+{
+    if (slot.Scopes.empty()) {
+        return;
+    }
+
+    const auto query_count = static_cast<uint32_t>(slot.Scopes.size() * 2);
+    std::array<uint64_t, MAX_SCOPES_PER_FRAME * 2> timestamps {};
+
+    // The frame is complete so this never blocks, eNotReady means a scope was left open
+    const vk::Result res = m_Device.getQueryPoolResults(slot.Pool, 0, query_count,
+        query_count * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64);
+    if (res != vk::Result::eSuccess) {
+        return;
+    }
+
+    if (!m_TraceOrigin.has_value()) {
+        m_TraceOrigin = timestamps[0] & m_TimestampMask;
+    }
+
+    const double us_per_tick = m_TimestampPeriod / 1000.0;
+    double frame_ms = 0.0;
+
+    for (size_t i = 0; i < slot.Scopes.size(); i++) {
+        const uint64_t begin = timestamps[i * 2] & m_TimestampMask;
+        const uint64_t end = timestamps[i * 2 + 1] & m_TimestampMask;
+        const double duration_us = static_cast<double>((end - begin) & m_TimestampMask) * us_per_tick;
+        const double duration_ms = duration_us / 1000.0;
+
+        const ScopeRecord& scope = slot.Scopes[i];
+        const auto [it, inserted] = m_Averages.try_emplace(scope.Name, duration_ms);
+        if (!inserted) {
+            it->second += (duration_ms - it->second) * AVERAGE_WEIGHT;
+        }
+
+        if (scope.Depth == 0) {
+            frame_ms += duration_ms;
+        }
+
+        const double start_us = static_cast<double>(static_cast<int64_t>(begin - m_TraceOrigin.value())) * us_per_tick;
+        m_History.push_back(ResolvedEvent { scope.Name, slot.FrameNumber, scope.Depth, start_us, duration_us });
+    }
+
+    m_LastFrameMs = frame_ms;
+    m_LastFrameNumber = slot.FrameNumber;
+
+    while (!m_History.empty() && m_History.front().FrameNumber + TRACE_FRAME_HISTORY < slot.FrameNumber) {
+        m_History.pop_front();
+    }
+}
+
+double GpuProfiler::get_average_ms(const std::string_view name) const
+{
+    const auto it = m_Averages.find(name);
+    return it != m_Averages.end() ? it->second : 0.0;
+}
+
+std::string GpuProfiler::summary() const
+{
+    std::string out = "GPU:";
+    for (const auto& [name, average] : m_Averages) {
+        out += fmt::format(" {} {:.3f}ms |", name, average);
+    }
+    if (!m_Averages.empty()) {
+        out.pop_back();
+    }
+    return out;
+}
+
+bool GpuProfiler::export_chrome_trace(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR("Unable to open trace file: {}", path.string());
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    file << R"({"name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"GPU"}})";
+    for (const auto& event : m_History) {
+        file << fmt::format(R"(,{{"name":"{}","cat":"gpu","ph":"X","pid":1,"tid":1,"ts":{:.3f},"dur":{:.3f},"args":{{"frame":{}}}}})",
+            event.Name, event.StartUs, event.DurationUs, event.FrameNumber);
+    }
+    file << "]}\n";
+
+    return file.good();
+}
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+/*
+ * Timestamp query profiler.
+ * One query pool per frame slot, indexed like Engine::m_Frames, so results are read back without
+ * waiting: when a slot is reused its previous frame is known to be done.
+ * Scope names are kept by pointer: string literals or names owned by the render graph.
+ */
+class GpuProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME = 64;
+    static constexpr size_t TRACE_FRAME_HISTORY = 256;
+
+    [[nodiscard]] vk::Result init(vk::Device device, vk::PhysicalDevice physical_device, uint32_t queue_family, uint32_t frame_slots);
+    void destroy();
+
+    [[nodiscard]] bool is_enabled() const { return m_Enabled; }
+
+    // Collects the results the slot holds from its last use, then resets it for the new frame.
+    // The caller guarantees that frame has completed on the GPU.
+    void begin_frame(vk::CommandBuffer cmd, uint32_t frame_slot, uint64_t frame_number);
+
+    [[nodiscard]] uint32_t begin_scope(vk::CommandBuffer cmd, const char* name);
+    void end_scope(vk::CommandBuffer cmd, uint32_t scope);
+
+    class Scope {
+    public:
+        Scope(GpuProfiler* profiler, const vk::CommandBuffer cmd, const char* name)
+            : m_Profiler(profiler)
+            , m_Cmd(cmd)
+            , m_Index(profiler ? profiler->begin_scope(cmd, name) : UINT32_MAX)
+        {
+        }
+
+        ~Scope()
+        {
+            if (m_Profiler) {
+                m_Profiler->end_scope(m_Cmd, m_Index);
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GpuProfiler* m_Profiler;
+        vk::CommandBuffer m_Cmd;
+        uint32_t m_Index;
+    };
+
+    // Rolling average in milliseconds, 0 for unknown scopes
+    [[nodiscard]] double get_average_ms(std::string_view name) const;
+    // Sum of the top level scopes of the last resolved frame
+    [[nodiscard]] double get_last_frame_ms() const { return m_LastFrameMs; }
+    // Frame the value above was measured on
+    [[nodiscard]] uint64_t get_last_frame_number() const { return m_LastFrameNumber; }
+    [[nodiscard]] std::string summary() const;
+
+    [[nodiscard]] bool export_chrome_trace(const std::filesystem::path& path) const;
+
+private:
+    struct ScopeRecord {
+        const char* Name { nullptr };
+        uint32_t Depth { 0 };
+    };
+
+    struct FrameSlot {
+        vk::QueryPool Pool { nullptr };
+        uint64_t FrameNumber { 0 };
+        std::vector<ScopeRecord> Scopes;
+        bool Recorded { false };
+    };
+
+    struct ResolvedEvent {
+        const char* Name { nullptr };
+        uint64_t FrameNumber { 0 };
+        uint32_t Depth { 0 };
+        double StartUs { 0.0 };
+        double DurationUs { 0.0 };
+    };
+
+    vk::Device m_Device { nullptr };
+    bool m_Enabled { false };
+    double m_TimestampPeriod { 1.0 }; // nanoseconds per tick
+    uint64_t m_TimestampMask { ~0ull };
+
+    std::vector<FrameSlot> m_Slots;
+    uint32_t m_CurrentSlot { 0 };
+    uint32_t m_CurrentDepth { 0 };
+
+    std::unordered_map<std::string_view, double> m_Averages;
+    double m_LastFrameMs { 0.0 };
+    uint64_t m_LastFrameNumber { 0 };
+    std::optional<uint64_t> m_TraceOrigin {};
+    std::deque<ResolvedEvent> m_History;
+
+    void resolve(FrameSlot& slot);
+};
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+namespace Minecraft {
+
+inline constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+inline constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+// FNV-1a, good enough for cache keys and content checks, not for anything adversarial
+inline uint64_t fnv1a_64(const void* data, const size_t size, uint64_t seed = FNV_OFFSET_BASIS)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        seed ^= bytes[i];
+        seed *= FNV_PRIME;
+    }
+    return seed;
+}
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+uint64_t hash_value(const T& value, const uint64_t seed = FNV_OFFSET_BASIS)
+{
+    return fnv1a_64(&value, sizeof(T), seed);
+}
+
+inline uint64_t hash_combine(const uint64_t seed, const uint64_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+}
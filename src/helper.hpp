@@ -61,13 +61,13 @@ inline vk::RenderingInfo rendering_info(const vk::Extent2D render_extent, const
     return info;
 }
 
-inline vk::PipelineLayoutCreateInfo pipeline_layout_create_info()
+inline vk::PipelineLayoutCreateInfo pipeline_layout_create_info(const std::span<const vk::DescriptorSetLayout> set_layouts = {}, const std::span<const vk::PushConstantRange> push_constants = {})
 {
     vk::PipelineLayoutCreateInfo info {};
-    info.setLayoutCount = 0;
-    info.pSetLayouts = nullptr;
-    info.pushConstantRangeCount = 0;
-    info.pPushConstantRanges = nullptr;
+    info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+    info.pSetLayouts = set_layouts.data();
+    info.pushConstantRangeCount = static_cast<uint32_t>(push_constants.size());
+    info.pPushConstantRanges = push_constants.data();
     return info;
 }
 
@@ -84,33 +84,6 @@ inline vk::PipelineShaderStageCreateInfo pipeline_shader_stage_create_info(const
 
 namespace Minecraft::VkEngine::VkUtil {
 
-inline std::expected<vk::ShaderModule, std::string> load_shader_module(const char* filepath, const vk::Device device)
-{
-    std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        return std::unexpected(fmt::format("Unable to open shader file: {}", filepath));
-    }
-
-    const std::streamsize file_size = file.tellg();
-    std::vector<char> buffer;
-    buffer.resize(file_size);
-    file.seekg(0); // return at beginning of file
-    file.read(buffer.data(), file_size);
-    file.close();
-
-    const vk::ShaderModuleCreateInfo create_info { {},
-        buffer.size(),
-        reinterpret_cast<const uint32_t*>(buffer.data()) };
-
-    const auto [result, shader_module] = device.createShaderModule(create_info);
-
-    if (result != vk::Result::eSuccess) {
-        return std::unexpected(vk::to_string(result));
-    }
-
-    return shader_module;
-}
-
 inline vk::ImageSubresourceRange image_subresource_range(vk::ImageAspectFlags aspect_mask)
 {
     return {
@@ -149,7 +122,9 @@ inline void transition_image(const vk::CommandBuffer& cmd, const vk::Image& imag
     cmd.pipelineBarrier2(dependency_info);
 }
 
-inline void copy_image_to_image(const vk::CommandBuffer cmd, const vk::Image source, const vk::Image destination, const vk::Extent2D src_size, const vk::Extent2D dst_size)
+// Scales src_size onto dst_size, linear filtering needs the formats to support it
+inline void copy_image_to_image(const vk::CommandBuffer cmd, const vk::Image source, const vk::Image destination, const vk::Extent2D src_size, const vk::Extent2D dst_size,
+    const vk::Filter filter = vk::Filter::eLinear)
 {
     constexpr vk::ImageSubresourceLayers src_subresource {
         vk::ImageAspectFlagBits::eColor,
@@ -168,7 +143,7 @@ inline void copy_image_to_image(const vk::CommandBuffer cmd, const vk::Image sou
 
     const std::array dst_offset = {
         vk::Offset3D {},
-        vk::Offset3D { static_cast<int32_t>(src_size.width), static_cast<int32_t>(src_size.height), 1 }
+        vk::Offset3D { static_cast<int32_t>(dst_size.width), static_cast<int32_t>(dst_size.height), 1 }
     };
 
     const vk::ImageBlit2 blit_region {
@@ -180,10 +155,33 @@ inline void copy_image_to_image(const vk::CommandBuffer cmd, const vk::Image sou
         source, vk::ImageLayout::eTransferSrcOptimal,
         destination, vk::ImageLayout::eTransferDstOptimal,
         1, &blit_region,
-        vk::Filter::eNearest
+        filter
     };
 
     cmd.blitImage2(blit_info);
 }
 
+// Raw texel copy, formats only need the same texel size
+inline void copy_image(const vk::CommandBuffer cmd, const vk::Image source, const vk::Image destination, const vk::Extent2D size)
+{
+    constexpr vk::ImageSubresourceLayers subresource {
+        vk::ImageAspectFlagBits::eColor,
+        0, 0, 1
+    };
+
+    const vk::ImageCopy2 copy_region {
+        subresource, vk::Offset3D {},
+        subresource, vk::Offset3D {},
+        vk::Extent3D { size.width, size.height, 1 }
+    };
+
+    const vk::CopyImageInfo2 copy_info {
+        source, vk::ImageLayout::eTransferSrcOptimal,
+        destination, vk::ImageLayout::eTransferDstOptimal,
+        1, &copy_region
+    };
+
+    cmd.copyImage2(copy_info);
+}
+
 }
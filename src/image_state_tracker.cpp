@@ -0,0 +1,142 @@
+#include "image_state_tracker.hpp"
+#include "helper.hpp"
+
+namespace Minecraft::VkEngine {
+
+static constexpr vk::AccessFlags2 WRITE_ACCESS_MASK = vk::AccessFlagBits2::eShaderWrite
+    | vk::AccessFlagBits2::eShaderStorageWrite
+    | vk::AccessFlagBits2::eColorAttachmentWrite
+    | vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+    | vk::AccessFlagBits2::eTransferWrite
+    | vk::AccessFlagBits2::eHostWrite
+    | vk::AccessFlagBits2::eMemoryWrite;
+
+ImageState image_usage_state(const ImageUsage usage)
+{
+    using Layout = vk::ImageLayout;
+    using Stage = vk::PipelineStageFlagBits2;
+    using Access = vk::AccessFlagBits2;
+
+    switch (usage) {
+    case ImageUsage::eClearDst:
+        return { Layout::eTransferDstOptimal, Stage::eClear, Access::eTransferWrite };
+    case ImageUsage::eCopySrc:
+        return { Layout::eTransferSrcOptimal, Stage::eCopy, Access::eTransferRead };
+    case ImageUsage::eCopyDst:
+        return { Layout::eTransferDstOptimal, Stage::eCopy, Access::eTransferWrite };
+    case ImageUsage::eBlitSrc:
+        return { Layout::eTransferSrcOptimal, Stage::eBlit, Access::eTransferRead };
+    case ImageUsage::eBlitDst:
+        return { Layout::eTransferDstOptimal, Stage::eBlit, Access::eTransferWrite };
+    case ImageUsage::eColorAttachment:
+        return { Layout::eColorAttachmentOptimal, Stage::eColorAttachmentOutput, Access::eColorAttachmentRead | Access::eColorAttachmentWrite };
+    case ImageUsage::eDepthAttachment:
+        return { Layout::eDepthAttachmentOptimal, Stage::eEarlyFragmentTests | Stage::eLateFragmentTests,
+            Access::eDepthStencilAttachmentRead | Access::eDepthStencilAttachmentWrite };
+    case ImageUsage::eComputeSampled:
+        return { Layout::eShaderReadOnlyOptimal, Stage::eComputeShader, Access::eShaderSampledRead };
+    case ImageUsage::eFragmentSampled:
+        return { Layout::eShaderReadOnlyOptimal, Stage::eFragmentShader, Access::eShaderSampledRead };
+    case ImageUsage::eComputeStorageRead:
+        return { Layout::eGeneral, Stage::eComputeShader, Access::eShaderStorageRead };
+    case ImageUsage::eComputeStorageWrite:
+        return { Layout::eGeneral, Stage::eComputeShader, Access::eShaderStorageWrite };
+    case ImageUsage::eComputeStorageReadWrite:
+        return { Layout::eGeneral, Stage::eComputeShader, Access::eShaderStorageRead | Access::eShaderStorageWrite };
+    case ImageUsage::ePresent:
+        // Visibility for the presentation engine comes from the semaphore signal
+        return { Layout::ePresentSrcKHR, Stage::eNone, Access::eNone };
+    }
+
+    return {};
+}
+
+void ImageStateTracker::track(const vk::Image image, const vk::ImageAspectFlags aspect, const ImageState& state)
+{
+    assert(!m_Images.contains(image) || !m_Images[image].PendingBarrier.has_value());
+    m_Images[image] = TrackedImage { state, aspect, std::nullopt };
+}
+
+void ImageStateTracker::forget(const vk::Image image)
+{
+    m_Images.erase(image);
+}
+
+void ImageStateTracker::discard(const vk::Image image)
+{
+    const auto it = m_Images.find(image);
+    assert(it != m_Images.end());
+    it->second.State.Layout = vk::ImageLayout::eUndefined;
+}
+
+const ImageState& ImageStateTracker::get_state(const vk::Image image) const
+{
+    const auto it = m_Images.find(image);
+    assert(it != m_Images.end());
+    return it->second.State;
+}
+
+void ImageStateTracker::transition(const vk::Image image, const ImageState& dst)
+{
+    const auto it = m_Images.find(image);
+    assert(it != m_Images.end() && "Image must be tracked before transitioning it");
+    TrackedImage& tracked = it->second;
+
+    // Queued twice before a flush, nothing ran in between so the hop can be collapsed
+    if (tracked.PendingBarrier.has_value()) {
+        vk::ImageMemoryBarrier2& barrier = m_Pending[tracked.PendingBarrier.value()];
+        barrier.newLayout = dst.Layout;
+        barrier.dstStageMask |= dst.Stage;
+        barrier.dstAccessMask |= dst.Access;
+        tracked.State = dst;
+        return;
+    }
+
+    const ImageState& src = tracked.State;
+    const bool layout_change = src.Layout != dst.Layout || dst.Layout == vk::ImageLayout::eUndefined;
+    const vk::AccessFlags2 src_writes = src.Access & WRITE_ACCESS_MASK;
+    const bool dst_writes = static_cast<bool>(dst.Access & WRITE_ACCESS_MASK);
+
+    // Read after read in the same layout: no hazard, later writers must wait on every reader though
+    if (!layout_change && !src_writes && !dst_writes) {
+        tracked.State.Stage |= dst.Stage;
+        tracked.State.Access |= dst.Access;
+        return;
+    }
+
+    // Write after read only needs an execution dependency, nothing has to be made available
+    const vk::ImageMemoryBarrier2 barrier {
+        src.Stage, src_writes,
+        dst.Stage, dst.Access,
+        src.Layout, dst.Layout,
+        vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+        image, VkUtil::image_subresource_range(tracked.Aspect)
+    };
+
+    tracked.PendingBarrier = m_Pending.size();
+    m_Pending.push_back(barrier);
+    tracked.State = dst;
+}
+
+void ImageStateTracker::flush(const vk::CommandBuffer cmd)
+{
+    if (m_Pending.empty()) {
+        return;
+    }
+
+    for (const auto& barrier : m_Pending) {
+        m_Images[barrier.image].PendingBarrier.reset();
+    }
+
+    const vk::DependencyInfo dependency_info {
+        {},
+        0, nullptr,
+        0, nullptr,
+        static_cast<uint32_t>(m_Pending.size()), m_Pending.data()
+    };
+
+    cmd.pipelineBarrier2(dependency_info);
+    m_Pending.clear();
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+struct ImageState {
+    vk::ImageLayout Layout { vk::ImageLayout::eUndefined };
+    vk::PipelineStageFlags2 Stage { vk::PipelineStageFlagBits2::eNone };
+    vk::AccessFlags2 Access { vk::AccessFlagBits2::eNone };
+};
+
+// The ways a frame touches an image, each maps to the narrowest layout/stage/access triple
+enum class ImageUsage {
+    eClearDst,
+    eCopySrc,
+    eCopyDst,
+    eBlitSrc,
+    eBlitDst,
+    eColorAttachment,
+    eDepthAttachment,
+    eComputeSampled,
+    eFragmentSampled,
+    eComputeStorageRead,
+    eComputeStorageWrite,
+    eComputeStorageReadWrite,
+    ePresent
+};
+
+[[nodiscard]] ImageState image_usage_state(ImageUsage usage);
+
+/*
+ * Remembers the last layout, stage and access of every tracked image so transitions only
+ * wait on what really happened before, instead of eAllCommands on both sides.
+ * Transitions are queued and emitted together by flush() in a single pipelineBarrier2.
+ * Nothing must be recorded on the command buffer between transition() and flush().
+ */
+class ImageStateTracker {
+public:
+    void track(vk::Image image, vk::ImageAspectFlags aspect, const ImageState& state = {});
+    void forget(vk::Image image);
+
+    // Next transition of the image will not preserve its content
+    void discard(vk::Image image);
+
+    void transition(vk::Image image, const ImageState& dst);
+    void transition(const vk::Image image, const ImageUsage usage) { transition(image, image_usage_state(usage)); }
+
+    void flush(vk::CommandBuffer cmd);
+
+    [[nodiscard]] const ImageState& get_state(vk::Image image) const;
+    [[nodiscard]] bool has_pending() const { return !m_Pending.empty(); }
+
+private:
+    struct TrackedImage {
+        ImageState State {};
+        vk::ImageAspectFlags Aspect {};
+        // Index in m_Pending when a barrier for this image is already queued
+        std::optional<size_t> PendingBarrier {};
+    };
+
+    std::unordered_map<VkImage, TrackedImage> m_Images;
+    std::vector<vk::ImageMemoryBarrier2> m_Pending;
+};
+
+}
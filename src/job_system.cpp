@@ -0,0 +1,262 @@
+#include "job_system.hpp"
+#include "cpu_profiler.hpp"
+
+namespace Minecraft::VkEngine {
+
+// Pool and worker index of the calling thread, the pool is null outside of any worker
+static thread_local const JobSystem* s_Pool = nullptr;
+static thread_local uint32_t s_Worker = UINT32_MAX;
+static thread_local const std::atomic<bool>* s_CurrentCancelled = nullptr;
+
+void JobSystem::init(uint32_t worker_count)
+{
+    if (worker_count == 0) {
+        worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    m_Stopping = false;
+    for (uint32_t i = 0; i < worker_count; i++) {
+        m_Workers.push_back(std::make_unique<Worker>());
+    }
+
+    // Workers steal from each other, they all have to exist before the first one starts
+    for (uint32_t i = 0; i < worker_count; i++) {
+        m_Threads.emplace_back(&JobSystem::worker_loop, this, i);
+    }
+}
+
+void JobSystem::destroy()
+{
+    // Workers only stop once they find nothing queued, cancelled jobs go through without running
+    {
+        std::scoped_lock lock { m_Mutex };
+        for (const auto& job : m_Jobs) {
+            job->Cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    {
+        std::scoped_lock lock { m_SleepMutex };
+        m_Stopping = true;
+    }
+    m_WorkAvailable.notify_all();
+
+    for (auto& thread : m_Threads) {
+        thread.join();
+    }
+
+    m_Threads.clear();
+    m_Workers.clear();
+    m_Jobs.clear();
+    m_FreeSlots.clear();
+    m_PendingCount = 0;
+    m_QueuedCount = 0;
+}
+
+JobHandle JobSystem::submit(std::function<void()> fn, const JobPriority priority, const std::span<const JobHandle> dependencies)
+{
+    Job* job;
+    JobHandle handle;
+    {
+        std::scoped_lock lock { m_Mutex };
+
+        if (!m_FreeSlots.empty()) {
+            job = m_Jobs[m_FreeSlots.back()].get();
+            m_FreeSlots.pop_back();
+        } else {
+            m_Jobs.push_back(std::make_unique<Job>());
+            job = m_Jobs.back().get();
+            job->Index = static_cast<uint32_t>(m_Jobs.size() - 1);
+        }
+
+        job->Fn = std::move(fn);
+        job->Priority = priority;
+        job->PendingDependencies = 0;
+        job->Cancelled.store(false, std::memory_order_relaxed);
+
+        for (const JobHandle dependency : dependencies) {
+            if (!dependency.is_valid() || dependency.Index >= m_Jobs.size()) {
+                continue;
+            }
+
+            Job& parent = *m_Jobs[dependency.Index];
+            if (parent.Generation == dependency.Generation) {
+                parent.Dependents.push_back(job);
+                job->PendingDependencies++;
+            }
+        }
+
+        handle = JobHandle { job->Index, job->Generation };
+        m_PendingCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (job->PendingDependencies > 0) {
+            return handle;
+        }
+    }
+
+    enqueue(job);
+    return handle;
+}
+
+void JobSystem::cancel(const JobHandle handle)
+{
+    std::scoped_lock lock { m_Mutex };
+    if (handle.is_valid() && handle.Index < m_Jobs.size() && m_Jobs[handle.Index]->Generation == handle.Generation) {
+        m_Jobs[handle.Index]->Cancelled.store(true, std::memory_order_relaxed);
+    }
+}
+
+bool JobSystem::is_finished(const JobHandle handle) const
+{
+    std::scoped_lock lock { m_Mutex };
+    return !handle.is_valid() || handle.Index >= m_Jobs.size() || m_Jobs[handle.Index]->Generation != handle.Generation;
+}
+
+void JobSystem::wait(const JobHandle handle)
+{
+    const uint32_t worker = s_Pool == this ? s_Worker : UINT32_MAX;
+    while (!is_finished(handle)) {
+        if (Job* job = find_job(worker)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::is_cancelled()
+{
+    return s_CurrentCancelled && s_CurrentCancelled->load(std::memory_order_relaxed);
+}
+
+void JobSystem::worker_loop(const uint32_t worker)
+{
+    CpuProfiler::set_thread_name("Job Worker");
+    s_Pool = this;
+    s_Worker = worker;
+
+    while (true) {
+        if (Job* job = find_job(worker)) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock lock { m_SleepMutex };
+        m_WorkAvailable.wait(lock, [&] {
+            return m_Stopping || m_QueuedCount.load(std::memory_order_relaxed) > 0;
+        });
+
+        if (m_Stopping) {
+            return;
+        }
+    }
+}
+
+void JobSystem::enqueue(Job* job)
+{
+    // Jobs queued by a worker stay on it and jump ahead, the others are dealt out and wait their turn
+    const bool local = s_Pool == this;
+    uint32_t worker = local ? s_Worker : UINT32_MAX;
+    if (worker == UINT32_MAX) {
+        worker = m_NextWorker.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(m_Workers.size());
+    }
+
+    {
+        std::scoped_lock lock { m_Workers[worker]->Mutex };
+        auto& queue = m_Workers[worker]->Queues[static_cast<uint32_t>(job->Priority)];
+        if (local) {
+            queue.push_front(job);
+        } else {
+            queue.push_back(job);
+        }
+    }
+
+    // Taking the sleep mutex orders the count with a worker about to wait, no wake up gets lost
+    m_QueuedCount.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::scoped_lock lock { m_SleepMutex };
+    }
+    m_WorkAvailable.notify_one();
+}
+
+JobSystem::Job* JobSystem::find_job(const uint32_t worker)
+{
+    const auto count = static_cast<uint32_t>(m_Workers.size());
+
+    for (uint32_t priority = 0; priority < PRIORITY_COUNT; priority++) {
+        if (worker != UINT32_MAX) {
+            Worker& own = *m_Workers[worker];
+            std::scoped_lock lock { own.Mutex };
+            if (auto& queue = own.Queues[priority]; !queue.empty()) {
+                Job* job = queue.front();
+                queue.pop_front();
+                m_QueuedCount.fetch_sub(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        for (uint32_t offset = 1; offset <= count; offset++) {
+            const uint32_t victim = worker == UINT32_MAX ? offset - 1 : (worker + offset) % count;
+            if (victim == worker) {
+                continue;
+            }
+
+            Worker& other = *m_Workers[victim];
+            std::scoped_lock lock { other.Mutex };
+            if (auto& queue = other.Queues[priority]; !queue.empty()) {
+                Job* job = queue.front();
+                queue.pop_front();
+                m_QueuedCount.fetch_sub(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job)
+{
+    if (!job->Cancelled.load(std::memory_order_relaxed)) {
+        const std::atomic<bool>* previous = s_CurrentCancelled;
+        s_CurrentCancelled = &job->Cancelled;
+        job->Fn();
+        s_CurrentCancelled = previous;
+    }
+
+    finish(job);
+}
+
+void JobSystem::finish(Job* job)
+{
+    std::vector<Job*> ready;
+    std::function<void()> fn;
+    {
+        std::scoped_lock lock { m_Mutex };
+
+        // Whatever waited on a cancelled job is cancelled too
+        const bool cancelled = job->Cancelled.load(std::memory_order_relaxed);
+        for (Job* dependent : job->Dependents) {
+            if (cancelled) {
+                dependent->Cancelled.store(true, std::memory_order_relaxed);
+            }
+            if (--dependent->PendingDependencies == 0) {
+                ready.push_back(dependent);
+            }
+        }
+
+        // Captures are released outside the lock
+        fn = std::move(job->Fn);
+        job->Fn = nullptr;
+        job->Dependents.clear();
+        job->Generation++;
+        m_FreeSlots.push_back(job->Index);
+        m_PendingCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    for (Job* dependent : ready) {
+        enqueue(dependent);
+    }
+}
+
+}
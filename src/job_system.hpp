@@ -0,0 +1,96 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+enum class JobPriority : uint8_t {
+    eHigh,
+    eNormal,
+    eLow
+};
+
+struct JobHandle {
+    uint32_t Index { UINT32_MAX };
+    uint32_t Generation { 0 };
+
+    [[nodiscard]] bool is_valid() const { return Index != UINT32_MAX; }
+};
+
+/*
+ * Work stealing thread pool for the CPU side of world streaming: terrain generation, meshing, upload preparation.
+ *
+ * Every worker owns one deque per priority and everyone takes from the front, the owner first and other
+ * workers stealing when they run dry. Submissions from threads outside the pool are spread round robin and
+ * go to the back, so within a priority they are picked in submission order and callers get the most urgent
+ * jobs started first by submitting them first. Jobs queued by a worker, spawned from a job or released by a
+ * finished dependency, go to the front of its own deque and run newest first while their data is still in cache.
+ * The highest priority job found anywhere wins over lower priority local work.
+ *
+ * A job only gets queued once every job it depends on finished. Cancelling a job that has not started drops it
+ * and everything depending on it, a running job can poll is_cancelled() to give up early.
+ */
+class JobSystem {
+public:
+    static constexpr uint32_t PRIORITY_COUNT = 3;
+
+    // 0 leaves a core to the main thread
+    void init(uint32_t worker_count = 0);
+    // Cancels every job not finished yet, the queued ones are drained without running
+    void destroy();
+
+    // Runs fn once all dependencies are finished, invalid and already finished ones are ignored
+    JobHandle submit(std::function<void()> fn, JobPriority priority = JobPriority::eNormal, std::span<const JobHandle> dependencies = {});
+    void cancel(JobHandle handle);
+
+    // Ran or was cancelled, handles are recycled so a finished one stays finished
+    [[nodiscard]] bool is_finished(JobHandle handle) const;
+    // Runs queued jobs on the calling thread until the handle is finished
+    void wait(JobHandle handle);
+    // From inside a job, true once it was cancelled
+    [[nodiscard]] static bool is_cancelled();
+
+    [[nodiscard]] uint32_t get_worker_count() const { return static_cast<uint32_t>(m_Workers.size()); }
+    // Submitted and not finished yet, waiting on dependencies included
+    [[nodiscard]] uint32_t get_pending_count() const { return m_PendingCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Job {
+        std::function<void()> Fn;
+        JobPriority Priority { JobPriority::eNormal };
+        uint32_t Index { 0 };
+        // Bumped every time the slot is freed, the rest is guarded by m_Mutex
+        uint32_t Generation { 0 };
+        uint32_t PendingDependencies { 0 };
+        std::vector<Job*> Dependents;
+        std::atomic<bool> Cancelled { false };
+    };
+
+    struct Worker {
+        std::mutex Mutex;
+        std::array<std::deque<Job*>, PRIORITY_COUNT> Queues;
+    };
+
+    // Slots and the dependency graph
+    mutable std::mutex m_Mutex;
+    std::vector<std::unique_ptr<Job>> m_Jobs;
+    std::vector<uint32_t> m_FreeSlots;
+    std::atomic<uint32_t> m_PendingCount { 0 };
+
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+    std::vector<std::thread> m_Threads;
+    std::atomic<uint32_t> m_NextWorker { 0 };
+
+    // Sleeping workers, m_QueuedCount is only a wake up hint
+    std::mutex m_SleepMutex;
+    std::condition_variable m_WorkAvailable;
+    std::atomic<uint32_t> m_QueuedCount { 0 };
+    std::atomic<bool> m_Stopping { false };
+
+    void worker_loop(uint32_t worker);
+    void enqueue(Job* job);
+    // Own deques first then the others', fronts only, priority by priority. UINT32_MAX only steals
+    [[nodiscard]] Job* find_job(uint32_t worker);
+    void execute(Job* job);
+    void finish(Job* job);
+};
+
+}
@@ -0,0 +1,76 @@
+#include "ktx2.hpp"
+
+namespace Minecraft {
+
+static constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER {
+    0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+// Identifier, 9 header words then the dfd / kvd / sgd index
+static constexpr size_t KTX2_LEVEL_INDEX_OFFSET = 80;
+
+struct Ktx2LevelIndex {
+    uint64_t ByteOffset;
+    uint64_t ByteLength;
+    uint64_t UncompressedByteLength;
+};
+
+template<typename T>
+static T read(const std::span<const std::byte> data, const size_t offset)
+{
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+std::expected<Ktx2Image, std::string> Ktx2Image::parse(const std::span<const std::byte> data)
+{
+    if (data.size() < KTX2_LEVEL_INDEX_OFFSET || std::memcmp(data.data(), KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) != 0) {
+        return std::unexpected("Not a KTX2 file");
+    }
+
+    const auto vk_format = read<uint32_t>(data, 12);
+    const auto width = read<uint32_t>(data, 20);
+    const auto height = read<uint32_t>(data, 24);
+    const auto depth = read<uint32_t>(data, 28);
+    const auto layer_count = read<uint32_t>(data, 32);
+    const auto face_count = read<uint32_t>(data, 36);
+    const auto level_count = read<uint32_t>(data, 40);
+    const auto supercompression = read<uint32_t>(data, 44);
+
+    if (vk_format == 0) {
+        return std::unexpected("Basis Universal and other VK_FORMAT_UNDEFINED payloads are not supported");
+    }
+
+    if (supercompression != 0) {
+        return std::unexpected(fmt::format("Unsupported supercompression scheme {}", supercompression));
+    }
+
+    if (width == 0 || height == 0 || depth > 1 || face_count != 1) {
+        return std::unexpected("Only 2D textures are supported");
+    }
+
+    const uint32_t stored_levels = std::max(level_count, 1u);
+    if (stored_levels > MAX_LEVELS || KTX2_LEVEL_INDEX_OFFSET + stored_levels * sizeof(Ktx2LevelIndex) > data.size()) {
+        return std::unexpected("Truncated level index");
+    }
+
+    Ktx2Image image;
+    image.Format = static_cast<vk::Format>(vk_format);
+    image.Extent = vk::Extent2D { width, height };
+    image.LayerCount = std::max(layer_count, 1u);
+    image.LevelCount = level_count;
+
+    for (uint32_t level = 0; level < stored_levels; level++) {
+        const auto index = read<Ktx2LevelIndex>(data, KTX2_LEVEL_INDEX_OFFSET + level * sizeof(Ktx2LevelIndex));
+        if (index.ByteLength == 0 || index.ByteOffset > data.size() || index.ByteLength > data.size() - index.ByteOffset) {
+            return std::unexpected(fmt::format("Level {} is out of the file", level));
+        }
+
+        image.Levels[level] = data.subspan(index.ByteOffset, index.ByteLength);
+    }
+
+    return image;
+}
+
+}
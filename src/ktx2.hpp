@@ -0,0 +1,24 @@
+#pragma once
+
+namespace Minecraft {
+
+/*
+ * View over a KTX2 file kept in memory by the caller, usually a MappedFile.
+ * Only what block textures need: one 2D image, one face, no supercompression.
+ * Nothing is decoded, levels point straight into the file so uploads copy from the mapping.
+ */
+struct Ktx2Image {
+    static constexpr uint32_t MAX_LEVELS = 16;
+
+    vk::Format Format { vk::Format::eUndefined };
+    vk::Extent2D Extent {};
+    uint32_t LayerCount { 1 };
+    // 0 when the file asks for its mips to be generated, Levels[0] then holds the base level
+    uint32_t LevelCount { 0 };
+    // Finest first, all layers of a level are contiguous
+    std::array<std::span<const std::byte>, MAX_LEVELS> Levels {};
+
+    static std::expected<Ktx2Image, std::string> parse(std::span<const std::byte> data);
+};
+
+}
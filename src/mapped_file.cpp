@@ -0,0 +1,114 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Minecraft {
+
+std::expected<MappedFile, std::string> MappedFile::open(const std::filesystem::path& path)
+{
+    MappedFile mapped;
+
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::unexpected(fmt::format("Unable to open file: {}", path.string()));
+    }
+
+    LARGE_INTEGER file_size {};
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return std::unexpected(fmt::format("Unable to map empty file: {}", path.string()));
+    }
+
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return std::unexpected(fmt::format("Unable to map file: {}", path.string()));
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return std::unexpected(fmt::format("Unable to map file: {}", path.string()));
+    }
+
+    mapped.m_Mapping = mapping;
+    mapped.m_Data = static_cast<const std::byte*>(view);
+    mapped.m_Size = static_cast<size_t>(file_size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(fmt::format("Unable to open file: {}", path.string()));
+    }
+
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        ::close(fd);
+        return std::unexpected(fmt::format("Unable to map empty file: {}", path.string()));
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return std::unexpected(fmt::format("Unable to map file: {}", path.string()));
+    }
+
+    mapped.m_Data = static_cast<const std::byte*>(view);
+    mapped.m_Size = static_cast<size_t>(file_stat.st_size);
+#endif
+
+    return mapped;
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0);
+#ifdef _WIN32
+        m_Mapping = std::exchange(other.m_Mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::close()
+{
+    if (!m_Data) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_Data);
+    CloseHandle(m_Mapping);
+    m_Mapping = nullptr;
+#else
+    munmap(const_cast<std::byte*>(m_Data), m_Size);
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace Minecraft {
+
+// Read-only memory mapping of a whole file, the OS pages it in on demand
+class MappedFile {
+public:
+    static std::expected<MappedFile, std::string> open(const std::filesystem::path& path);
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] std::span<const std::byte> data() const { return { m_Data, m_Size }; }
+    [[nodiscard]] size_t size() const { return m_Size; }
+    [[nodiscard]] bool is_open() const { return m_Data != nullptr; }
+
+private:
+    const std::byte* m_Data { nullptr };
+    size_t m_Size { 0 };
+#ifdef _WIN32
+    void* m_Mapping { nullptr };
+#endif
+
+    void close();
+};
+
+}
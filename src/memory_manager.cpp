@@ -0,0 +1,179 @@
+#include "memory_manager.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+static constexpr std::array<std::string_view, static_cast<size_t>(MemoryCategory::eCount)> CATEGORY_NAMES {
+    "Draw targets",
+    "Meshes",
+    "Textures",
+    "Staging"
+};
+
+static std::string format_bytes(const uint64_t bytes)
+{
+    constexpr double MIB = 1024.0 * 1024.0;
+    if (bytes >= 1024 * 1024 * 1024) {
+        return fmt::format("{:.2f} GiB", static_cast<double>(bytes) / (MIB * 1024.0));
+    }
+    return fmt::format("{:.1f} MiB", static_cast<double>(bytes) / MIB);
+}
+
+vk::Result MemoryManager::init(const VmaAllocator allocator, const bool budget_extension)
+{
+    m_Allocator = allocator;
+    m_BudgetExtension = budget_extension;
+
+    const VkPhysicalDeviceMemoryProperties* properties;
+    vmaGetMemoryProperties(m_Allocator, &properties);
+    m_HeapCount = properties->memoryHeapCount;
+    for (uint32_t i = 0; i < m_HeapCount; i++) {
+        m_Heaps[i].DeviceLocal = properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    }
+
+    // Same usage as MeshManager's buffers, plus the copies the defragmentation records
+    const vk::BufferCreateInfo buffer_info {
+        {},
+        0x10000,
+        vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eStorageBuffer
+            | vk::BufferUsageFlagBits::eShaderDeviceAddress | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
+        vk::SharingMode::eExclusive
+    };
+
+    VmaAllocationCreateInfo alloc_info {};
+    alloc_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    uint32_t memory_type;
+    VkResult res = vmaFindMemoryTypeIndexForBufferInfo(m_Allocator, reinterpret_cast<const VkBufferCreateInfo*>(&buffer_info), &alloc_info, &memory_type);
+    if (res != VK_SUCCESS) {
+        return static_cast<vk::Result>(res);
+    }
+
+    VmaPoolCreateInfo pool_info {};
+    pool_info.memoryTypeIndex = memory_type;
+    res = vmaCreatePool(m_Allocator, &pool_info, &m_MeshPool);
+    if (res != VK_SUCCESS) {
+        return static_cast<vk::Result>(res);
+    }
+    vmaSetPoolName(m_Allocator, m_MeshPool, "Meshes");
+
+    LOG("Memory budget {}, meshes in memory type {}", m_BudgetExtension ? "from VK_EXT_memory_budget" : "estimated", memory_type);
+    update(0);
+    return vk::Result::eSuccess;
+}
+
+void MemoryManager::destroy()
+{
+    if (m_MeshPool) {
+        vmaDestroyPool(m_Allocator, m_MeshPool);
+        m_MeshPool = nullptr;
+    }
+}
+
+void MemoryManager::track(const MemoryCategory category, const VmaAllocation allocation)
+{
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(m_Allocator, allocation, &info);
+
+    CategoryUsage& usage = m_Categories[static_cast<size_t>(category)];
+    usage.Bytes += info.size;
+    usage.Allocations++;
+}
+
+void MemoryManager::untrack(const MemoryCategory category, const VmaAllocation allocation)
+{
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(m_Allocator, allocation, &info);
+
+    CategoryUsage& usage = m_Categories[static_cast<size_t>(category)];
+    assert(usage.Allocations > 0 && usage.Bytes >= info.size);
+    usage.Bytes -= info.size;
+    usage.Allocations--;
+}
+
+void MemoryManager::update(const uint64_t frame)
+{
+    vmaSetCurrentFrameIndex(m_Allocator, static_cast<uint32_t>(frame));
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets {};
+    vmaGetHeapBudgets(m_Allocator, budgets.data());
+
+    for (uint32_t i = 0; i < m_HeapCount; i++) {
+        HeapUsage& heap = m_Heaps[i];
+        heap.Usage = budgets[i].usage;
+        heap.Budget = budgets[i].budget;
+        heap.BlockBytes = budgets[i].statistics.blockBytes;
+        heap.AllocationBytes = budgets[i].statistics.allocationBytes;
+        heap.AllocationCount = budgets[i].statistics.allocationCount;
+    }
+}
+
+float MemoryManager::get_budget_pressure() const
+{
+    float pressure = 0.0f;
+    for (const HeapUsage& heap : get_heaps()) {
+        if (heap.DeviceLocal && heap.Budget > 0) {
+            pressure = std::max(pressure, static_cast<float>(heap.Usage) / static_cast<float>(heap.Budget));
+        }
+    }
+    return pressure;
+}
+
+float MemoryManager::get_mesh_fragmentation() const
+{
+    VmaDetailedStatistics stats;
+    vmaCalculatePoolStatistics(m_Allocator, m_MeshPool, &stats);
+    return get_fragmentation(stats);
+}
+
+float MemoryManager::get_fragmentation(const VmaDetailedStatistics& stats)
+{
+    const VkDeviceSize free_bytes = stats.statistics.blockBytes - stats.statistics.allocationBytes;
+    if (free_bytes == 0 || stats.unusedRangeCount <= 1) {
+        return 0.0f;
+    }
+
+    return 1.0f - static_cast<float>(stats.unusedRangeSizeMax) / static_cast<float>(free_bytes);
+}
+
+std::string MemoryManager::summary() const
+{
+    std::string out;
+    for (uint32_t i = 0; i < m_HeapCount; i++) {
+        const HeapUsage& heap = m_Heaps[i];
+        if (heap.Budget == 0) {
+            continue;
+        }
+
+        fmt::format_to(std::back_inserter(out), "{}heap {} ({}): {} / {} ({:.0f}%)",
+            out.empty() ? "" : " | ", i, heap.DeviceLocal ? "device" : "host",
+            format_bytes(heap.Usage), format_bytes(heap.Budget),
+            100.0 * static_cast<double>(heap.Usage) / static_cast<double>(heap.Budget));
+    }
+
+    for (size_t i = 0; i < m_Categories.size(); i++) {
+        fmt::format_to(std::back_inserter(out), " | {} {} ({})", CATEGORY_NAMES[i], format_bytes(m_Categories[i].Bytes), m_Categories[i].Allocations);
+    }
+
+    return out;
+}
+
+bool MemoryManager::dump_stats(const std::filesystem::path& path) const
+{
+    char* json = nullptr;
+    vmaBuildStatsString(m_Allocator, &json, VK_TRUE);
+
+    std::ofstream file { path, std::ios::binary | std::ios::trunc };
+    if (file) {
+        file << json;
+    }
+    vmaFreeStatsString(m_Allocator, json);
+
+    if (!file) {
+        LOG_ERROR("Failed to write memory statistics to {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+// What an allocation is used for, only for reporting
+enum class MemoryCategory : uint8_t {
+    eDrawTargets,
+    eMeshes,
+    eTextures,
+    eStaging,
+    eCount
+};
+
+struct CategoryUsage {
+    uint64_t Bytes { 0 };
+    uint32_t Allocations { 0 };
+};
+
+struct HeapUsage {
+    // Usage and Budget cover the whole process (other APIs, the driver) with VK_EXT_memory_budget,
+    // without it they are estimated from VMA's own blocks and 80% of the heap size
+    uint64_t Usage { 0 };
+    uint64_t Budget { 0 };
+    uint64_t BlockBytes { 0 };
+    uint64_t AllocationBytes { 0 };
+    uint32_t AllocationCount { 0 };
+    bool DeviceLocal { false };
+};
+
+/*
+ * Owns the view on VMA: heap budgets refreshed every frame, bytes per MemoryCategory
+ * and the pool chunk meshes are allocated from, kept separate so it can be defragmented
+ * without moving the draw targets or the staging ring.
+ */
+class MemoryManager {
+public:
+    [[nodiscard]] vk::Result init(VmaAllocator allocator, bool budget_extension);
+    void destroy();
+
+    [[nodiscard]] VmaAllocator get_allocator() const { return m_Allocator; }
+    [[nodiscard]] VmaPool get_mesh_pool() const { return m_MeshPool; }
+    [[nodiscard]] bool has_budget_extension() const { return m_BudgetExtension; }
+
+    // Size is read back from the allocation, untrack before freeing it
+    void track(MemoryCategory category, VmaAllocation allocation);
+    void untrack(MemoryCategory category, VmaAllocation allocation);
+
+    // Once per frame, the budget query is cheap but stale until VMA sees the new frame index
+    void update(uint64_t frame);
+
+    [[nodiscard]] std::span<const HeapUsage> get_heaps() const { return { m_Heaps.data(), m_HeapCount }; }
+    [[nodiscard]] const CategoryUsage& get_category(MemoryCategory category) const { return m_Categories[static_cast<size_t>(category)]; }
+    // Highest Usage / Budget ratio over the device local heaps
+    [[nodiscard]] float get_budget_pressure() const;
+    // 0 when the free space of the mesh pool is one contiguous range, towards 1 as it splits up
+    [[nodiscard]] float get_mesh_fragmentation() const;
+    // Same measure over any pool or virtual block
+    [[nodiscard]] static float get_fragmentation(const VmaDetailedStatistics& stats);
+
+    [[nodiscard]] std::string summary() const;
+    // VMA's detailed JSON statistics, for VmaDumpVis or a memory viewer
+    [[nodiscard]] bool dump_stats(const std::filesystem::path& path) const;
+
+private:
+    VmaAllocator m_Allocator { nullptr };
+    VmaPool m_MeshPool { nullptr };
+    bool m_BudgetExtension { false };
+
+    std::array<HeapUsage, VK_MAX_MEMORY_HEAPS> m_Heaps {};
+    uint32_t m_HeapCount { 0 };
+    std::array<CategoryUsage, static_cast<size_t>(MemoryCategory::eCount)> m_Categories {};
+};
+
+}
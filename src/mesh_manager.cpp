@@ -0,0 +1,368 @@
+#include "mesh_manager.hpp"
+#include "frame_scheduler.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+// Transfer source so defragmentation can copy them elsewhere
+static constexpr vk::BufferUsageFlags VERTEX_BUFFER_USAGE {
+    vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress
+    | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst
+};
+static constexpr vk::BufferUsageFlags INDEX_BUFFER_USAGE {
+    vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst
+};
+
+// Allocation user data, 0 for allocations no live mesh owns
+static void* encode_owner(const uint32_t index, const bool is_index_buffer)
+{
+    return reinterpret_cast<void*>((static_cast<uintptr_t>(index) << 1 | is_index_buffer) + 1);
+}
+
+void MeshManager::init(const vk::Device device, MemoryManager& memory, UploadManager& uploads)
+{
+    m_Device = device;
+    m_Allocator = memory.get_allocator();
+    m_Memory = &memory;
+    m_Uploads = &uploads;
+}
+
+void MeshManager::destroy()
+{
+    if (m_Defrag) {
+        if (m_DefragPassFrame != UINT64_MAX) {
+            end_defragmentation_pass();
+        }
+        if (m_Defrag) {
+            end_defragmentation();
+        }
+    }
+
+    for (auto& mesh : m_Meshes) {
+        destroy_mesh(mesh);
+    }
+
+    for (auto& retired : m_Retired) {
+        destroy_mesh(retired.Mesh);
+    }
+
+    m_Meshes.clear();
+    m_FreeSlots.clear();
+    m_Retired.clear();
+}
+
+std::expected<AllocatedBuffer, vk::Result> MeshManager::create_buffer(const vk::DeviceSize size, const vk::BufferUsageFlags usage) const
+{
+    const vk::BufferCreateInfo buffer_info {
+        {},
+        size,
+        usage,
+        vk::SharingMode::eExclusive
+    };
+
+    VmaAllocationCreateInfo alloc_info {};
+    alloc_info.pool = m_Memory->get_mesh_pool();
+
+    VkBuffer buffer;
+    VmaAllocation allocation;
+    const VkResult res = vmaCreateBuffer(m_Allocator, reinterpret_cast<const VkBufferCreateInfo*>(&buffer_info), &alloc_info,
+        &buffer, &allocation, nullptr);
+    if (res != VK_SUCCESS) {
+        return std::unexpected(static_cast<vk::Result>(res));
+    }
+
+    m_Memory->track(MemoryCategory::eMeshes, allocation);
+    return AllocatedBuffer { buffer, allocation, size };
+}
+
+void MeshManager::destroy_mesh(GpuMesh& mesh) const
+{
+    if (mesh.VertexBuffer.Buffer) {
+        m_Memory->untrack(MemoryCategory::eMeshes, mesh.VertexBuffer.Allocation);
+        vmaDestroyBuffer(m_Allocator, mesh.VertexBuffer.Buffer, mesh.VertexBuffer.Allocation);
+    }
+
+    if (mesh.IndexBuffer.Buffer) {
+        m_Memory->untrack(MemoryCategory::eMeshes, mesh.IndexBuffer.Allocation);
+        vmaDestroyBuffer(m_Allocator, mesh.IndexBuffer.Buffer, mesh.IndexBuffer.Allocation);
+    }
+
+    mesh = {};
+}
+
+void MeshManager::set_owner(const GpuMesh& mesh, const uint32_t index) const
+{
+    const bool owned = index != UINT32_MAX;
+    vmaSetAllocationUserData(m_Allocator, mesh.VertexBuffer.Allocation, owned ? encode_owner(index, false) : nullptr);
+    vmaSetAllocationUserData(m_Allocator, mesh.IndexBuffer.Allocation, owned ? encode_owner(index, true) : nullptr);
+}
+
+std::expected<MeshHandle, vk::Result> MeshManager::create(const std::span<const std::byte> vertices, const uint32_t vertex_count, const std::span<const uint32_t> indices)
+{
+    if (vertices.empty() || indices.empty()) {
+        return std::unexpected(vk::Result::eErrorUnknown);
+    }
+
+    GpuMesh mesh {};
+    mesh.VertexCount = vertex_count;
+    mesh.IndexCount = static_cast<uint32_t>(indices.size());
+
+    const auto vertex_buffer = create_buffer(vertices.size(), VERTEX_BUFFER_USAGE);
+    if (!vertex_buffer.has_value()) {
+        return std::unexpected(vertex_buffer.error());
+    }
+    mesh.VertexBuffer = vertex_buffer.value();
+
+    const auto index_buffer = create_buffer(indices.size_bytes(), INDEX_BUFFER_USAGE);
+    if (!index_buffer.has_value()) {
+        destroy_mesh(mesh);
+        return std::unexpected(index_buffer.error());
+    }
+    mesh.IndexBuffer = index_buffer.value();
+
+    const vk::BufferDeviceAddressInfo address_info { mesh.VertexBuffer.Buffer };
+    mesh.VertexAddress = m_Device.getBufferAddress(address_info);
+
+    // Both paths may read the vertices, as attributes or as storage through the address
+    const auto vertex_ticket = m_Uploads->enqueue_buffer(mesh.VertexBuffer.Buffer, 0, vertices,
+        vk::PipelineStageFlagBits2::eVertexAttributeInput | vk::PipelineStageFlagBits2::eVertexShader,
+        vk::AccessFlagBits2::eVertexAttributeRead | vk::AccessFlagBits2::eShaderStorageRead);
+    const auto index_ticket = m_Uploads->enqueue_buffer(mesh.IndexBuffer.Buffer, 0, std::as_bytes(indices),
+        vk::PipelineStageFlagBits2::eIndexInput, vk::AccessFlagBits2::eIndexRead);
+
+    mesh.Ticket = std::max(vertex_ticket.value_or(0), index_ticket.value_or(0));
+
+    if (!vertex_ticket.has_value() || !index_ticket.has_value()) {
+        // One of the copies may already be queued, let the transfer finish before freeing the buffers
+        LOG_ERROR("Failed to upload mesh of {} vertices", vertex_count);
+        m_Retired.push_back(RetiredMesh { mesh, 0 });
+        return std::unexpected(vk::Result::eErrorOutOfDeviceMemory);
+    }
+
+    uint32_t index;
+    if (!m_FreeSlots.empty()) {
+        index = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+        m_Meshes[index] = mesh;
+    } else {
+        index = static_cast<uint32_t>(m_Meshes.size());
+        m_Meshes.push_back(mesh);
+    }
+    set_owner(mesh, index);
+
+    return MeshHandle { index };
+}
+
+const GpuMesh* MeshManager::get(const MeshHandle handle) const
+{
+    if (!handle.is_valid() || handle.Index >= m_Meshes.size() || !m_Meshes[handle.Index].VertexBuffer.Buffer) {
+        return nullptr;
+    }
+
+    return &m_Meshes[handle.Index];
+}
+
+void MeshManager::release(const MeshHandle handle, const uint64_t current_frame)
+{
+    if (!get(handle)) {
+        return;
+    }
+
+    set_owner(m_Meshes[handle.Index], UINT32_MAX);
+    m_Retired.push_back(RetiredMesh { m_Meshes[handle.Index], current_frame });
+    m_Meshes[handle.Index] = {};
+    m_FreeSlots.push_back(handle.Index);
+}
+
+void MeshManager::collect_retired(FrameScheduler& scheduler)
+{
+    // Freeing could pull an allocation from under a pending move
+    if (m_Defrag) {
+        return;
+    }
+
+    std::erase_if(m_Retired, [&](RetiredMesh& retired) {
+        // A failed upload may still have its copies in flight on the transfer queue
+        if (!m_Uploads->is_complete(retired.Mesh.Ticket)) {
+            return false;
+        }
+
+        if (scheduler.is_frame_complete(retired.Frame)) {
+            destroy_mesh(retired.Mesh);
+            return true;
+        }
+        return false;
+    });
+}
+
+void MeshManager::bind(const vk::CommandBuffer cmd, const MeshHandle handle) const
+{
+    const GpuMesh* mesh = get(handle);
+    if (!mesh) {
+        return;
+    }
+
+    constexpr vk::DeviceSize offset = 0;
+    cmd.bindVertexBuffers(0, 1, &mesh->VertexBuffer.Buffer, &offset);
+    cmd.bindIndexBuffer(mesh->IndexBuffer.Buffer, 0, vk::IndexType::eUint32);
+}
+
+
+#pragma region Defragmentation
+
+void MeshManager::defragment(const vk::CommandBuffer cmd, const uint64_t current_frame, FrameScheduler& scheduler, const bool idle)
+{
+    if (!m_Defrag) {
+        if (!m_DefragRequested || !idle) {
+            return;
+        }
+        m_DefragRequested = false;
+
+        VmaDefragmentationInfo info {};
+        info.pool = m_Memory->get_mesh_pool();
+        info.maxBytesPerPass = DEFRAG_MAX_BYTES_PER_PASS;
+        info.maxAllocationsPerPass = DEFRAG_MAX_ALLOCATIONS_PER_PASS;
+
+        if (const VkResult res = vmaBeginDefragmentation(m_Allocator, &info, &m_Defrag); res != VK_SUCCESS) {
+            LOG_ERROR("Failed to start mesh defragmentation: {}", vk::to_string(static_cast<vk::Result>(res)));
+            m_Defrag = nullptr;
+            return;
+        }
+    }
+
+    if (m_DefragPassFrame != UINT64_MAX) {
+        // Covers the copies and every earlier frame still drawing from the old buffers
+        if (!scheduler.is_frame_complete(m_DefragPassFrame)) {
+            return;
+        }
+
+        if (!end_defragmentation_pass()) {
+            return;
+        }
+    }
+
+    if (idle) {
+        begin_defragmentation_pass(cmd, current_frame);
+    }
+}
+
+void MeshManager::begin_defragmentation_pass(const vk::CommandBuffer cmd, const uint64_t current_frame)
+{
+    const VkResult res = vmaBeginDefragmentationPass(m_Allocator, m_Defrag, &m_DefragPass);
+    if (res == VK_SUCCESS) {
+        // Nothing left to move
+        end_defragmentation();
+        return;
+    }
+
+    if (res != VK_INCOMPLETE) {
+        LOG_ERROR("Failed to begin a mesh defragmentation pass: {}", vk::to_string(static_cast<vk::Result>(res)));
+        end_defragmentation();
+        return;
+    }
+
+    // The uploads were made visible to the draws only, extend that to the copies reading them
+    constexpr vk::MemoryBarrier2 read_barrier {
+        vk::PipelineStageFlagBits2::eVertexAttributeInput | vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eIndexInput,
+        vk::AccessFlagBits2::eNone,
+        vk::PipelineStageFlagBits2::eCopy,
+        vk::AccessFlagBits2::eTransferRead
+    };
+    vk::DependencyInfo read_dependency {};
+    read_dependency.setMemoryBarriers(read_barrier);
+    cmd.pipelineBarrier2(read_dependency);
+
+    for (uint32_t i = 0; i < m_DefragPass.moveCount; i++) {
+        VmaDefragmentationMove& move = m_DefragPass.pMoves[i];
+
+        VmaAllocationInfo info;
+        vmaGetAllocationInfo(m_Allocator, move.srcAllocation, &info);
+
+        // Retired meshes are about to be freed, and uploads must be done and owned by the graphics queue
+        const auto owner = reinterpret_cast<uintptr_t>(info.pUserData);
+        const UploadTicket ticket = owner != 0 ? m_Meshes[(owner - 1) >> 1].Ticket : 0;
+        if (owner == 0 || !m_Uploads->is_acquired(ticket) || !m_Uploads->is_complete(ticket)) {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            continue;
+        }
+
+        GpuMesh& mesh = m_Meshes[(owner - 1) >> 1];
+        const bool is_index_buffer = (owner - 1) & 1;
+        AllocatedBuffer& buffer = is_index_buffer ? mesh.IndexBuffer : mesh.VertexBuffer;
+
+        const vk::BufferCreateInfo buffer_info {
+            {},
+            buffer.Size,
+            is_index_buffer ? INDEX_BUFFER_USAGE : VERTEX_BUFFER_USAGE,
+            vk::SharingMode::eExclusive
+        };
+
+        const auto [buffer_res, moved] = m_Device.createBuffer(buffer_info);
+        if (buffer_res != vk::Result::eSuccess) {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            continue;
+        }
+
+        if (vmaBindBufferMemory(m_Allocator, move.dstTmpAllocation, moved) != VK_SUCCESS) {
+            m_Device.destroyBuffer(moved);
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            continue;
+        }
+
+        const vk::BufferCopy region { 0, 0, buffer.Size };
+        cmd.copyBuffer(buffer.Buffer, moved, 1, &region);
+
+        // The allocation handle stays valid, VMA repoints it when the pass ends
+        m_DefragOldBuffers.push_back(buffer.Buffer);
+        buffer.Buffer = moved;
+        if (!is_index_buffer) {
+            const vk::BufferDeviceAddressInfo address_info { moved };
+            mesh.VertexAddress = m_Device.getBufferAddress(address_info);
+        }
+    }
+
+    if (!m_DefragOldBuffers.empty()) {
+        const vk::MemoryBarrier2 barrier {
+            vk::PipelineStageFlagBits2::eCopy,
+            vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eVertexAttributeInput | vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eIndexInput,
+            vk::AccessFlagBits2::eVertexAttributeRead | vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eIndexRead
+        };
+
+        vk::DependencyInfo dependency_info {};
+        dependency_info.setMemoryBarriers(barrier);
+        cmd.pipelineBarrier2(dependency_info);
+    }
+
+    m_DefragPassFrame = current_frame;
+}
+
+bool MeshManager::end_defragmentation_pass()
+{
+    for (const vk::Buffer buffer : m_DefragOldBuffers) {
+        m_Device.destroyBuffer(buffer);
+    }
+    m_DefragOldBuffers.clear();
+    m_DefragPassFrame = UINT64_MAX;
+
+    if (vmaEndDefragmentationPass(m_Allocator, m_Defrag, &m_DefragPass) == VK_INCOMPLETE) {
+        return true;
+    }
+
+    end_defragmentation();
+    return false;
+}
+
+void MeshManager::end_defragmentation()
+{
+    VmaDefragmentationStats stats {};
+    vmaEndDefragmentation(m_Allocator, m_Defrag, &stats);
+    m_Defrag = nullptr;
+
+    LOG("Mesh defragmentation moved {} allocations ({} bytes), freed {} blocks ({} bytes)",
+        stats.allocationsMoved, stats.bytesMoved, stats.deviceMemoryBlocksFreed, stats.bytesFreed);
+}
+
+#pragma endregion
+
+}
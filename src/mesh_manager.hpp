@@ -0,0 +1,113 @@
+#pragma once
+#include "upload_manager.hpp"
+
+namespace Minecraft::VkEngine {
+
+class FrameScheduler;
+
+struct MeshHandle {
+    uint32_t Index { UINT32_MAX };
+
+    [[nodiscard]] bool is_valid() const { return Index != UINT32_MAX; }
+};
+
+struct GpuMesh {
+    AllocatedBuffer VertexBuffer {};
+    AllocatedBuffer IndexBuffer {};
+    // Where vertex pulling shaders read the vertices from
+    vk::DeviceAddress VertexAddress { 0 };
+    uint32_t VertexCount { 0 };
+    uint32_t IndexCount { 0 };
+    // Drawing before the upload completed is fine, the frame waits on the transfer
+    UploadTicket Ticket { 0 };
+};
+
+// Push constant block shared by the vertex pulling shaders
+struct MeshPushConstants {
+    vk::DeviceAddress Vertices { 0 };
+};
+
+/*
+ * VMA backed vertex and index buffers, filled through the UploadManager.
+ * Vertex buffers double as storage buffers with a device address, so the same mesh can be drawn
+ * through the fixed function vertex input or pulled by the vertex shader from MeshPushConstants.
+ * Indices are always 32 bit.
+ *
+ * Buffers come from the MemoryManager's mesh pool. Chunks are rebuilt all the time, so the pool
+ * fragments over a long session; defragment() then moves a few allocations per idle frame,
+ * copying them on the graphics queue ahead of the frame's draws.
+ */
+class MeshManager {
+public:
+    // Upper bounds of one defragmentation pass, what is copied within a single frame
+    static constexpr vk::DeviceSize DEFRAG_MAX_BYTES_PER_PASS = 8 * 1024 * 1024;
+    static constexpr uint32_t DEFRAG_MAX_ALLOCATIONS_PER_PASS = 64;
+
+    void init(vk::Device device, MemoryManager& memory, UploadManager& uploads);
+    void destroy();
+
+    [[nodiscard]] std::expected<MeshHandle, vk::Result> create(std::span<const std::byte> vertices, uint32_t vertex_count, std::span<const uint32_t> indices);
+
+    template<typename V>
+    [[nodiscard]] std::expected<MeshHandle, vk::Result> create(const std::span<const V> vertices, const std::span<const uint32_t> indices)
+    {
+        return create(std::as_bytes(vertices), static_cast<uint32_t>(vertices.size()), indices);
+    }
+
+    // Null for released or invalid handles
+    [[nodiscard]] const GpuMesh* get(MeshHandle handle) const;
+
+    // Buffers live until current_frame, the frame being recorded, is done with them. Kept out of the
+    // DeferredDeleter because a defragmentation pass holds them back
+    void release(MeshHandle handle, uint64_t current_frame);
+    void collect_retired(FrameScheduler& scheduler);
+
+    // Fixed function path, binds the vertex buffer at binding 0 and the index buffer
+    void bind(vk::CommandBuffer cmd, MeshHandle handle) const;
+
+    // Starts an incremental defragmentation of the mesh pool, ignored while one is running
+    void request_defragmentation() { m_DefragRequested = true; }
+    [[nodiscard]] bool is_defragmenting() const { return m_Defrag != nullptr; }
+    // Call before recording draws. Ends the previous pass once its frame completed, and on idle
+    // frames records the copies of the next one into cmd, handles keep working while meshes move.
+    // Retired meshes are only freed between defragmentations
+    void defragment(vk::CommandBuffer cmd, uint64_t current_frame, FrameScheduler& scheduler, bool idle);
+
+    [[nodiscard]] size_t get_mesh_count() const { return m_Meshes.size() - m_FreeSlots.size(); }
+
+private:
+    struct RetiredMesh {
+        GpuMesh Mesh;
+        // Frame being recorded when it was released, same stamp as the DeferredDeleter
+        uint64_t Frame { 0 };
+    };
+
+    vk::Device m_Device { nullptr };
+    VmaAllocator m_Allocator { nullptr };
+    MemoryManager* m_Memory { nullptr };
+    UploadManager* m_Uploads { nullptr };
+
+    std::vector<GpuMesh> m_Meshes;
+    std::vector<uint32_t> m_FreeSlots;
+    std::vector<RetiredMesh> m_Retired;
+
+    // Defragmentation
+    bool m_DefragRequested { false };
+    VmaDefragmentationContext m_Defrag { nullptr };
+    VmaDefragmentationPassMoveInfo m_DefragPass {};
+    // Frame that recorded the pass copies, UINT64_MAX when no pass is in flight
+    uint64_t m_DefragPassFrame { UINT64_MAX };
+    std::vector<vk::Buffer> m_DefragOldBuffers;
+
+    [[nodiscard]] std::expected<AllocatedBuffer, vk::Result> create_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage) const;
+    void destroy_mesh(GpuMesh& mesh) const;
+    // Allocation user data points back at the mesh slot so defragmentation moves can be resolved
+    void set_owner(const GpuMesh& mesh, uint32_t index) const;
+
+    void begin_defragmentation_pass(vk::CommandBuffer cmd, uint64_t current_frame);
+    // False once the whole defragmentation is done
+    bool end_defragmentation_pass();
+    void end_defragmentation();
+};
+
+}
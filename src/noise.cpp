@@ -0,0 +1,220 @@
+#include "noise.hpp"
+
+#if defined(_MSC_VER) && defined(NOISE_KERNELS_X86)
+#include <intrin.h>
+#endif
+
+namespace Minecraft {
+
+namespace NoiseKernels {
+
+    namespace {
+
+        struct ScalarOps {
+            using F = float;
+            using I = uint32_t;
+            static constexpr size_t WIDTH = 1;
+
+            static F load(const float* p) { return *p; }
+            static void store(float* p, const F v) { *p = v; }
+            static F set(const float v) { return v; }
+            static I set_int(const uint32_t v) { return v; }
+
+            static F add(const F a, const F b) { return a + b; }
+            static F sub(const F a, const F b) { return a - b; }
+            static F mul(const F a, const F b) { return a * b; }
+            static F floor(const F v) { return std::floor(v); }
+            static I to_int(const F v) { return static_cast<uint32_t>(static_cast<int32_t>(v)); }
+
+            static I add_int(const I a, const I b) { return a + b; }
+            static I mul_int(const I a, const I b) { return a * b; }
+            static I xor_int(const I a, const I b) { return a ^ b; }
+            static I and_int(const I a, const I b) { return a & b; }
+            static I or_int(const I a, const I b) { return a | b; }
+            // ~mask & v
+            static I andnot_int(const I mask, const I v) { return ~mask & v; }
+            static I cmpeq_int(const I a, const I b) { return a == b ? UINT32_MAX : 0; }
+            template<int N>
+            static I srl(const I v) { return v >> N; }
+            template<int N>
+            static I sll(const I v) { return v << N; }
+
+            static I as_int(const F v) { return std::bit_cast<uint32_t>(v); }
+            static F as_float(const I v) { return std::bit_cast<float>(v); }
+        };
+
+    }
+
+    void fbm_2d_scalar(const Params& params, const float* x, const float* z, float* out, const size_t count)
+    {
+        Kernel<ScalarOps>::fbm(params, x, z, out, count);
+    }
+
+    void fbm_3d_scalar(const Params& params, const float* x, const float* y, const float* z, float* out, const size_t count)
+    {
+        Kernel<ScalarOps>::fbm(params, x, y, z, out, count);
+    }
+
+}
+
+// Block coordinates inside a section, laid out like ChunkSection::index. The first AREA entries are the bottom layer
+struct LocalCoordinates {
+    std::array<float, ChunkSection::VOLUME> X;
+    std::array<float, ChunkSection::VOLUME> Y;
+    std::array<float, ChunkSection::VOLUME> Z;
+};
+
+static constexpr LocalCoordinates LOCAL_COORDINATES = [] {
+    LocalCoordinates local {};
+    for (uint32_t i = 0; i < ChunkSection::VOLUME; i++) {
+        local.X[i] = static_cast<float>(i & (ChunkSection::SIZE - 1));
+        local.Z[i] = static_cast<float>(i >> 4 & (ChunkSection::SIZE - 1));
+        local.Y[i] = static_cast<float>(i >> 8);
+    }
+    return local;
+}();
+
+static SimdLevel query_simd_level()
+{
+#if defined(NOISE_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+    // Also checks the OS saves the AVX registers
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::eAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return SimdLevel::eSse41;
+    }
+    return SimdLevel::eScalar;
+#elif defined(NOISE_KERNELS_X86) && defined(_MSC_VER)
+    std::array<int, 4> info {};
+    __cpuid(info.data(), 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info.data(), 1);
+    const bool sse41 = (info[2] & 1 << 19) != 0;
+    const bool os_saves_ymm = (info[2] & 1 << 27) != 0 && (info[2] & 1 << 28) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+    bool avx2 = false;
+    if (max_leaf >= 7) {
+        __cpuidex(info.data(), 7, 0);
+        avx2 = (info[1] & 1 << 5) != 0;
+    }
+
+    if (avx2 && os_saves_ymm) {
+        return SimdLevel::eAvx2;
+    }
+    return sse41 ? SimdLevel::eSse41 : SimdLevel::eScalar;
+#else
+    return SimdLevel::eScalar;
+#endif
+}
+
+SimdLevel detect_simd_level()
+{
+    static const SimdLevel level = query_simd_level();
+    return level;
+}
+
+std::string_view to_string(const SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::eScalar:
+        return "Scalar";
+    case SimdLevel::eSse41:
+        return "SSE4.1";
+    case SimdLevel::eAvx2:
+        return "AVX2";
+    }
+    return "Unknown";
+}
+
+static NoiseKernels::Params make_params(const FractalSpec& spec, const glm::vec3 offset)
+{
+    float total = 0.0f;
+    float amplitude = 1.0f;
+    for (uint32_t octave = 0; octave < spec.Octaves; octave++) {
+        total += amplitude;
+        amplitude *= spec.Gain;
+    }
+
+    return NoiseKernels::Params {
+        .OffsetX = offset.x,
+        .OffsetY = offset.y,
+        .OffsetZ = offset.z,
+        .Frequency = spec.Frequency,
+        .Lacunarity = spec.Lacunarity,
+        .Gain = spec.Gain,
+        .Normalization = total > 0.0f ? 1.0f / total : 0.0f,
+        .Seed = spec.Seed,
+        .Octaves = spec.Octaves,
+    };
+}
+
+Noise::Noise(const SimdLevel level)
+    : m_Level(std::min(level, detect_simd_level()))
+{
+    switch (m_Level) {
+#ifdef NOISE_KERNELS_X86
+    case SimdLevel::eAvx2:
+        m_Width = NoiseKernels::AVX2_WIDTH;
+        m_Fbm2d = NoiseKernels::fbm_2d_avx2;
+        m_Fbm3d = NoiseKernels::fbm_3d_avx2;
+        break;
+    case SimdLevel::eSse41:
+        m_Width = NoiseKernels::SSE41_WIDTH;
+        m_Fbm2d = NoiseKernels::fbm_2d_sse41;
+        m_Fbm3d = NoiseKernels::fbm_3d_sse41;
+        break;
+#endif
+    default:
+        m_Level = SimdLevel::eScalar;
+        m_Width = 1;
+        m_Fbm2d = NoiseKernels::fbm_2d_scalar;
+        m_Fbm3d = NoiseKernels::fbm_3d_scalar;
+        break;
+    }
+}
+
+void Noise::fbm_2d(const FractalSpec& spec, const std::span<const float> x, const std::span<const float> z, const std::span<float> out, const glm::vec2 offset) const
+{
+    assert(x.size() == out.size() && z.size() == out.size());
+
+    const NoiseKernels::Params params = make_params(spec, glm::vec3 { offset.x, 0.0f, offset.y });
+    const size_t body = out.size() - out.size() % m_Width;
+    if (body > 0) {
+        m_Fbm2d(params, x.data(), z.data(), out.data(), body);
+    }
+    if (body < out.size()) {
+        NoiseKernels::fbm_2d_scalar(params, x.data() + body, z.data() + body, out.data() + body, out.size() - body);
+    }
+}
+
+void Noise::fbm_3d(const FractalSpec& spec, const std::span<const float> x, const std::span<const float> y, const std::span<const float> z, const std::span<float> out,
+    const glm::vec3 offset) const
+{
+    assert(x.size() == out.size() && y.size() == out.size() && z.size() == out.size());
+
+    const NoiseKernels::Params params = make_params(spec, offset);
+    const size_t body = out.size() - out.size() % m_Width;
+    if (body > 0) {
+        m_Fbm3d(params, x.data(), y.data(), z.data(), out.data(), body);
+    }
+    if (body < out.size()) {
+        NoiseKernels::fbm_3d_scalar(params, x.data() + body, y.data() + body, z.data() + body, out.data() + body, out.size() - body);
+    }
+}
+
+void Noise::fbm_area(const FractalSpec& spec, const glm::ivec2 origin, const std::span<float, ChunkSection::AREA> out) const
+{
+    const auto x = std::span { LOCAL_COORDINATES.X }.first<ChunkSection::AREA>();
+    const auto z = std::span { LOCAL_COORDINATES.Z }.first<ChunkSection::AREA>();
+    fbm_2d(spec, x, z, out, glm::vec2 { origin });
+}
+
+void Noise::fbm_section(const FractalSpec& spec, const glm::ivec3 origin, const std::span<float, ChunkSection::VOLUME> out) const
+{
+    fbm_3d(spec, LOCAL_COORDINATES.X, LOCAL_COORDINATES.Y, LOCAL_COORDINATES.Z, out, glm::vec3 { origin });
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "chunk_section.hpp"
+#include "noise_kernels.hpp"
+
+namespace Minecraft {
+
+enum class SimdLevel : uint8_t {
+    eScalar,
+    eSse41,
+    eAvx2,
+};
+
+// Widest kernel this CPU and OS can run, checked once
+[[nodiscard]] SimdLevel detect_simd_level();
+[[nodiscard]] std::string_view to_string(SimdLevel level);
+
+struct FractalSpec {
+    uint32_t Seed { 0 };
+    // Of the first octave, in cycles per block
+    float Frequency { 1.0f / 64.0f };
+    uint32_t Octaves { 4 };
+    // Frequency and amplitude multipliers from one octave to the next
+    float Lacunarity { 2.0f };
+    float Gain { 0.5f };
+};
+
+/*
+ * Fractal Brownian motion over 2D and 3D Perlin gradient noise. Results stay well inside [-1, 1]: over millions
+ * of samples four octaves reach about ±0.57 in 2D and ±0.68 in 3D, most values much closer to 0.
+ *
+ * Points are evaluated in batches, as many per instruction as the widest kernel allows: AVX2, SSE4.1 or scalar,
+ * picked at runtime so one binary runs everywhere. The remainder of a batch that doesn't fill a vector goes
+ * through the scalar kernel, every kernel returns the same values. Stateless once built, threads can share one.
+ */
+class Noise {
+public:
+    // Never goes above what detect_simd_level reports
+    explicit Noise(SimdLevel level = detect_simd_level());
+
+    // Coordinates in blocks, offset is added to every point before the frequency is applied
+    void fbm_2d(const FractalSpec& spec, std::span<const float> x, std::span<const float> z, std::span<float> out, glm::vec2 offset = glm::vec2 { 0.0f }) const;
+    void fbm_3d(const FractalSpec& spec, std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<float> out,
+        glm::vec3 offset = glm::vec3 { 0.0f }) const;
+
+    // One batch over the columns of a section, indexed x + z * SIZE from the block at origin
+    void fbm_area(const FractalSpec& spec, glm::ivec2 origin, std::span<float, ChunkSection::AREA> out) const;
+    // One batch over every block of a section, indexed like ChunkSection::index from the block at origin
+    void fbm_section(const FractalSpec& spec, glm::ivec3 origin, std::span<float, ChunkSection::VOLUME> out) const;
+
+    [[nodiscard]] SimdLevel get_level() const { return m_Level; }
+
+private:
+    SimdLevel m_Level { SimdLevel::eScalar };
+    size_t m_Width { 1 };
+    NoiseKernels::Fbm2d m_Fbm2d { nullptr };
+    NoiseKernels::Fbm3d m_Fbm3d { nullptr };
+};
+
+}
@@ -0,0 +1,58 @@
+// Built with AVX2 enabled and without the precompiled header, only called after the CPU has been checked
+#include "noise_kernels.hpp"
+
+#ifdef NOISE_KERNELS_X86
+#include <immintrin.h>
+
+namespace Minecraft::NoiseKernels {
+
+namespace {
+
+    struct Avx2Ops {
+        using F = __m256;
+        using I = __m256i;
+        static constexpr size_t WIDTH = AVX2_WIDTH;
+
+        static F load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, const F v) { _mm256_storeu_ps(p, v); }
+        static F set(const float v) { return _mm256_set1_ps(v); }
+        static I set_int(const uint32_t v) { return _mm256_set1_epi32(static_cast<int32_t>(v)); }
+
+        static F add(const F a, const F b) { return _mm256_add_ps(a, b); }
+        static F sub(const F a, const F b) { return _mm256_sub_ps(a, b); }
+        static F mul(const F a, const F b) { return _mm256_mul_ps(a, b); }
+        static F floor(const F v) { return _mm256_floor_ps(v); }
+        static I to_int(const F v) { return _mm256_cvttps_epi32(v); }
+
+        static I add_int(const I a, const I b) { return _mm256_add_epi32(a, b); }
+        static I mul_int(const I a, const I b) { return _mm256_mullo_epi32(a, b); }
+        static I xor_int(const I a, const I b) { return _mm256_xor_si256(a, b); }
+        static I and_int(const I a, const I b) { return _mm256_and_si256(a, b); }
+        static I or_int(const I a, const I b) { return _mm256_or_si256(a, b); }
+        // ~mask & v
+        static I andnot_int(const I mask, const I v) { return _mm256_andnot_si256(mask, v); }
+        static I cmpeq_int(const I a, const I b) { return _mm256_cmpeq_epi32(a, b); }
+        template<int N>
+        static I srl(const I v) { return _mm256_srli_epi32(v, N); }
+        template<int N>
+        static I sll(const I v) { return _mm256_slli_epi32(v, N); }
+
+        static I as_int(const F v) { return _mm256_castps_si256(v); }
+        static F as_float(const I v) { return _mm256_castsi256_ps(v); }
+    };
+
+}
+
+void fbm_2d_avx2(const Params& params, const float* x, const float* z, float* out, const size_t count)
+{
+    Kernel<Avx2Ops>::fbm(params, x, z, out, count);
+}
+
+void fbm_3d_avx2(const Params& params, const float* x, const float* y, const float* z, float* out, const size_t count)
+{
+    Kernel<Avx2Ops>::fbm(params, x, y, z, out, count);
+}
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+#pragma once
+// Also included by the SIMD translation units, which are built without the precompiled header
+#include <cstddef>
+#include <cstdint>
+
+namespace Minecraft::NoiseKernels {
+
+// Fractal Brownian motion over Perlin gradient noise, see Noise in noise.hpp
+struct Params {
+    // Added to the coordinates before the frequency is applied
+    float OffsetX { 0.0f };
+    float OffsetY { 0.0f };
+    float OffsetZ { 0.0f };
+    float Frequency { 1.0f };
+    float Lacunarity { 2.0f };
+    float Gain { 0.5f };
+    // One over the sum of the octave amplitudes
+    float Normalization { 1.0f };
+    uint32_t Seed { 0 };
+    uint32_t Octaves { 1 };
+};
+
+// count must be a multiple of the kernel width
+using Fbm2d = void (*)(const Params& params, const float* x, const float* z, float* out, size_t count);
+using Fbm3d = void (*)(const Params& params, const float* x, const float* y, const float* z, float* out, size_t count);
+
+inline constexpr size_t SSE41_WIDTH = 4;
+inline constexpr size_t AVX2_WIDTH = 8;
+
+void fbm_2d_scalar(const Params& params, const float* x, const float* z, float* out, size_t count);
+void fbm_3d_scalar(const Params& params, const float* x, const float* y, const float* z, float* out, size_t count);
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NOISE_KERNELS_X86 1
+void fbm_2d_sse41(const Params& params, const float* x, const float* z, float* out, size_t count);
+void fbm_3d_sse41(const Params& params, const float* x, const float* y, const float* z, float* out, size_t count);
+void fbm_2d_avx2(const Params& params, const float* x, const float* z, float* out, size_t count);
+void fbm_3d_avx2(const Params& params, const float* x, const float* y, const float* z, float* out, size_t count);
+#endif
+
+// Instantiated once per instruction set over an Ops type (vector types and their operations).
+// Internal linkage, the linker can't hand code built for AVX2 to a translation unit built without it.
+// Only mul and add, no fused multiply-add, so every width returns the scalar results bit for bit
+namespace {
+
+    constexpr uint32_t PRIME_X = 0x8DA6B343u;
+    constexpr uint32_t PRIME_Y = 0xD8163841u;
+    constexpr uint32_t PRIME_Z = 0xCB1AB31Fu;
+    constexpr uint32_t HASH_MULTIPLIER = 0x27D4EB2Du;
+    constexpr uint32_t OCTAVE_SEED_STEP = 0x9E3779B9u;
+
+    template<typename Ops>
+    struct Kernel {
+        using F = typename Ops::F;
+        using I = typename Ops::I;
+
+        // t³(t(6t - 15) + 10)
+        static F fade(const F t)
+        {
+            const F inner = Ops::add(Ops::mul(t, Ops::sub(Ops::mul(t, Ops::set(6.0f)), Ops::set(15.0f))), Ops::set(10.0f));
+            return Ops::mul(Ops::mul(Ops::mul(t, t), t), inner);
+        }
+
+        static F lerp(const F a, const F b, const F t)
+        {
+            return Ops::add(a, Ops::mul(t, Ops::sub(b, a)));
+        }
+
+        // Corners arrive premultiplied by their prime, the high bits of the mix pick the gradient
+        static I hash(const I seed, const I px, const I pz)
+        {
+            I h = Ops::mul_int(Ops::xor_int(Ops::xor_int(seed, px), pz), Ops::set_int(HASH_MULTIPLIER));
+            h = Ops::xor_int(h, Ops::template srl<15>(h));
+            return Ops::mul_int(h, Ops::set_int(HASH_MULTIPLIER));
+        }
+
+        static I hash(const I seed, const I px, const I py, const I pz)
+        {
+            return hash(Ops::xor_int(seed, py), px, pz);
+        }
+
+        static F select(const I mask, const F a, const F b)
+        {
+            return Ops::as_float(Ops::or_int(Ops::and_int(mask, Ops::as_int(a)), Ops::andnot_int(mask, Ops::as_int(b))));
+        }
+
+        static F flip_sign(const F value, const I sign_bit)
+        {
+            return Ops::as_float(Ops::xor_int(Ops::as_int(value), sign_bit));
+        }
+
+        static I has_no_bits(const I h, const uint32_t bits)
+        {
+            return Ops::cmpeq_int(Ops::and_int(h, Ops::set_int(bits)), Ops::set_int(0));
+        }
+
+        // (±1, ±2) and (±2, ±1), 3 bits of h
+        static F gradient(const I h, const F x, const F z)
+        {
+            const I x_first = has_no_bits(h, 4);
+            const F u = select(x_first, x, z);
+            const F v = select(x_first, z, x);
+            const I u_sign = Ops::template sll<31>(Ops::and_int(h, Ops::set_int(1)));
+            const I v_sign = Ops::template sll<30>(Ops::and_int(h, Ops::set_int(2)));
+            return Ops::add(flip_sign(u, u_sign), flip_sign(Ops::add(v, v), v_sign));
+        }
+
+        // Improved Perlin noise gradients, the 12 cube edge directions with 4 of them repeated, 4 bits of h
+        static F gradient(const I h, const F x, const F y, const F z)
+        {
+            const F u = select(has_no_bits(h, 8), x, y);
+            const I y_second = has_no_bits(h, 12);
+            const I x_second = Ops::cmpeq_int(Ops::and_int(h, Ops::set_int(13)), Ops::set_int(12));
+            const F v = select(y_second, y, select(x_second, x, z));
+            const I u_sign = Ops::template sll<31>(Ops::and_int(h, Ops::set_int(1)));
+            const I v_sign = Ops::template sll<30>(Ops::and_int(h, Ops::set_int(2)));
+            return Ops::add(flip_sign(u, u_sign), flip_sign(v, v_sign));
+        }
+
+        static F perlin(const F x, const F z, const I seed)
+        {
+            const F floor_x = Ops::floor(x);
+            const F floor_z = Ops::floor(z);
+            const F tx = Ops::sub(x, floor_x);
+            const F tz = Ops::sub(z, floor_z);
+            const F tx1 = Ops::sub(tx, Ops::set(1.0f));
+            const F tz1 = Ops::sub(tz, Ops::set(1.0f));
+
+            const I px0 = Ops::mul_int(Ops::to_int(floor_x), Ops::set_int(PRIME_X));
+            const I pz0 = Ops::mul_int(Ops::to_int(floor_z), Ops::set_int(PRIME_Z));
+            const I px1 = Ops::add_int(px0, Ops::set_int(PRIME_X));
+            const I pz1 = Ops::add_int(pz0, Ops::set_int(PRIME_Z));
+
+            const F n00 = gradient(Ops::template srl<29>(hash(seed, px0, pz0)), tx, tz);
+            const F n10 = gradient(Ops::template srl<29>(hash(seed, px1, pz0)), tx1, tz);
+            const F n01 = gradient(Ops::template srl<29>(hash(seed, px0, pz1)), tx, tz1);
+            const F n11 = gradient(Ops::template srl<29>(hash(seed, px1, pz1)), tx1, tz1);
+
+            const F u = fade(tx);
+            const F w = fade(tz);
+            // Gradients reach a length of √5, this keeps the result inside [-1, 1]
+            return Ops::mul(lerp(lerp(n00, n10, u), lerp(n01, n11, u), w), Ops::set(0.5f));
+        }
+
+        static F perlin(const F x, const F y, const F z, const I seed)
+        {
+            const F floor_x = Ops::floor(x);
+            const F floor_y = Ops::floor(y);
+            const F floor_z = Ops::floor(z);
+            const F tx = Ops::sub(x, floor_x);
+            const F ty = Ops::sub(y, floor_y);
+            const F tz = Ops::sub(z, floor_z);
+            const F tx1 = Ops::sub(tx, Ops::set(1.0f));
+            const F ty1 = Ops::sub(ty, Ops::set(1.0f));
+            const F tz1 = Ops::sub(tz, Ops::set(1.0f));
+
+            const I px0 = Ops::mul_int(Ops::to_int(floor_x), Ops::set_int(PRIME_X));
+            const I py0 = Ops::mul_int(Ops::to_int(floor_y), Ops::set_int(PRIME_Y));
+            const I pz0 = Ops::mul_int(Ops::to_int(floor_z), Ops::set_int(PRIME_Z));
+            const I px1 = Ops::add_int(px0, Ops::set_int(PRIME_X));
+            const I py1 = Ops::add_int(py0, Ops::set_int(PRIME_Y));
+            const I pz1 = Ops::add_int(pz0, Ops::set_int(PRIME_Z));
+
+            const F n000 = gradient(Ops::template srl<28>(hash(seed, px0, py0, pz0)), tx, ty, tz);
+            const F n100 = gradient(Ops::template srl<28>(hash(seed, px1, py0, pz0)), tx1, ty, tz);
+            const F n010 = gradient(Ops::template srl<28>(hash(seed, px0, py1, pz0)), tx, ty1, tz);
+            const F n110 = gradient(Ops::template srl<28>(hash(seed, px1, py1, pz0)), tx1, ty1, tz);
+            const F n001 = gradient(Ops::template srl<28>(hash(seed, px0, py0, pz1)), tx, ty, tz1);
+            const F n101 = gradient(Ops::template srl<28>(hash(seed, px1, py0, pz1)), tx1, ty, tz1);
+            const F n011 = gradient(Ops::template srl<28>(hash(seed, px0, py1, pz1)), tx, ty1, tz1);
+            const F n111 = gradient(Ops::template srl<28>(hash(seed, px1, py1, pz1)), tx1, ty1, tz1);
+
+            const F u = fade(tx);
+            const F v = fade(ty);
+            const F w = fade(tz);
+            const F near_plane = lerp(lerp(n000, n100, u), lerp(n010, n110, u), v);
+            const F far_plane = lerp(lerp(n001, n101, u), lerp(n011, n111, u), v);
+            return lerp(near_plane, far_plane, w);
+        }
+
+        static void fbm(const Params& params, const float* x, const float* z, float* out, const size_t count)
+        {
+            const F offset_x = Ops::set(params.OffsetX);
+            const F offset_z = Ops::set(params.OffsetZ);
+
+            for (size_t i = 0; i < count; i += Ops::WIDTH) {
+                const F px = Ops::add(Ops::load(x + i), offset_x);
+                const F pz = Ops::add(Ops::load(z + i), offset_z);
+
+                F sum = Ops::set(0.0f);
+                float frequency = params.Frequency;
+                float amplitude = 1.0f;
+                uint32_t seed = params.Seed;
+                for (uint32_t octave = 0; octave < params.Octaves; octave++) {
+                    const F f = Ops::set(frequency);
+                    sum = Ops::add(sum, Ops::mul(perlin(Ops::mul(px, f), Ops::mul(pz, f), Ops::set_int(seed)), Ops::set(amplitude)));
+                    frequency *= params.Lacunarity;
+                    amplitude *= params.Gain;
+                    seed += OCTAVE_SEED_STEP;
+                }
+
+                Ops::store(out + i, Ops::mul(sum, Ops::set(params.Normalization)));
+            }
+        }
+
+        static void fbm(const Params& params, const float* x, const float* y, const float* z, float* out, const size_t count)
+        {
+            const F offset_x = Ops::set(params.OffsetX);
+            const F offset_y = Ops::set(params.OffsetY);
+            const F offset_z = Ops::set(params.OffsetZ);
+
+            for (size_t i = 0; i < count; i += Ops::WIDTH) {
+                const F px = Ops::add(Ops::load(x + i), offset_x);
+                const F py = Ops::add(Ops::load(y + i), offset_y);
+                const F pz = Ops::add(Ops::load(z + i), offset_z);
+
+                F sum = Ops::set(0.0f);
+                float frequency = params.Frequency;
+                float amplitude = 1.0f;
+                uint32_t seed = params.Seed;
+                for (uint32_t octave = 0; octave < params.Octaves; octave++) {
+                    const F f = Ops::set(frequency);
+                    sum = Ops::add(sum, Ops::mul(perlin(Ops::mul(px, f), Ops::mul(py, f), Ops::mul(pz, f), Ops::set_int(seed)), Ops::set(amplitude)));
+                    frequency *= params.Lacunarity;
+                    amplitude *= params.Gain;
+                    seed += OCTAVE_SEED_STEP;
+                }
+
+                Ops::store(out + i, Ops::mul(sum, Ops::set(params.Normalization)));
+            }
+        }
+    };
+
+}
+
+}
@@ -0,0 +1,58 @@
+// Built with SSE4.1 enabled and without the precompiled header, only called after the CPU has been checked
+#include "noise_kernels.hpp"
+
+#ifdef NOISE_KERNELS_X86
+#include <immintrin.h>
+
+namespace Minecraft::NoiseKernels {
+
+namespace {
+
+    struct Sse41Ops {
+        using F = __m128;
+        using I = __m128i;
+        static constexpr size_t WIDTH = SSE41_WIDTH;
+
+        static F load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, const F v) { _mm_storeu_ps(p, v); }
+        static F set(const float v) { return _mm_set1_ps(v); }
+        static I set_int(const uint32_t v) { return _mm_set1_epi32(static_cast<int32_t>(v)); }
+
+        static F add(const F a, const F b) { return _mm_add_ps(a, b); }
+        static F sub(const F a, const F b) { return _mm_sub_ps(a, b); }
+        static F mul(const F a, const F b) { return _mm_mul_ps(a, b); }
+        static F floor(const F v) { return _mm_floor_ps(v); }
+        static I to_int(const F v) { return _mm_cvttps_epi32(v); }
+
+        static I add_int(const I a, const I b) { return _mm_add_epi32(a, b); }
+        static I mul_int(const I a, const I b) { return _mm_mullo_epi32(a, b); }
+        static I xor_int(const I a, const I b) { return _mm_xor_si128(a, b); }
+        static I and_int(const I a, const I b) { return _mm_and_si128(a, b); }
+        static I or_int(const I a, const I b) { return _mm_or_si128(a, b); }
+        // ~mask & v
+        static I andnot_int(const I mask, const I v) { return _mm_andnot_si128(mask, v); }
+        static I cmpeq_int(const I a, const I b) { return _mm_cmpeq_epi32(a, b); }
+        template<int N>
+        static I srl(const I v) { return _mm_srli_epi32(v, N); }
+        template<int N>
+        static I sll(const I v) { return _mm_slli_epi32(v, N); }
+
+        static I as_int(const F v) { return _mm_castps_si128(v); }
+        static F as_float(const I v) { return _mm_castsi128_ps(v); }
+    };
+
+}
+
+void fbm_2d_sse41(const Params& params, const float* x, const float* z, float* out, const size_t count)
+{
+    Kernel<Sse41Ops>::fbm(params, x, z, out, count);
+}
+
+void fbm_3d_sse41(const Params& params, const float* x, const float* y, const float* z, float* out, const size_t count)
+{
+    Kernel<Sse41Ops>::fbm(params, x, y, z, out, count);
+}
+
+}
+
+#endif
@@ -10,19 +10,46 @@
 #include <vk_mem_alloc.h>
 
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_precision.hpp>
 
 #include <fmt/format.h>
 #include <fmt/color.h>
 #include <fmt/ostream.h>
 
 #include <iostream>
-
+#include <limits>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
 #include <expected>
 #include <deque>
+#include <filesystem>
+#include <fstream>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
 #include <ranges>
 #include <vector>
 #include <cassert>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
@@ -1,6 +1,8 @@
 #include "pipeline.hpp"
 
+#include "hash.hpp"
 #include "helper.hpp"
+#include "pipeline_cache.hpp"
 
 namespace Minecraft::VkEngine {
 
@@ -14,10 +16,16 @@ void PipelineBuilder::clear()
     RenderInfo = vk::PipelineRenderingCreateInfo {};
     ShaderStages.resize(2);
     ShaderStages.clear();
+    VertexBindings.clear();
+    VertexAttributes.clear();
 }
 
-std::expected<vk::Pipeline, vk::Result> PipelineBuilder::build_pipeline(const vk::Device device, const vk::PipelineLayout layout)
+std::expected<vk::Pipeline, vk::Result> PipelineBuilder::build_pipeline(const vk::Device device, const vk::PipelineLayout layout, PipelineCache* cache)
 {
+    if (is_compute()) {
+        return build_compute_pipeline(device, layout, cache);
+    }
+
     constexpr vk::PipelineViewportStateCreateInfo viewport_state { {},
         1, {},
         1, {} };
@@ -27,7 +35,9 @@ std::expected<vk::Pipeline, vk::Result> PipelineBuilder::build_pipeline(const vk
         vk::LogicOp::eCopy,
         1, &ColorBlendAttachment };
 
-    constexpr vk::PipelineVertexInputStateCreateInfo vertex_input_info {};
+    const vk::PipelineVertexInputStateCreateInfo vertex_input_info { {},
+        static_cast<uint32_t>(VertexBindings.size()), VertexBindings.data(),
+        static_cast<uint32_t>(VertexAttributes.size()), VertexAttributes.data() };
 
     constexpr vk::DynamicState state[] = {
         vk::DynamicState::eViewport,
@@ -37,8 +47,18 @@ std::expected<vk::Pipeline, vk::Result> PipelineBuilder::build_pipeline(const vk
     vk::PipelineDynamicStateCreateInfo dynamic_info { {},
         2, &state[0] };
 
+    // Builders get copied around, never trust a pointer into ourselves taken before the copy
+    RenderInfo.pColorAttachmentFormats = RenderInfo.colorAttachmentCount > 0 ? &ColorAttachmentFormat : nullptr;
+
+    vk::PipelineCreationFeedback creation_feedback {};
+    const vk::PipelineCreationFeedbackCreateInfo feedback_info {
+        &creation_feedback,
+        0, nullptr,
+        &RenderInfo
+    };
+
     vk::GraphicsPipelineCreateInfo pipeline_info;
-    pipeline_info.pNext = &RenderInfo;
+    pipeline_info.pNext = &feedback_info;
 
     pipeline_info.stageCount = static_cast<uint32_t>(ShaderStages.size());
     pipeline_info.pStages = ShaderStages.data();
@@ -52,12 +72,55 @@ std::expected<vk::Pipeline, vk::Result> PipelineBuilder::build_pipeline(const vk
     pipeline_info.pDynamicState = &dynamic_info;
     pipeline_info.layout = layout;
 
-    const auto [res, new_pipeline] = device.createGraphicsPipeline(VK_NULL_HANDLE, pipeline_info);
+    const vk::PipelineCache cache_handle = cache ? cache->get_handle() : nullptr;
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto [res, new_pipeline] = device.createGraphicsPipeline(cache_handle, pipeline_info);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (res != vk::Result::eSuccess) {
+        return std::unexpected(res);
+    }
+
+    if (cache) {
+        cache->record_creation(creation_feedback, elapsed.count());
+    }
+
+    return new_pipeline;
+}
+
+bool PipelineBuilder::is_compute() const
+{
+    return ShaderStages.size() == 1 && ShaderStages[0].stage == vk::ShaderStageFlagBits::eCompute;
+}
+
+std::expected<vk::Pipeline, vk::Result> PipelineBuilder::build_compute_pipeline(const vk::Device device, const vk::PipelineLayout layout, PipelineCache* cache) const
+{
+    vk::PipelineCreationFeedback creation_feedback {};
+    const vk::PipelineCreationFeedbackCreateInfo feedback_info {
+        &creation_feedback,
+        0, nullptr
+    };
+
+    vk::ComputePipelineCreateInfo pipeline_info;
+    pipeline_info.pNext = &feedback_info;
+    pipeline_info.stage = ShaderStages[0];
+    pipeline_info.layout = layout;
+
+    const vk::PipelineCache cache_handle = cache ? cache->get_handle() : nullptr;
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto [res, new_pipeline] = device.createComputePipeline(cache_handle, pipeline_info);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
 
     if (res != vk::Result::eSuccess) {
         return std::unexpected(res);
     }
 
+    if (cache) {
+        cache->record_creation(creation_feedback, elapsed.count());
+    }
+
     return new_pipeline;
 }
 
@@ -69,6 +132,28 @@ PipelineBuilder& PipelineBuilder::set_shaders(const vk::ShaderModule vertex_shad
     return *this;
 }
 
+PipelineBuilder& PipelineBuilder::set_compute_shader(const vk::ShaderModule compute_shader)
+{
+    ShaderStages.clear();
+    ShaderStages.emplace_back(VkInit::pipeline_shader_stage_create_info(vk::ShaderStageFlagBits::eCompute, compute_shader, "main"));
+    return *this;
+}
+
+PipelineBuilder& PipelineBuilder::set_shader_module(const size_t stage_index, const vk::ShaderModule shader)
+{
+    assert(stage_index < ShaderStages.size());
+    ShaderStages[stage_index].module = shader;
+    return *this;
+}
+
+PipelineBuilder& PipelineBuilder::set_vertex_input(const std::span<const vk::VertexInputBindingDescription> bindings,
+    const std::span<const vk::VertexInputAttributeDescription> attributes)
+{
+    VertexBindings.assign(bindings.begin(), bindings.end());
+    VertexAttributes.assign(attributes.begin(), attributes.end());
+    return *this;
+}
+
 PipelineBuilder& PipelineBuilder::set_input_topology(const vk::PrimitiveTopology topology)
 {
     InputAssembly.topology = topology;
@@ -142,4 +227,111 @@ PipelineBuilder& PipelineBuilder::disable_depth_test()
     return *this;
 }
 
+PipelineBuilder& PipelineBuilder::enable_depth_test(const bool depth_write_enable, const vk::CompareOp op)
+{
+    DepthStencil.depthTestEnable = vk::True;
+    DepthStencil.depthWriteEnable = depth_write_enable ? vk::True : vk::False;
+    DepthStencil.depthCompareOp = op;
+    DepthStencil.depthBoundsTestEnable = vk::False;
+    DepthStencil.stencilTestEnable = vk::False;
+    DepthStencil.front = vk::StencilOpState {};
+    DepthStencil.back = vk::StencilOpState {};
+    DepthStencil.minDepthBounds = 0.0f;
+    DepthStencil.maxDepthBounds = 1.0f;
+    return *this;
+}
+
+uint64_t PipelineBuilder::hash() const
+{
+    uint64_t seed = FNV_OFFSET_BASIS;
+
+    for (const auto& stage : ShaderStages) {
+        seed = hash_value(stage.stage, seed);
+        seed = hash_value(static_cast<VkShaderModule>(stage.module), seed);
+        seed = fnv1a_64(stage.pName, std::strlen(stage.pName), seed);
+    }
+
+    seed = fnv1a_64(VertexBindings.data(), VertexBindings.size() * sizeof(vk::VertexInputBindingDescription), seed);
+    seed = fnv1a_64(VertexAttributes.data(), VertexAttributes.size() * sizeof(vk::VertexInputAttributeDescription), seed);
+
+    seed = hash_value(InputAssembly.topology, seed);
+    seed = hash_value(InputAssembly.primitiveRestartEnable, seed);
+
+    seed = hash_value(Rasterizer.depthClampEnable, seed);
+    seed = hash_value(Rasterizer.rasterizerDiscardEnable, seed);
+    seed = hash_value(Rasterizer.polygonMode, seed);
+    seed = hash_value(Rasterizer.cullMode, seed);
+    seed = hash_value(Rasterizer.frontFace, seed);
+    seed = hash_value(Rasterizer.depthBiasEnable, seed);
+    seed = hash_value(Rasterizer.depthBiasConstantFactor, seed);
+    seed = hash_value(Rasterizer.depthBiasClamp, seed);
+    seed = hash_value(Rasterizer.depthBiasSlopeFactor, seed);
+    seed = hash_value(Rasterizer.lineWidth, seed);
+
+    seed = hash_value(ColorBlendAttachment, seed);
+
+    seed = hash_value(Multisampling.rasterizationSamples, seed);
+    seed = hash_value(Multisampling.sampleShadingEnable, seed);
+    seed = hash_value(Multisampling.minSampleShading, seed);
+    seed = hash_value(Multisampling.alphaToCoverageEnable, seed);
+    seed = hash_value(Multisampling.alphaToOneEnable, seed);
+
+    seed = hash_value(DepthStencil.depthTestEnable, seed);
+    seed = hash_value(DepthStencil.depthWriteEnable, seed);
+    seed = hash_value(DepthStencil.depthCompareOp, seed);
+    seed = hash_value(DepthStencil.depthBoundsTestEnable, seed);
+    seed = hash_value(DepthStencil.stencilTestEnable, seed);
+    seed = hash_value(DepthStencil.front, seed);
+    seed = hash_value(DepthStencil.back, seed);
+    seed = hash_value(DepthStencil.minDepthBounds, seed);
+    seed = hash_value(DepthStencil.maxDepthBounds, seed);
+
+    seed = hash_value(RenderInfo.colorAttachmentCount, seed);
+    seed = hash_value(ColorAttachmentFormat, seed);
+    seed = hash_value(RenderInfo.depthAttachmentFormat, seed);
+    seed = hash_value(RenderInfo.stencilAttachmentFormat, seed);
+
+    return seed;
+}
+
+bool PipelineBuilder::has_same_state(const PipelineBuilder& other) const
+{
+    const bool same_stages = std::ranges::equal(ShaderStages, other.ShaderStages, [](const auto& a, const auto& b) {
+        return a.stage == b.stage && a.module == b.module && std::strcmp(a.pName, b.pName) == 0;
+    });
+
+    const auto same_rasterizer = [](const auto& a, const auto& b) {
+        return a.depthClampEnable == b.depthClampEnable && a.rasterizerDiscardEnable == b.rasterizerDiscardEnable && a.polygonMode == b.polygonMode
+            && a.cullMode == b.cullMode && a.frontFace == b.frontFace && a.depthBiasEnable == b.depthBiasEnable
+            && a.depthBiasConstantFactor == b.depthBiasConstantFactor && a.depthBiasClamp == b.depthBiasClamp
+            && a.depthBiasSlopeFactor == b.depthBiasSlopeFactor && a.lineWidth == b.lineWidth;
+    };
+
+    const auto same_multisampling = [](const auto& a, const auto& b) {
+        return a.rasterizationSamples == b.rasterizationSamples && a.sampleShadingEnable == b.sampleShadingEnable
+            && a.minSampleShading == b.minSampleShading && a.alphaToCoverageEnable == b.alphaToCoverageEnable && a.alphaToOneEnable == b.alphaToOneEnable;
+    };
+
+    const auto same_depth_stencil = [](const auto& a, const auto& b) {
+        return a.depthTestEnable == b.depthTestEnable && a.depthWriteEnable == b.depthWriteEnable && a.depthCompareOp == b.depthCompareOp
+            && a.depthBoundsTestEnable == b.depthBoundsTestEnable && a.stencilTestEnable == b.stencilTestEnable && a.front == b.front && a.back == b.back
+            && a.minDepthBounds == b.minDepthBounds && a.maxDepthBounds == b.maxDepthBounds;
+    };
+
+    // The create infos hold pointers into their own builder, only the values behind them are compared
+    return same_stages
+        && std::ranges::equal(VertexBindings, other.VertexBindings)
+        && std::ranges::equal(VertexAttributes, other.VertexAttributes)
+        && InputAssembly.topology == other.InputAssembly.topology
+        && InputAssembly.primitiveRestartEnable == other.InputAssembly.primitiveRestartEnable
+        && same_rasterizer(Rasterizer, other.Rasterizer)
+        && ColorBlendAttachment == other.ColorBlendAttachment
+        && same_multisampling(Multisampling, other.Multisampling)
+        && same_depth_stencil(DepthStencil, other.DepthStencil)
+        && RenderInfo.colorAttachmentCount == other.RenderInfo.colorAttachmentCount
+        && ColorAttachmentFormat == other.ColorAttachmentFormat
+        && RenderInfo.depthAttachmentFormat == other.RenderInfo.depthAttachmentFormat
+        && RenderInfo.stencilAttachmentFormat == other.RenderInfo.stencilAttachmentFormat;
+}
+
 }
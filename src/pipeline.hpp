@@ -2,13 +2,20 @@
 
 namespace Minecraft::VkEngine {
 
+class PipelineCache;
+
 class PipelineBuilder {
 
 public:
   PipelineBuilder(){ clear(); }
 
-  std::expected<vk::Pipeline, vk::Result> build_pipeline(vk::Device device, vk::PipelineLayout layout);
+  std::expected<vk::Pipeline, vk::Result> build_pipeline(vk::Device device, vk::PipelineLayout layout, PipelineCache* cache = nullptr);
   PipelineBuilder& set_shaders(vk::ShaderModule vertex_shader, vk::ShaderModule fragment_shader);
+  // Makes it a compute pipeline, the fixed function state is then ignored
+  PipelineBuilder& set_compute_shader(vk::ShaderModule compute_shader);
+  PipelineBuilder& set_shader_module(size_t stage_index, vk::ShaderModule shader);
+  // Leave empty for vertex pulling, the shader then fetches vertices itself
+  PipelineBuilder& set_vertex_input(std::span<const vk::VertexInputBindingDescription> bindings, std::span<const vk::VertexInputAttributeDescription> attributes);
   PipelineBuilder& set_input_topology(vk::PrimitiveTopology topology);
   PipelineBuilder& set_polygon_mode(vk::PolygonMode mode);
   PipelineBuilder& set_cull_mode(vk::CullModeFlags cull_mode, vk::FrontFace front_face);
@@ -17,9 +24,17 @@ public:
   PipelineBuilder& set_color_attachment_format(vk::Format format);
   PipelineBuilder& set_depth_format(vk::Format format);
   PipelineBuilder& disable_depth_test();
+  PipelineBuilder& enable_depth_test(bool depth_write_enable, vk::CompareOp op);
+
+  // Covers every state that ends up in the pipeline, two builders with the same hash build the same pipeline
+  [[nodiscard]] uint64_t hash() const;
+  // Compares what hash() covers, settles a hash match
+  [[nodiscard]] bool has_same_state(const PipelineBuilder& other) const;
 
 private:
   std::vector<vk::PipelineShaderStageCreateInfo> ShaderStages{};
+  std::vector<vk::VertexInputBindingDescription> VertexBindings{};
+  std::vector<vk::VertexInputAttributeDescription> VertexAttributes{};
 
   vk::PipelineInputAssemblyStateCreateInfo InputAssembly;
   vk::PipelineRasterizationStateCreateInfo Rasterizer;
@@ -30,6 +45,8 @@ private:
   vk::Format ColorAttachmentFormat {};
 
   void clear();
+  [[nodiscard]] bool is_compute() const;
+  std::expected<vk::Pipeline, vk::Result> build_compute_pipeline(vk::Device device, vk::PipelineLayout layout, PipelineCache* cache) const;
 };
 
 }
\ No newline at end of file
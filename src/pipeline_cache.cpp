@@ -0,0 +1,166 @@
+#include "pipeline_cache.hpp"
+#include "hash.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+vk::Result PipelineCache::init(const vk::Device device, const vk::PhysicalDevice physical_device, const std::filesystem::path& path)
+{
+    m_Device = device;
+    m_Path = path;
+
+    const auto properties_chain = physical_device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+    const vk::PhysicalDeviceProperties& properties = properties_chain.get<vk::PhysicalDeviceProperties2>().properties;
+    const vk::PhysicalDeviceIDProperties& id_properties = properties_chain.get<vk::PhysicalDeviceIDProperties>();
+
+    m_Identity.Magic = FILE_MAGIC;
+    m_Identity.Version = FILE_VERSION;
+    m_Identity.VendorID = properties.vendorID;
+    m_Identity.DeviceID = properties.deviceID;
+    m_Identity.DriverVersion = properties.driverVersion;
+    std::memcpy(m_Identity.PipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+    std::memcpy(m_Identity.DeviceUUID, id_properties.deviceUUID.data(), VK_UUID_SIZE);
+
+    const std::vector<uint8_t> initial_data = load_file();
+    m_Loaded = !initial_data.empty();
+
+    const vk::PipelineCacheCreateInfo info {
+        {},
+        initial_data.size(),
+        initial_data.data()
+    };
+
+    const auto [res, cache] = m_Device.createPipelineCache(info);
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    m_Handle = cache;
+    LOG("Pipeline cache {} ({} bytes)", m_Loaded ? "loaded from disk" : "starting cold", initial_data.size());
+    return vk::Result::eSuccess;
+}
+
+void PipelineCache::destroy()
+{
+    if (m_Handle) {
+        m_Device.destroyPipelineCache(m_Handle);
+        m_Handle = nullptr;
+    }
+}
+
+std::vector<uint8_t> PipelineCache::load_file() const
+{
+    std::ifstream file(m_Path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return {};
+    }
+
+    const std::streamsize file_size = file.tellg();
+    if (file_size < static_cast<std::streamsize>(sizeof(FileHeader))) {
+        return {};
+    }
+
+    FileHeader header {};
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+
+    const bool same_device = header.Magic == m_Identity.Magic
+        && header.Version == m_Identity.Version
+        && header.VendorID == m_Identity.VendorID
+        && header.DeviceID == m_Identity.DeviceID
+        && header.DriverVersion == m_Identity.DriverVersion
+        && std::memcmp(header.PipelineCacheUUID, m_Identity.PipelineCacheUUID, VK_UUID_SIZE) == 0
+        && std::memcmp(header.DeviceUUID, m_Identity.DeviceUUID, VK_UUID_SIZE) == 0;
+
+    if (!same_device) {
+        LOG("Pipeline cache {} was created by another device or driver, ignoring it", m_Path.string());
+        return {};
+    }
+
+    if (header.DataSize != static_cast<uint64_t>(file_size) - sizeof(FileHeader)) {
+        LOG_ERROR("Pipeline cache {} is truncated, ignoring it", m_Path.string());
+        return {};
+    }
+
+    std::vector<uint8_t> data(header.DataSize);
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    if (fnv1a_64(data.data(), data.size()) != header.DataHash) {
+        LOG_ERROR("Pipeline cache {} is corrupted, ignoring it", m_Path.string());
+        return {};
+    }
+
+    return data;
+}
+
+bool PipelineCache::save() const
+{
+    if (!m_Handle) {
+        return false;
+    }
+
+    const auto [res, data] = m_Device.getPipelineCacheData(m_Handle);
+    if (res != vk::Result::eSuccess) {
+        LOG_ERROR("Failed to retrieve pipeline cache data: {}", vk::to_string(res));
+        return false;
+    }
+
+    FileHeader header = m_Identity;
+    header.DataSize = data.size();
+    header.DataHash = fnv1a_64(data.data(), data.size());
+
+    // Write aside and swap so a crash mid-write never leaves a half cache behind
+    std::filesystem::path tmp_path = m_Path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_ERROR("Unable to open pipeline cache file: {}", tmp_path.string());
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file.good()) {
+            LOG_ERROR("Failed to write pipeline cache file: {}", tmp_path.string());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, m_Path, ec);
+    if (ec) {
+        LOG_ERROR("Failed to replace pipeline cache file {}: {}", m_Path.string(), ec.message());
+        return false;
+    }
+
+    LOG("Pipeline cache saved ({} bytes)", data.size());
+    return true;
+}
+
+void PipelineCache::record_creation(const vk::PipelineCreationFeedback& feedback, const double elapsed_ms)
+{
+    // Without valid feedback the best guess is whether we started from a disk cache
+    const bool hit = feedback.flags & vk::PipelineCreationFeedbackFlagBits::eValid
+        ? static_cast<bool>(feedback.flags & vk::PipelineCreationFeedbackFlagBits::eApplicationPipelineCacheHit)
+        : m_Loaded;
+
+    std::scoped_lock lock { m_StatsMutex };
+    CreationStats& stats = hit ? m_Hits : m_Misses;
+    stats.Count++;
+    stats.TotalMs += elapsed_ms;
+}
+
+std::string PipelineCache::summary() const
+{
+    std::scoped_lock lock { m_StatsMutex };
+    const auto average = [](const CreationStats& stats) {
+        return stats.Count > 0 ? stats.TotalMs / stats.Count : 0.0;
+    };
+
+    return fmt::format("Pipeline cache: {} hits avg {:.3f}ms, {} cold compiles avg {:.3f}ms",
+        m_Hits.Count, average(m_Hits),
+        m_Misses.Count, average(m_Misses));
+}
+
+}
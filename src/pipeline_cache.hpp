@@ -0,0 +1,56 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+/*
+ * VkPipelineCache persisted on disk between runs.
+ * The file starts with our own header so a cache produced by another GPU or driver is thrown away
+ * before it reaches the driver. Creation feedback is collected to compare cache hits with cold compiles.
+ */
+class PipelineCache {
+public:
+    [[nodiscard]] vk::Result init(vk::Device device, vk::PhysicalDevice physical_device, const std::filesystem::path& path);
+    void destroy();
+    [[nodiscard]] bool save() const;
+
+    [[nodiscard]] vk::PipelineCache get_handle() const { return m_Handle; }
+    [[nodiscard]] bool was_loaded() const { return m_Loaded; }
+
+    void record_creation(const vk::PipelineCreationFeedback& feedback, double elapsed_ms);
+    [[nodiscard]] std::string summary() const;
+
+private:
+    struct FileHeader {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t VendorID;
+        uint32_t DeviceID;
+        uint32_t DriverVersion;
+        uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+        uint8_t DeviceUUID[VK_UUID_SIZE];
+        uint64_t DataSize;
+        uint64_t DataHash;
+    };
+
+    static constexpr uint32_t FILE_MAGIC = 0x4350564c; // "LVPC"
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    vk::Device m_Device { nullptr };
+    vk::PipelineCache m_Handle { nullptr };
+    std::filesystem::path m_Path;
+    FileHeader m_Identity {};
+    bool m_Loaded { false };
+
+    struct CreationStats {
+        uint32_t Count { 0 };
+        double TotalMs { 0.0 };
+    };
+    // Pipelines are built from worker threads
+    mutable std::mutex m_StatsMutex;
+    CreationStats m_Hits {};
+    CreationStats m_Misses {};
+
+    [[nodiscard]] std::vector<uint8_t> load_file() const;
+};
+
+}
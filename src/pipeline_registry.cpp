@@ -0,0 +1,303 @@
+#include "pipeline_registry.hpp"
+#include "cpu_profiler.hpp"
+#include "deferred_deleter.hpp"
+#include "hash.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+void PipelineRegistry::init(const vk::Device device, PipelineCache* cache, uint32_t worker_count)
+{
+    m_Device = device;
+    m_Cache = cache;
+    m_Stopping = false;
+
+    // Leave a core to the main thread, pipelines compile while it keeps going
+    if (worker_count == 0) {
+        worker_count = std::clamp(std::thread::hardware_concurrency(), 2u, 9u) - 1;
+    }
+
+    for (uint32_t i = 0; i < worker_count; i++) {
+        m_Workers.emplace_back(&PipelineRegistry::worker_loop, this);
+    }
+}
+
+void PipelineRegistry::destroy()
+{
+    {
+        std::scoped_lock lock { m_Mutex };
+        m_Stopping = true;
+        m_Queue.clear();
+    }
+    m_WorkAvailable.notify_all();
+
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+    m_Workers.clear();
+
+    for (const auto& entry : m_Entries) {
+        if (entry->Pipeline) {
+            m_Device.destroyPipeline(entry->Pipeline);
+        }
+    }
+
+    for (const auto pipeline : m_Replaced) {
+        m_Device.destroyPipeline(pipeline);
+    }
+
+    m_Entries.clear();
+    m_EntriesByHash.clear();
+    m_Replaced.clear();
+}
+
+static uint64_t request_hash(const PipelineBuilder& builder, const vk::PipelineLayout layout)
+{
+    return hash_combine(builder.hash(), hash_value(static_cast<VkPipelineLayout>(layout)));
+}
+
+PipelineHandle PipelineRegistry::request(const PipelineBuilder& builder, const vk::PipelineLayout layout, const std::span<const ShaderHandle> shaders)
+{
+    const uint64_t hash = request_hash(builder, layout);
+
+    std::unique_lock lock { m_Mutex };
+
+    // The hash only picks the bucket, a collision with a different pipeline gets its own entry
+    const auto [first, last] = m_EntriesByHash.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        const Entry& existing = *m_Entries[it->second];
+        if (existing.Layout == layout && existing.Builder.has_same_state(builder)) {
+            return PipelineHandle { it->second };
+        }
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->Hash = hash;
+    entry->Builder = builder;
+    entry->Layout = layout;
+    entry->Shaders.assign(shaders.begin(), shaders.end());
+    entry->Queued = true;
+
+    const auto index = static_cast<uint32_t>(m_Entries.size());
+    m_Queue.push_back(entry.get());
+    m_Entries.push_back(std::move(entry));
+    m_EntriesByHash.emplace(hash, index);
+
+    if (m_Workers.empty()) {
+        // No pool, compile right away on the calling thread
+        PendingCompile pending = dequeue();
+        lock.unlock();
+        compile(pending);
+        return PipelineHandle { index };
+    }
+
+    lock.unlock();
+    m_WorkAvailable.notify_one();
+    return PipelineHandle { index };
+}
+
+PipelineRegistry::Entry* PipelineRegistry::find_entry(const PipelineHandle handle) const
+{
+    std::scoped_lock lock { m_Mutex };
+    if (!handle.is_valid() || handle.Index >= m_Entries.size()) {
+        return nullptr;
+    }
+    return m_Entries[handle.Index].get();
+}
+
+PipelineStatus PipelineRegistry::status(const PipelineHandle handle) const
+{
+    const Entry* entry = find_entry(handle);
+    return entry ? entry->Status.load(std::memory_order_acquire) : PipelineStatus::eFailed;
+}
+
+PipelineBundle PipelineRegistry::get(const PipelineHandle handle) const
+{
+    std::scoped_lock lock { m_Mutex };
+    if (!handle.is_valid() || handle.Index >= m_Entries.size()) {
+        return {};
+    }
+
+    const Entry& entry = *m_Entries[handle.Index];
+    if (entry.Status.load(std::memory_order_acquire) != PipelineStatus::eReady) {
+        return {};
+    }
+
+    return PipelineBundle { entry.Pipeline, entry.Layout };
+}
+
+bool PipelineRegistry::wait(const PipelineHandle handle) const
+{
+    const Entry* entry = find_entry(handle);
+    if (!entry) {
+        return false;
+    }
+
+    std::unique_lock lock { m_Mutex };
+    m_WorkDone.wait(lock, [&] {
+        return entry->Status.load(std::memory_order_acquire) != PipelineStatus::ePending;
+    });
+
+    return entry->Status.load(std::memory_order_acquire) == PipelineStatus::eReady;
+}
+
+bool PipelineRegistry::wait_all() const
+{
+    std::unique_lock lock { m_Mutex };
+    m_WorkDone.wait(lock, [&] {
+        return m_Queue.empty() && m_InFlight == 0;
+    });
+
+    return std::ranges::all_of(m_Entries, [](const auto& entry) {
+        return entry->Status.load(std::memory_order_acquire) == PipelineStatus::eReady;
+    });
+}
+
+bool PipelineRegistry::is_idle() const
+{
+    std::scoped_lock lock { m_Mutex };
+    return m_Queue.empty() && m_InFlight == 0;
+}
+
+size_t PipelineRegistry::get_pipeline_count() const
+{
+    std::scoped_lock lock { m_Mutex };
+    return m_Entries.size();
+}
+
+uint32_t PipelineRegistry::reload(const std::span<const ShaderHandle> changed, const ShaderLibrary& library)
+{
+    uint32_t queued = 0;
+    {
+        std::scoped_lock lock { m_Mutex };
+
+        for (uint32_t index = 0; index < m_Entries.size(); index++) {
+            Entry& entry = *m_Entries[index];
+
+            const bool depends = std::ranges::any_of(entry.Shaders, [&](const ShaderHandle shader) {
+                return std::ranges::find(changed, shader) != changed.end();
+            });
+
+            if (!depends) {
+                continue;
+            }
+
+            for (size_t stage = 0; stage < entry.Shaders.size(); stage++) {
+                entry.Builder.set_shader_module(stage, library.get_module(entry.Shaders[stage]));
+            }
+
+            // Only this entry's slot, another one may share the old or the new hash
+            const auto [first, last] = m_EntriesByHash.equal_range(entry.Hash);
+            for (auto it = first; it != last; ++it) {
+                if (it->second == index) {
+                    m_EntriesByHash.erase(it);
+                    break;
+                }
+            }
+            entry.Hash = request_hash(entry.Builder, entry.Layout);
+            m_EntriesByHash.emplace(entry.Hash, index);
+
+            // A compile already running for this entry now builds a stale pipeline, queue a new one regardless
+            entry.Generation++;
+            if (!entry.Queued) {
+                entry.Queued = true;
+                m_Queue.push_back(&entry);
+            }
+            queued++;
+        }
+    }
+
+    if (queued > 0) {
+        if (m_Workers.empty()) {
+            std::unique_lock lock { m_Mutex };
+            while (!m_Queue.empty()) {
+                PendingCompile pending = dequeue();
+                lock.unlock();
+                compile(pending);
+                lock.lock();
+            }
+        } else {
+            m_WorkAvailable.notify_all();
+        }
+    }
+
+    return queued;
+}
+
+void PipelineRegistry::collect_retired(DeferredDeleter& deleter)
+{
+    std::vector<vk::Pipeline> replaced;
+    {
+        std::scoped_lock lock { m_Mutex };
+        std::swap(replaced, m_Replaced);
+    }
+
+    // Swapped out before this frame records, the ones in flight were the last to bind them
+    for (const auto pipeline : replaced) {
+        deleter.push(pipeline);
+    }
+}
+
+PipelineRegistry::PendingCompile PipelineRegistry::dequeue()
+{
+    Entry* entry = m_Queue.front();
+    m_Queue.pop_front();
+    entry->Queued = false;
+    m_InFlight++;
+
+    // Copy under the lock, reload() may rewrite the builder while we compile
+    return PendingCompile { entry, entry->Builder, entry->Generation };
+}
+
+void PipelineRegistry::compile(PendingCompile& pending)
+{
+    CPU_ZONE("Compile Pipeline");
+    Entry& entry = *pending.Target;
+    const auto result = pending.Builder.build_pipeline(m_Device, entry.Layout, m_Cache);
+
+    {
+        std::scoped_lock lock { m_Mutex };
+        m_InFlight--;
+
+        if (pending.Generation != entry.Generation) {
+            // Overtaken by a reload, the compile queued since then owns the entry
+            if (result.has_value()) {
+                m_Replaced.push_back(result.value());
+            }
+        } else if (result.has_value()) {
+            if (entry.Pipeline) {
+                m_Replaced.push_back(entry.Pipeline);
+            }
+            entry.Pipeline = result.value();
+            entry.Status.store(PipelineStatus::eReady, std::memory_order_release);
+        } else if (entry.Pipeline) {
+            LOG_ERROR("Failed to recompile pipeline {:016x}: {}, keeping the previous one", entry.Hash, vk::to_string(result.error()));
+        } else {
+            LOG_ERROR("Failed to compile pipeline {:016x}: {}", entry.Hash, vk::to_string(result.error()));
+            entry.Status.store(PipelineStatus::eFailed, std::memory_order_release);
+        }
+    }
+
+    m_WorkDone.notify_all();
+}
+
+void PipelineRegistry::worker_loop()
+{
+    CpuProfiler::set_thread_name("Pipeline Worker");
+
+    while (true) {
+        std::unique_lock lock { m_Mutex };
+        m_WorkAvailable.wait(lock, [&] { return m_Stopping || !m_Queue.empty(); });
+
+        if (m_Stopping) {
+            return;
+        }
+
+        PendingCompile pending = dequeue();
+        lock.unlock();
+
+        compile(pending);
+    }
+}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "pipeline.hpp"
+#include "shader_library.hpp"
+
+namespace Minecraft::VkEngine {
+
+class DeferredDeleter;
+class PipelineCache;
+
+enum class PipelineStatus {
+    ePending,
+    eReady,
+    eFailed
+};
+
+struct PipelineHandle {
+    uint32_t Index { UINT32_MAX };
+
+    [[nodiscard]] bool is_valid() const { return Index != UINT32_MAX; }
+};
+
+/*
+ * Owns every graphics and compute pipeline of the engine.
+ * Requests are looked up by the hash of the full PipelineBuilder state plus the layout, then compared state
+ * for state, asking twice for the same pipeline returns the same handle and compiles once. Compilation happens on a pool of worker
+ * threads, callers poll the handle or block on it when they cannot go on without the pipeline.
+ *
+ * Pipelines remember the shaders they were built from, reload() recompiles only the ones using a changed
+ * shader. The old pipeline stays bound until the new one is ready and is destroyed once the GPU is done with it.
+ */
+class PipelineRegistry {
+public:
+    void init(vk::Device device, PipelineCache* cache, uint32_t worker_count = 0);
+    void destroy();
+
+    // shaders must follow the stage order of the builder so they can be swapped on reload
+    [[nodiscard]] PipelineHandle request(const PipelineBuilder& builder, vk::PipelineLayout layout, std::span<const ShaderHandle> shaders = {});
+
+    [[nodiscard]] PipelineStatus status(PipelineHandle handle) const;
+    // Null handle while the pipeline is still compiling or failed to
+    [[nodiscard]] PipelineBundle get(PipelineHandle handle) const;
+
+    // Block until the pipeline is compiled, false if it failed
+    [[nodiscard]] bool wait(PipelineHandle handle) const;
+    [[nodiscard]] bool wait_all() const;
+    [[nodiscard]] bool is_idle() const;
+
+    // Returns how many pipelines were queued for recompilation
+    uint32_t reload(std::span<const ShaderHandle> changed, const ShaderLibrary& library);
+    // Main thread only, before recording. Hands the pipelines replaced by the workers to the DeferredDeleter
+    void collect_retired(DeferredDeleter& deleter);
+
+    [[nodiscard]] size_t get_pipeline_count() const;
+
+private:
+    struct Entry {
+        uint64_t Hash { 0 };
+        PipelineBuilder Builder;
+        vk::PipelineLayout Layout { nullptr };
+        std::vector<ShaderHandle> Shaders;
+        vk::Pipeline Pipeline { nullptr };
+        std::atomic<PipelineStatus> Status { PipelineStatus::ePending };
+        bool Queued { false };
+        // Bumped by reload(), a compile started before the last bump produces a stale pipeline
+        uint64_t Generation { 0 };
+    };
+
+    struct PendingCompile {
+        Entry* Target { nullptr };
+        PipelineBuilder Builder;
+        uint64_t Generation { 0 };
+    };
+
+    vk::Device m_Device { nullptr };
+    PipelineCache* m_Cache { nullptr };
+
+    mutable std::mutex m_Mutex;
+    mutable std::condition_variable m_WorkAvailable;
+    mutable std::condition_variable m_WorkDone;
+    std::vector<std::unique_ptr<Entry>> m_Entries;
+    // Several entries can share a hash, after a reload gives them the same shaders
+    std::unordered_multimap<uint64_t, uint32_t> m_EntriesByHash;
+    std::deque<Entry*> m_Queue;
+    uint32_t m_InFlight { 0 };
+    // Filled by the workers, the deleter is main thread only
+    std::vector<vk::Pipeline> m_Replaced;
+    bool m_Stopping { false };
+
+    std::vector<std::thread> m_Workers;
+
+    void worker_loop();
+    // Pops the front of the queue, m_Mutex must be held
+    [[nodiscard]] PendingCompile dequeue();
+    void compile(PendingCompile& pending);
+    [[nodiscard]] Entry* find_entry(PipelineHandle handle) const;
+};
+
+}
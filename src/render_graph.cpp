@@ -0,0 +1,537 @@
+#include "render_graph.hpp"
+#include "helper.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+static vk::ImageUsageFlags image_usage_flags(const ImageUsage usage)
+{
+    switch (usage) {
+    case ImageUsage::eClearDst:
+    case ImageUsage::eCopyDst:
+    case ImageUsage::eBlitDst:
+        return vk::ImageUsageFlagBits::eTransferDst;
+    case ImageUsage::eCopySrc:
+    case ImageUsage::eBlitSrc:
+        return vk::ImageUsageFlagBits::eTransferSrc;
+    case ImageUsage::eColorAttachment:
+        return vk::ImageUsageFlagBits::eColorAttachment;
+    case ImageUsage::eDepthAttachment:
+        return vk::ImageUsageFlagBits::eDepthStencilAttachment;
+    case ImageUsage::eComputeSampled:
+    case ImageUsage::eFragmentSampled:
+        return vk::ImageUsageFlagBits::eSampled;
+    case ImageUsage::eComputeStorageRead:
+    case ImageUsage::eComputeStorageWrite:
+    case ImageUsage::eComputeStorageReadWrite:
+        return vk::ImageUsageFlagBits::eStorage;
+    case ImageUsage::ePresent:
+        return {};
+    }
+
+    return {};
+}
+
+static bool is_attachment(const ImageUsage usage)
+{
+    return usage == ImageUsage::eColorAttachment || usage == ImageUsage::eDepthAttachment;
+}
+
+#pragma region Context
+
+vk::Image RenderGraphContext::image(const RenderGraphImage handle) const
+{
+    return m_Graph.m_Resources[handle.Index].Image;
+}
+
+vk::ImageView RenderGraphContext::view(const RenderGraphImage handle) const
+{
+    return m_Graph.m_Resources[handle.Index].View;
+}
+
+vk::Extent2D RenderGraphContext::extent(const RenderGraphImage handle) const
+{
+    return m_Graph.m_Resources[handle.Index].Extent;
+}
+
+vk::RenderingAttachmentInfo RenderGraphContext::attachment(const RenderGraphImage handle) const
+{
+    const RenderGraphPass& pass = m_Graph.m_Passes[m_Pass];
+    const auto it = std::ranges::find_if(pass.m_Writes, [&](const RenderGraphAccess& access) {
+        return access.Image.Index == handle.Index;
+    });
+    assert(it != pass.m_Writes.end() && "Attachment must be declared as a write of the pass");
+
+    vk::RenderingAttachmentInfo info {};
+    info.imageView = view(handle);
+    info.imageLayout = image_usage_state(it->Usage).Layout;
+    info.loadOp = it->LoadOp;
+    info.storeOp = it->StoreOp;
+
+    if (it->Clear.has_value()) {
+        info.clearValue = it->Clear.value();
+    }
+
+    return info;
+}
+
+#pragma endregion
+
+#pragma region Pass
+
+RenderGraphPass& RenderGraphPass::read(const RenderGraphImage image, const ImageUsage usage)
+{
+    m_Reads.push_back(RenderGraphAccess { image, usage });
+    return *this;
+}
+
+RenderGraphPass& RenderGraphPass::write(const RenderGraphImage image, const ImageUsage usage)
+{
+    m_Writes.push_back(RenderGraphAccess { image, usage });
+    return *this;
+}
+
+RenderGraphPass& RenderGraphPass::write(const RenderGraphImage image, const ImageUsage usage, const vk::ClearValue& clear)
+{
+    assert(is_attachment(usage) && "Only attachments can be cleared through their loadOp");
+    m_Writes.push_back(RenderGraphAccess { image, usage, clear });
+    return *this;
+}
+
+RenderGraphPass& RenderGraphPass::execute(RenderGraphExecute&& execute)
+{
+    m_Execute = std::move(execute);
+    return *this;
+}
+
+#pragma endregion
+
+#pragma region Setup
+
+void RenderGraph::init(const vk::Device device, const VmaAllocator allocator)
+{
+    m_Device = device;
+    m_Allocator = allocator;
+}
+
+void RenderGraph::destroy()
+{
+    release_transients();
+    m_Passes.clear();
+    m_Resources.clear();
+    m_Order.clear();
+}
+
+RenderGraphImage RenderGraph::import_image(const std::string& name, const vk::ImageAspectFlags aspect, const bool discard_each_frame)
+{
+    Resource resource {};
+    resource.Name = name;
+    resource.DiscardEachFrame = discard_each_frame;
+    resource.Desc.Aspect = aspect;
+
+    m_Resources.push_back(resource);
+    return RenderGraphImage { static_cast<uint32_t>(m_Resources.size() - 1) };
+}
+
+RenderGraphImage RenderGraph::create_transient(const std::string& name, const TransientImageDesc& desc)
+{
+    Resource resource {};
+    resource.Name = name;
+    resource.Transient = true;
+    resource.DiscardEachFrame = true;
+    resource.Desc = desc;
+    resource.Extent = desc.Extent;
+
+    m_Resources.push_back(resource);
+    return RenderGraphImage { static_cast<uint32_t>(m_Resources.size() - 1) };
+}
+
+RenderGraphPass& RenderGraph::add_pass(const std::string& name)
+{
+    return m_Passes.emplace_back(name);
+}
+
+void RenderGraph::set_final_usage(const RenderGraphImage image, const ImageUsage usage)
+{
+    m_Resources[image.Index].FinalUsage = usage;
+}
+
+void RenderGraph::bind_image(const RenderGraphImage handle, const vk::Image image, const vk::ImageView view, const vk::Extent2D extent)
+{
+    Resource& resource = m_Resources[handle.Index];
+    assert(!resource.Transient && "Transient images are owned by the graph");
+
+    resource.Image = image;
+    resource.View = view;
+    resource.Extent = extent;
+}
+
+#pragma endregion
+
+#pragma region Compile
+
+bool RenderGraph::compile()
+{
+    release_transients();
+
+    const std::vector<bool> live = cull_passes();
+    m_Order = sort_passes(live);
+    if (m_Order.empty()) {
+        LOG_ERROR("Render graph has no pass contributing to its outputs");
+        return false;
+    }
+
+    compute_lifetimes();
+    resolve_attachment_ops();
+
+    if (!allocate_transients()) {
+        LOG_ERROR("Failed to allocate render graph transient images");
+        return false;
+    }
+
+    LOG("Render graph compiled: {} of {} passes, {} transient images in {} KiB",
+        m_Order.size(), m_Passes.size(),
+        std::ranges::count_if(m_Resources, [](const Resource& r) { return r.Transient; }),
+        m_TransientMemorySize / 1024);
+    for (const uint32_t pass : m_Order) {
+        LOG("\t{}", m_Passes[pass].get_name());
+    }
+
+    return true;
+}
+
+std::vector<bool> RenderGraph::cull_passes() const
+{
+    // Imported images are visible outside of the graph, so are images with a final usage
+    std::vector<bool> needed_resource(m_Resources.size(), false);
+    for (size_t i = 0; i < m_Resources.size(); i++) {
+        needed_resource[i] = !m_Resources[i].Transient || m_Resources[i].FinalUsage.has_value();
+    }
+
+    std::vector<bool> live(m_Passes.size(), false);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t p = 0; p < m_Passes.size(); p++) {
+            if (live[p]) {
+                continue;
+            }
+
+            const bool contributes = std::ranges::any_of(m_Passes[p].m_Writes, [&](const RenderGraphAccess& access) {
+                return needed_resource[access.Image.Index];
+            });
+
+            if (!contributes) {
+                continue;
+            }
+
+            live[p] = true;
+            changed = true;
+            for (const auto& access : m_Passes[p].m_Reads) {
+                needed_resource[access.Image.Index] = true;
+            }
+        }
+    }
+
+    return live;
+}
+
+std::vector<uint32_t> RenderGraph::sort_passes(const std::vector<bool>& live) const
+{
+    const size_t pass_count = m_Passes.size();
+    std::vector<std::set<uint32_t>> successors(pass_count);
+    std::vector<uint32_t> in_degree(pass_count, 0);
+
+    const auto add_edge = [&](const uint32_t from, const uint32_t to) {
+        if (from != to && successors[from].insert(to).second) {
+            in_degree[to]++;
+        }
+    };
+
+    // Declaration order defines which version of a resource a pass sees
+    std::vector<std::optional<uint32_t>> last_writer(m_Resources.size());
+    std::vector<std::vector<uint32_t>> readers(m_Resources.size());
+
+    for (uint32_t p = 0; p < pass_count; p++) {
+        if (!live[p]) {
+            continue;
+        }
+
+        for (const auto& access : m_Passes[p].m_Reads) {
+            const uint32_t r = access.Image.Index;
+            if (last_writer[r].has_value()) {
+                add_edge(last_writer[r].value(), p); // read after write
+            }
+            readers[r].push_back(p);
+        }
+
+        for (const auto& access : m_Passes[p].m_Writes) {
+            const uint32_t r = access.Image.Index;
+            if (last_writer[r].has_value()) {
+                add_edge(last_writer[r].value(), p); // write after write
+            }
+            for (const uint32_t reader : readers[r]) {
+                add_edge(reader, p); // write after read
+            }
+            last_writer[r] = p;
+            readers[r].clear();
+        }
+    }
+
+    // Kahn, ties broken by declaration order so independent passes keep the order they were added in
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> ready;
+    for (uint32_t p = 0; p < pass_count; p++) {
+        if (live[p] && in_degree[p] == 0) {
+            ready.push(p);
+        }
+    }
+
+    std::vector<uint32_t> order;
+    while (!ready.empty()) {
+        const uint32_t p = ready.top();
+        ready.pop();
+        order.push_back(p);
+
+        for (const uint32_t next : successors[p]) {
+            if (--in_degree[next] == 0) {
+                ready.push(next);
+            }
+        }
+    }
+
+    return order;
+}
+
+void RenderGraph::compute_lifetimes()
+{
+    for (auto& resource : m_Resources) {
+        resource.FirstUse = UINT32_MAX;
+        resource.LastUse = 0;
+        resource.UsageFlags = {};
+    }
+
+    for (uint32_t i = 0; i < m_Order.size(); i++) {
+        const RenderGraphPass& pass = m_Passes[m_Order[i]];
+        for (const auto* accesses : { &pass.m_Reads, &pass.m_Writes }) {
+            for (const auto& access : *accesses) {
+                Resource& resource = m_Resources[access.Image.Index];
+                resource.FirstUse = std::min(resource.FirstUse, i);
+                resource.LastUse = std::max(resource.LastUse, i);
+                resource.UsageFlags |= image_usage_flags(access.Usage);
+            }
+        }
+    }
+
+    for (auto& resource : m_Resources) {
+        if (resource.FinalUsage.has_value()) {
+            resource.LastUse = static_cast<uint32_t>(m_Order.size());
+            resource.UsageFlags |= image_usage_flags(resource.FinalUsage.value());
+        }
+    }
+}
+
+void RenderGraph::resolve_attachment_ops()
+{
+    for (uint32_t i = 0; i < m_Order.size(); i++) {
+        RenderGraphPass& pass = m_Passes[m_Order[i]];
+
+        for (auto& access : pass.m_Writes) {
+            const Resource& resource = m_Resources[access.Image.Index];
+            const bool read_in_pass = std::ranges::any_of(pass.m_Reads, [&](const RenderGraphAccess& read) {
+                return read.Image.Index == access.Image.Index;
+            });
+
+            if (access.Clear.has_value()) {
+                access.LoadOp = vk::AttachmentLoadOp::eClear;
+            } else if (resource.DiscardEachFrame && resource.FirstUse == i && !read_in_pass) {
+                access.LoadOp = vk::AttachmentLoadOp::eDontCare;
+            } else {
+                access.LoadOp = vk::AttachmentLoadOp::eLoad;
+            }
+
+            // Transient content nobody reads afterward never has to reach memory
+            const bool read_later = !resource.Transient || resource.LastUse > i;
+            access.StoreOp = read_later ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare;
+        }
+    }
+}
+
+bool RenderGraph::allocate_transients()
+{
+    std::vector<uint32_t> transients;
+    for (uint32_t r = 0; r < m_Resources.size(); r++) {
+        Resource& resource = m_Resources[r];
+        if (!resource.Transient || resource.FirstUse == UINT32_MAX) {
+            continue;
+        }
+
+        const vk::ImageCreateInfo image_info = VkInit::image_create_info(resource.Desc.Format, resource.UsageFlags,
+            vk::Extent3D { resource.Desc.Extent.width, resource.Desc.Extent.height, 1 });
+
+        const auto [res, image] = m_Device.createImage(image_info);
+        if (res != vk::Result::eSuccess) {
+            LOG_ERROR("Failed to create transient image {}: {}", resource.Name, vk::to_string(res));
+            return false;
+        }
+
+        resource.Image = image;
+        transients.push_back(r);
+    }
+
+    // Biggest first so smaller images fill the holes left in the blocks
+    std::ranges::sort(transients, std::greater<>(), [&](const uint32_t r) {
+        return m_Device.getImageMemoryRequirements(m_Resources[r].Image).size;
+    });
+
+    for (const uint32_t r : transients) {
+        Resource& resource = m_Resources[r];
+        const vk::MemoryRequirements requirements = m_Device.getImageMemoryRequirements(resource.Image);
+
+        const auto overlaps = [&](const uint32_t other) {
+            const Resource& o = m_Resources[other];
+            return resource.FirstUse <= o.LastUse && o.FirstUse <= resource.LastUse;
+        };
+
+        const auto block = std::ranges::find_if(m_MemoryBlocks, [&](const MemoryBlock& b) {
+            return (b.Requirements.memoryTypeBits & requirements.memoryTypeBits) != 0
+                && std::ranges::none_of(b.Resources, overlaps);
+        });
+
+        if (block == m_MemoryBlocks.end()) {
+            m_MemoryBlocks.push_back(MemoryBlock { nullptr, requirements, { r } });
+        } else {
+            block->Requirements.size = std::max(block->Requirements.size, requirements.size);
+            block->Requirements.alignment = std::max(block->Requirements.alignment, requirements.alignment);
+            block->Requirements.memoryTypeBits &= requirements.memoryTypeBits;
+            block->Resources.push_back(r);
+        }
+    }
+
+    VmaAllocationCreateInfo alloc_info = {};
+    alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    alloc_info.requiredFlags = static_cast<VkMemoryPropertyFlags>(vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    m_TransientMemorySize = 0;
+    for (uint32_t b = 0; b < m_MemoryBlocks.size(); b++) {
+        MemoryBlock& block = m_MemoryBlocks[b];
+        const VkMemoryRequirements requirements = block.Requirements;
+
+        if (vmaAllocateMemory(m_Allocator, &requirements, &alloc_info, &block.Allocation, nullptr) != VK_SUCCESS) {
+            return false;
+        }
+        m_TransientMemorySize += block.Requirements.size;
+
+        for (const uint32_t r : block.Resources) {
+            Resource& resource = m_Resources[r];
+            resource.MemoryBlock = b;
+
+            if (vmaBindImageMemory(m_Allocator, block.Allocation, resource.Image) != VK_SUCCESS) {
+                return false;
+            }
+
+            const vk::ImageViewCreateInfo view_info = VkInit::imageview_create_info(resource.Desc.Format, resource.Image, resource.Desc.Aspect);
+            const auto [res, view] = m_Device.createImageView(view_info);
+            if (res != vk::Result::eSuccess) {
+                return false;
+            }
+            resource.View = view;
+        }
+    }
+
+    return true;
+}
+
+void RenderGraph::release_transients()
+{
+    for (auto& resource : m_Resources) {
+        if (!resource.Transient) {
+            continue;
+        }
+
+        if (resource.View) {
+            m_Device.destroyImageView(resource.View);
+        }
+        if (resource.Image) {
+            m_Device.destroyImage(resource.Image);
+        }
+
+        resource.View = nullptr;
+        resource.Image = nullptr;
+        resource.MemoryBlock.reset();
+    }
+
+    for (const auto& block : m_MemoryBlocks) {
+        vmaFreeMemory(m_Allocator, block.Allocation);
+    }
+
+    m_MemoryBlocks.clear();
+    m_TransientMemorySize = 0;
+}
+
+#pragma endregion
+
+#pragma region Execute
+
+void RenderGraph::begin_resource_use(const uint32_t index, ImageStateTracker& tracker)
+{
+    Resource& resource = m_Resources[index];
+
+    if (!resource.MemoryBlock.has_value()) {
+        if (resource.DiscardEachFrame) {
+            tracker.discard(resource.Image);
+        }
+        return;
+    }
+
+    // Aliased memory: wait for whoever used it last, then start from undefined content
+    MemoryBlock& block = m_MemoryBlocks[resource.MemoryBlock.value()];
+    ImageState previous {};
+    if (block.LastUser.has_value()) {
+        previous = tracker.get_state(m_Resources[block.LastUser.value()].Image);
+    }
+
+    tracker.track(resource.Image, resource.Desc.Aspect,
+        ImageState { vk::ImageLayout::eUndefined, previous.Stage, previous.Access });
+    block.LastUser = index;
+}
+
+void RenderGraph::execute(const vk::CommandBuffer cmd, ImageStateTracker& tracker, GpuProfiler* profiler)
+{
+    for (uint32_t i = 0; i < m_Order.size(); i++) {
+        const uint32_t pass_index = m_Order[i];
+        const RenderGraphPass& pass = m_Passes[pass_index];
+
+        for (const auto* accesses : { &pass.m_Reads, &pass.m_Writes }) {
+            for (const auto& access : *accesses) {
+                if (m_Resources[access.Image.Index].FirstUse == i) {
+                    begin_resource_use(access.Image.Index, tracker);
+                }
+            }
+        }
+
+        // Shared by the reads and writes of the pass, the tracker skips redundant transitions
+        for (const auto* accesses : { &pass.m_Reads, &pass.m_Writes }) {
+            for (const auto& access : *accesses) {
+                tracker.transition(m_Resources[access.Image.Index].Image, access.Usage);
+            }
+        }
+
+        GpuProfiler::Scope scope { profiler, cmd, pass.get_name().c_str() };
+        tracker.flush(cmd);
+
+        if (pass.m_Execute) {
+            pass.m_Execute(cmd, RenderGraphContext { *this, pass_index });
+        }
+    }
+
+    for (const auto& resource : m_Resources) {
+        if (resource.FinalUsage.has_value() && resource.FirstUse != UINT32_MAX) {
+            tracker.transition(resource.Image, resource.FinalUsage.value());
+        }
+    }
+    tracker.flush(cmd);
+}
+
+#pragma endregion
+
+}
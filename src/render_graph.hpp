@@ -0,0 +1,157 @@
+#pragma once
+
+#include "gpu_profiler.hpp"
+#include "image_state_tracker.hpp"
+
+namespace Minecraft::VkEngine {
+
+struct RenderGraphImage {
+    uint32_t Index { UINT32_MAX };
+
+    [[nodiscard]] bool is_valid() const { return Index != UINT32_MAX; }
+};
+
+struct TransientImageDesc {
+    vk::Format Format { vk::Format::eUndefined };
+    vk::Extent2D Extent {};
+    vk::ImageAspectFlags Aspect { vk::ImageAspectFlagBits::eColor };
+};
+
+struct RenderGraphAccess {
+    RenderGraphImage Image {};
+    ImageUsage Usage {};
+    std::optional<vk::ClearValue> Clear {};
+
+    // Resolved by RenderGraph::compile
+    vk::AttachmentLoadOp LoadOp { vk::AttachmentLoadOp::eLoad };
+    vk::AttachmentStoreOp StoreOp { vk::AttachmentStoreOp::eStore };
+};
+
+class RenderGraph;
+
+// What a pass sees of the graph while recording
+class RenderGraphContext {
+public:
+    RenderGraphContext(const RenderGraph& graph, const uint32_t pass)
+        : m_Graph(graph)
+        , m_Pass(pass)
+    {
+    }
+
+    [[nodiscard]] vk::Image image(RenderGraphImage handle) const;
+    [[nodiscard]] vk::ImageView view(RenderGraphImage handle) const;
+    [[nodiscard]] vk::Extent2D extent(RenderGraphImage handle) const;
+
+    // Attachment info for an image the pass writes, load/store ops already resolved by the graph
+    [[nodiscard]] vk::RenderingAttachmentInfo attachment(RenderGraphImage handle) const;
+
+private:
+    const RenderGraph& m_Graph;
+    uint32_t m_Pass;
+};
+
+using RenderGraphExecute = std::function<void(vk::CommandBuffer, const RenderGraphContext&)>;
+
+class RenderGraphPass {
+public:
+    explicit RenderGraphPass(std::string name)
+        : m_Name(std::move(name))
+    {
+    }
+
+    RenderGraphPass& read(RenderGraphImage image, ImageUsage usage);
+    RenderGraphPass& write(RenderGraphImage image, ImageUsage usage);
+    // The clear is folded in the attachment loadOp, no separate clear command is recorded
+    RenderGraphPass& write(RenderGraphImage image, ImageUsage usage, const vk::ClearValue& clear);
+    RenderGraphPass& execute(RenderGraphExecute&& execute);
+
+    [[nodiscard]] const std::string& get_name() const { return m_Name; }
+
+private:
+    friend class RenderGraph;
+    friend class RenderGraphContext;
+
+    std::string m_Name;
+    std::vector<RenderGraphAccess> m_Reads;
+    std::vector<RenderGraphAccess> m_Writes;
+    RenderGraphExecute m_Execute;
+};
+
+/*
+ * Passes declare the images they read and write, compile() then:
+ * - culls passes that do not contribute to an imported image or a final usage
+ * - orders the remaining passes from their read/write dependencies
+ * - computes transient image lifetimes and aliases non overlapping ones on the same VMA memory
+ * - resolves attachment load/store ops (clear, dont care on undefined content, store only when read later)
+ * execute() records the passes and lets the ImageStateTracker emit the barriers between them.
+ *
+ * The graph is built once and recompiled only when its shape or transient sizes change,
+ * imported images are rebound every frame with bind_image().
+ */
+class RenderGraph {
+public:
+    void init(vk::Device device, VmaAllocator allocator);
+    void destroy();
+
+    // discard_each_frame: the image content does not survive from one frame to the next
+    RenderGraphImage import_image(const std::string& name, vk::ImageAspectFlags aspect, bool discard_each_frame);
+    RenderGraphImage create_transient(const std::string& name, const TransientImageDesc& desc);
+    RenderGraphPass& add_pass(const std::string& name);
+    void set_final_usage(RenderGraphImage image, ImageUsage usage);
+
+    [[nodiscard]] bool compile();
+    void bind_image(RenderGraphImage handle, vk::Image image, vk::ImageView view, vk::Extent2D extent);
+    // Every pass gets its own GPU timestamp scope when a profiler is given
+    void execute(vk::CommandBuffer cmd, ImageStateTracker& tracker, GpuProfiler* profiler = nullptr);
+
+    [[nodiscard]] size_t get_pass_count() const { return m_Order.size(); }
+    [[nodiscard]] vk::DeviceSize get_transient_memory_size() const { return m_TransientMemorySize; }
+
+private:
+    friend class RenderGraphContext;
+
+    struct Resource {
+        std::string Name;
+        bool Transient { false };
+        bool DiscardEachFrame { false };
+        TransientImageDesc Desc {};
+        std::optional<ImageUsage> FinalUsage {};
+
+        vk::Image Image { nullptr };
+        vk::ImageView View { nullptr };
+        vk::Extent2D Extent {};
+
+        // Positions in m_Order, filled by compile
+        uint32_t FirstUse { UINT32_MAX };
+        uint32_t LastUse { 0 };
+        vk::ImageUsageFlags UsageFlags {};
+        std::optional<uint32_t> MemoryBlock {};
+    };
+
+    struct MemoryBlock {
+        VmaAllocation Allocation { nullptr };
+        vk::MemoryRequirements Requirements {};
+        std::vector<uint32_t> Resources;
+        // Last resource that touched this memory, its state is what the next alias must wait on
+        std::optional<uint32_t> LastUser {};
+    };
+
+    vk::Device m_Device { nullptr };
+    VmaAllocator m_Allocator { nullptr };
+
+    std::deque<RenderGraphPass> m_Passes;
+    std::vector<Resource> m_Resources;
+    std::vector<uint32_t> m_Order;
+    std::vector<MemoryBlock> m_MemoryBlocks;
+    vk::DeviceSize m_TransientMemorySize { 0 };
+
+    [[nodiscard]] std::vector<bool> cull_passes() const;
+    [[nodiscard]] std::vector<uint32_t> sort_passes(const std::vector<bool>& live) const;
+    void compute_lifetimes();
+    void resolve_attachment_ops();
+    [[nodiscard]] bool allocate_transients();
+    void release_transients();
+    void begin_resource_use(uint32_t resource, ImageStateTracker& tracker);
+};
+
+}
@@ -0,0 +1,57 @@
+#include "resolution_controller.hpp"
+
+namespace Minecraft::VkEngine {
+
+void ResolutionController::init(const ResolutionSpec& spec, const uint32_t settle_frames)
+{
+    m_Spec = spec;
+    m_Spec.MaxScale = std::clamp(m_Spec.MaxScale, SCALE_QUANTUM, 1.0f);
+    m_Spec.MinScale = std::clamp(m_Spec.MinScale, SCALE_QUANTUM, m_Spec.MaxScale);
+    m_SettleFrames = settle_frames;
+
+    m_Scale = m_Spec.MaxScale;
+    m_SmoothedMs = 0.0;
+    m_Samples = 0;
+    m_LastFrame = 0;
+    m_SettledFrame = 0;
+}
+
+float ResolutionController::update(const uint64_t frame_number, const double gpu_ms)
+{
+    if (gpu_ms <= 0.0 || (m_Samples > 0 && frame_number <= m_LastFrame) || frame_number < m_SettledFrame) {
+        return m_Scale;
+    }
+    m_LastFrame = frame_number;
+
+    if (m_Samples++ == 0) {
+        m_SmoothedMs = gpu_ms;
+    } else {
+        const double weight = gpu_ms > m_SmoothedMs ? RISE_WEIGHT : FALL_WEIGHT;
+        m_SmoothedMs += (gpu_ms - m_SmoothedMs) * weight;
+    }
+
+    const double target = m_Spec.TargetMs;
+    const bool over = m_SmoothedMs > target;
+    const bool under = m_SmoothedMs < target * (1.0 - HEADROOM);
+    if (m_Samples < MIN_SAMPLES || (!over && !under)) {
+        return m_Scale;
+    }
+
+    // Aim for the middle of the headroom band
+    const double ratio = target * (1.0 - HEADROOM * 0.5) / m_SmoothedMs;
+    float scale = m_Scale * static_cast<float>(std::sqrt(ratio));
+    scale = std::clamp(scale, m_Scale - MAX_STEP, m_Scale + MAX_STEP);
+    scale = std::round(scale / SCALE_QUANTUM) * SCALE_QUANTUM;
+    scale = std::clamp(scale, m_Spec.MinScale, m_Spec.MaxScale);
+
+    if (scale == m_Scale) {
+        return m_Scale;
+    }
+
+    m_Scale = scale;
+    m_Samples = 0;
+    m_SettledFrame = frame_number + m_SettleFrames + 1;
+    return m_Scale;
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+namespace Minecraft::VkEngine {
+
+struct ResolutionSpec {
+    double TargetMs { 1000.0 / 60.0 };
+    float MinScale { 0.5f };
+    float MaxScale { 1.0f };
+};
+
+/*
+ * Picks the render scale that keeps the GPU frame time under a target.
+ * GPU time is assumed to follow the pixel count, so the scale moves by the square root of the
+ * target / measured ratio, aiming a bit under the target to leave room for spikes.
+ * Spikes raise the smoothed time quickly while drops lower it slowly, scale changes are quantized,
+ * bounded per step and only made once the frames rendered at the previous scale have been measured.
+ */
+class ResolutionController {
+public:
+    // Fraction of the target kept free, the scale only grows below TargetMs * (1 - HEADROOM)
+    static constexpr double HEADROOM = 0.1;
+    static constexpr double RISE_WEIGHT = 0.5;
+    static constexpr double FALL_WEIGHT = 0.05;
+    static constexpr uint32_t MIN_SAMPLES = 4;
+    static constexpr float MAX_STEP = 0.1f;
+    static constexpr float SCALE_QUANTUM = 1.0f / 32.0f;
+
+    // settle_frames: frames between picking a scale and the GPU timing the first frame using it
+    void init(const ResolutionSpec& spec, uint32_t settle_frames);
+
+    // Feeds the GPU time of frame_number, stale or repeated frames are ignored. Returns the scale to render at
+    float update(uint64_t frame_number, double gpu_ms);
+
+    [[nodiscard]] float get_scale() const { return m_Scale; }
+    [[nodiscard]] double get_smoothed_ms() const { return m_SmoothedMs; }
+
+private:
+    ResolutionSpec m_Spec {};
+    uint32_t m_SettleFrames { 0 };
+
+    float m_Scale { 1.0f };
+    double m_SmoothedMs { 0.0 };
+    uint32_t m_Samples { 0 };
+    uint64_t m_LastFrame { 0 };
+    // Frames before this one were rendered at a previous scale
+    uint64_t m_SettledFrame { 0 };
+};
+
+}
@@ -0,0 +1,196 @@
+#include "shader_library.hpp"
+#include "hash.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+static constexpr size_t SPIRV_HEADER_WORDS = 5;
+static constexpr uint32_t SPIRV_OP_FUNCTION_END = 56;
+
+// Walks the instructions, a module cut short by a compiler still writing it doesn't get to the driver
+static bool is_complete_spirv(const std::span<const uint32_t> words)
+{
+    if (words.size() <= SPIRV_HEADER_WORDS || words[0] != SPIRV_MAGIC) {
+        return false;
+    }
+
+    // Every id under the bound is the result of an instruction, and those are at least two words long
+    const uint32_t bound = words[3];
+    if (bound == 0 || bound > words.size()) {
+        return false;
+    }
+
+    uint32_t last_opcode = 0;
+    for (size_t offset = SPIRV_HEADER_WORDS; offset < words.size();) {
+        const uint32_t word_count = words[offset] >> 16;
+        if (word_count == 0 || word_count > words.size() - offset) {
+            return false;
+        }
+        last_opcode = words[offset] & 0xFFFF;
+        offset += word_count;
+    }
+
+    // Function bodies close the module
+    return last_opcode == SPIRV_OP_FUNCTION_END;
+}
+
+void ShaderLibrary::init(const vk::Device device, std::filesystem::path root)
+{
+    m_Device = device;
+    m_Root = std::move(root);
+}
+
+void ShaderLibrary::destroy()
+{
+    destroy_retired();
+
+    for (const auto& [hash, module] : m_Modules) {
+        m_Device.destroyShaderModule(module.Handle);
+    }
+
+    m_Modules.clear();
+    m_Files.clear();
+    m_FilesByPath.clear();
+}
+
+std::expected<uint64_t, std::string> ShaderLibrary::acquire_module(const std::filesystem::path& path, const uintmax_t expected_size)
+{
+    auto mapped = MappedFile::open(path);
+    if (!mapped.has_value()) {
+        return std::unexpected(mapped.error());
+    }
+
+    const std::span<const std::byte> code = mapped->data();
+    if (code.size() != expected_size) {
+        return std::unexpected(fmt::format("{} changed while loading", path.string()));
+    }
+    if (code.size() % sizeof(uint32_t) != 0) {
+        return std::unexpected(fmt::format("Not a SPIR-V binary: {}", path.string()));
+    }
+
+    // Mappings are page aligned, good enough for the uint32_t alignment Vulkan asks for.
+    // Validated in place, the driver copies the words when it creates the module
+    const std::span words { reinterpret_cast<const uint32_t*>(code.data()), code.size() / sizeof(uint32_t) };
+    if (!is_complete_spirv(words)) {
+        return std::unexpected(fmt::format("Invalid or truncated SPIR-V binary: {}", path.string()));
+    }
+
+    const uint64_t content_hash = fnv1a_64(code.data(), code.size());
+    if (const auto it = m_Modules.find(content_hash); it != m_Modules.end()) {
+        it->second.References++;
+        return content_hash;
+    }
+
+    const vk::ShaderModuleCreateInfo create_info { {}, code.size(), words.data() };
+
+    const auto [result, shader_module] = m_Device.createShaderModule(create_info);
+    if (result != vk::Result::eSuccess) {
+        return std::unexpected(vk::to_string(result));
+    }
+
+    m_Modules.emplace(content_hash, Module { shader_module, 1 });
+    return content_hash;
+}
+
+void ShaderLibrary::release_module(const uint64_t content_hash)
+{
+    const auto it = m_Modules.find(content_hash);
+    assert(it != m_Modules.end());
+
+    if (--it->second.References == 0) {
+        m_RetiredModules.push_back(it->second.Handle);
+        m_Modules.erase(it);
+    }
+}
+
+std::expected<ShaderHandle, std::string> ShaderLibrary::load(const std::string& name)
+{
+    std::error_code ec;
+    const std::filesystem::path path = std::filesystem::weakly_canonical(m_Root / name, ec);
+    if (ec) {
+        return std::unexpected(fmt::format("Invalid shader path {}: {}", name, ec.message()));
+    }
+
+    if (const auto it = m_FilesByPath.find(path.string()); it != m_FilesByPath.end()) {
+        return ShaderHandle { it->second };
+    }
+
+    const auto write_time = std::filesystem::last_write_time(path, ec);
+    const auto size = std::filesystem::file_size(path, ec);
+    const auto content_hash = acquire_module(path, size);
+    if (!content_hash.has_value()) {
+        return std::unexpected(content_hash.error());
+    }
+
+    const auto index = static_cast<uint32_t>(m_Files.size());
+    m_Files.push_back(ShaderFile { path, write_time, size, write_time, size, content_hash.value() });
+    m_FilesByPath.emplace(path.string(), index);
+
+    return ShaderHandle { index };
+}
+
+vk::ShaderModule ShaderLibrary::get_module(const ShaderHandle handle) const
+{
+    const ShaderFile& file = m_Files[handle.Index];
+    return m_Modules.at(file.ContentHash).Handle;
+}
+
+std::vector<ShaderHandle> ShaderLibrary::poll_changes()
+{
+    std::vector<ShaderHandle> changed;
+
+    for (uint32_t i = 0; i < m_Files.size(); i++) {
+        ShaderFile& file = m_Files[i];
+
+        std::error_code ec;
+        const auto write_time = std::filesystem::last_write_time(file.Path, ec);
+        if (ec) {
+            continue;
+        }
+        const auto size = std::filesystem::file_size(file.Path, ec);
+        if (ec || (write_time == file.LastWrite && size == file.Size)) {
+            continue;
+        }
+
+        // The compiler may still be writing it, wait until it holds still for a whole poll interval
+        if (write_time != file.PendingWrite || size != file.PendingSize) {
+            file.PendingWrite = write_time;
+            file.PendingSize = size;
+            continue;
+        }
+
+        // Settled either way, a bad file is reported once and the old module kept until the next write
+        file.LastWrite = write_time;
+        file.Size = size;
+
+        const auto content_hash = acquire_module(file.Path, file.Size);
+        if (!content_hash.has_value()) {
+            LOG_ERROR("Failed to reload shader: {}", content_hash.error());
+            continue;
+        }
+
+        if (content_hash.value() == file.ContentHash) {
+            release_module(content_hash.value());
+            continue;
+        }
+
+        release_module(file.ContentHash);
+        file.ContentHash = content_hash.value();
+        changed.push_back(ShaderHandle { i });
+
+        LOG("Shader reloaded: {}", file.Path.string());
+    }
+
+    return changed;
+}
+
+void ShaderLibrary::destroy_retired()
+{
+    for (const auto module : m_RetiredModules) {
+        m_Device.destroyShaderModule(module);
+    }
+    m_RetiredModules.clear();
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "mapped_file.hpp"
+
+namespace Minecraft::VkEngine {
+
+struct ShaderHandle {
+    uint32_t Index { UINT32_MAX };
+
+    [[nodiscard]] bool is_valid() const { return Index != UINT32_MAX; }
+    bool operator==(const ShaderHandle&) const = default;
+};
+
+/*
+ * Owns every shader module of the engine.
+ * SPIR-V files are read into memory and checked for truncation, and modules are shared by content hash so two
+ * pipelines or two files with the same code end up on the same VkShaderModule.
+ * poll_changes() watches the files and swaps the modules of the ones that changed on disk, once their size and
+ * write time stayed the same for two polls. Old modules are kept around until destroy_retired() since pipelines
+ * may still be compiling with them.
+ */
+class ShaderLibrary {
+public:
+    void init(vk::Device device, std::filesystem::path root);
+    void destroy();
+
+    // name is relative to the shader root, e.g. "basic.vert.spv"
+    [[nodiscard]] std::expected<ShaderHandle, std::string> load(const std::string& name);
+    [[nodiscard]] vk::ShaderModule get_module(ShaderHandle handle) const;
+    [[nodiscard]] const std::filesystem::path& get_path(ShaderHandle handle) const { return m_Files[handle.Index].Path; }
+
+    // Shaders whose content changed on disk since the last call
+    [[nodiscard]] std::vector<ShaderHandle> poll_changes();
+    void destroy_retired();
+
+    [[nodiscard]] size_t get_module_count() const { return m_Modules.size(); }
+
+private:
+    struct ShaderFile {
+        std::filesystem::path Path;
+        std::filesystem::file_time_type LastWrite {};
+        uintmax_t Size { 0 };
+        // Seen on the previous poll, a change is loaded once it holds still
+        std::filesystem::file_time_type PendingWrite {};
+        uintmax_t PendingSize { 0 };
+        uint64_t ContentHash { 0 };
+    };
+
+    struct Module {
+        vk::ShaderModule Handle { nullptr };
+        uint32_t References { 0 };
+    };
+
+    vk::Device m_Device { nullptr };
+    std::filesystem::path m_Root;
+
+    std::vector<ShaderFile> m_Files;
+    std::unordered_map<std::string, uint32_t> m_FilesByPath;
+    std::unordered_map<uint64_t, Module> m_Modules;
+    std::vector<vk::ShaderModule> m_RetiredModules;
+
+    // Fails when the file no longer has expected_size, it was written again since it was last looked at
+    [[nodiscard]] std::expected<uint64_t, std::string> acquire_module(const std::filesystem::path& path, uintmax_t expected_size);
+    void release_module(uint64_t content_hash);
+};
+
+}
@@ -0,0 +1,109 @@
+#include "terrain_generator.hpp"
+
+namespace Minecraft {
+
+static constexpr uint32_t DIRT_DEPTH = 3;
+// Caves never reach below it, the bottom of the world stays closed
+static constexpr uint32_t CAVE_FLOOR = 4;
+// Decorrelates the cave noise from the heights
+static constexpr uint32_t CAVE_SEED_MASK = 0x5BD1E995u;
+
+static BlockId column_block(const uint32_t y, const uint32_t height, const uint32_t sea_level)
+{
+    if (y + DIRT_DEPTH < height) {
+        return BLOCK_STONE;
+    }
+
+    const bool shore = height <= sea_level + 1;
+    if (y < height) {
+        return shore ? BLOCK_SAND : BLOCK_DIRT;
+    }
+    if (y == height) {
+        return shore ? BLOCK_SAND : BLOCK_GRASS;
+    }
+    return y <= sea_level ? BLOCK_WATER : BLOCK_AIR;
+}
+
+TerrainGenerator::TerrainGenerator(const TerrainSpec spec, const SimdLevel level)
+    : m_Spec(spec)
+    , m_Noise(level)
+    , m_HeightNoise { .Seed = spec.Seed, .Frequency = 1.0f / spec.Scale, .Octaves = spec.Octaves }
+    , m_CaveNoise { .Seed = spec.Seed ^ CAVE_SEED_MASK, .Frequency = spec.CaveScale > 0.0f ? 1.0f / spec.CaveScale : 0.0f, .Octaves = spec.CaveOctaves }
+{
+}
+
+uint32_t TerrainGenerator::to_height(const float noise) const
+{
+    const float height = static_cast<float>(m_Spec.BaseHeight) + m_Spec.Amplitude * noise;
+    return static_cast<uint32_t>(std::clamp(height, 1.0f, static_cast<float>(Chunk::HEIGHT - 1)));
+}
+
+uint32_t TerrainGenerator::get_height(const int32_t x, const int32_t z) const
+{
+    const std::array point_x { static_cast<float>(x) };
+    const std::array point_z { static_cast<float>(z) };
+    std::array<float, 1> noise;
+    m_Noise.fbm_2d(m_HeightNoise, point_x, point_z, noise);
+    return to_height(noise[0]);
+}
+
+void TerrainGenerator::generate(Chunk& chunk, const int32_t chunk_x, const int32_t chunk_z) const
+{
+    constexpr uint32_t size = ChunkSection::SIZE;
+    const int32_t origin_x = chunk_x * static_cast<int32_t>(size);
+    const int32_t origin_z = chunk_z * static_cast<int32_t>(size);
+
+    std::array<float, ChunkSection::AREA> height_noise;
+    m_Noise.fbm_area(m_HeightNoise, glm::ivec2 { origin_x, origin_z }, height_noise);
+
+    std::array<uint32_t, ChunkSection::AREA> heights;
+    uint32_t min_height = UINT32_MAX;
+    uint32_t max_height = 0;
+    for (uint32_t i = 0; i < ChunkSection::AREA; i++) {
+        heights[i] = to_height(height_noise[i]);
+        min_height = std::min(min_height, heights[i]);
+        max_height = std::max(max_height, heights[i]);
+    }
+
+    const uint32_t top = std::max(max_height, m_Spec.SeaLevel);
+    const bool caves = has_caves();
+
+    // Sections above everything stay uniform, and so do the ones under the dirt when there are no caves to carve
+    std::array<BlockId, ChunkSection::VOLUME> blocks;
+    std::array<float, ChunkSection::VOLUME> cave_noise;
+    for (uint32_t section = 0; section < Chunk::SECTION_COUNT; section++) {
+        const uint32_t base = section * size;
+        if (base > top) {
+            chunk.fill_section(section, BLOCK_AIR);
+            continue;
+        }
+
+        const bool has_stone = base + DIRT_DEPTH < max_height;
+        if (!caves && base + size - 1 + DIRT_DEPTH < min_height) {
+            chunk.fill_section(section, BLOCK_STONE);
+            continue;
+        }
+
+        const bool carve = caves && has_stone && base + size > CAVE_FLOOR;
+        if (carve) {
+            m_Noise.fbm_section(m_CaveNoise, glm::ivec3 { origin_x, static_cast<int32_t>(base), origin_z }, cave_noise);
+        }
+
+        for (uint32_t y = 0; y < size; y++) {
+            const bool above_floor = base + y >= CAVE_FLOOR;
+            for (uint32_t z = 0; z < size; z++) {
+                for (uint32_t x = 0; x < size; x++) {
+                    const uint32_t index = ChunkSection::index(x, y, z);
+                    BlockId block = column_block(base + y, heights[x + z * size], m_Spec.SeaLevel);
+                    if (carve && block == BLOCK_STONE && above_floor && cave_noise[index] > m_Spec.CaveThreshold) {
+                        block = BLOCK_AIR;
+                    }
+                    blocks[index] = block;
+                }
+            }
+        }
+        chunk.set_section(section, blocks);
+    }
+}
+
+}
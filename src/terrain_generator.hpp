@@ -0,0 +1,57 @@
+#pragma once
+#include "chunk.hpp"
+#include "noise.hpp"
+
+namespace Minecraft {
+
+inline constexpr BlockId BLOCK_STONE = 1;
+inline constexpr BlockId BLOCK_DIRT = 2;
+inline constexpr BlockId BLOCK_GRASS = 3;
+inline constexpr BlockId BLOCK_WATER = 4;
+inline constexpr BlockId BLOCK_SAND = 5;
+
+struct TerrainSpec {
+    uint32_t Seed { 1337 };
+    uint32_t BaseHeight { 64 };
+    uint32_t SeaLevel { 62 };
+    // Height scale of the hills around BaseHeight, the noise seldom goes past half of it
+    float Amplitude { 40.0f };
+    // Size of the largest features, in blocks
+    float Scale { 128.0f };
+    uint32_t Octaves { 4 };
+    // Size of the caves in blocks, 0 disables them
+    float CaveScale { 32.0f };
+    // Stone turns to air where the cave noise is above it, higher leaves fewer and smaller caves
+    float CaveThreshold { 0.38f };
+    uint32_t CaveOctaves { 2 };
+};
+
+/*
+ * Heightmap terrain from fractal Perlin noise: stone, a few blocks of dirt topped with grass, sand on the shores
+ * and water up to sea level, with caves carved out of the stone by 3D noise.
+ *
+ * The noise is evaluated in batches, one call for the heights of a chunk and one per section for the caves,
+ * and the blocks go straight into the chunk sections. Deterministic for a seed whatever SIMD level runs it,
+ * and const, any number of threads can share one.
+ */
+class TerrainGenerator {
+public:
+    explicit TerrainGenerator(TerrainSpec spec = {}, SimdLevel level = detect_simd_level());
+
+    void generate(Chunk& chunk, int32_t chunk_x, int32_t chunk_z) const;
+    [[nodiscard]] uint32_t get_height(int32_t x, int32_t z) const;
+
+    [[nodiscard]] const TerrainSpec& get_spec() const { return m_Spec; }
+    [[nodiscard]] SimdLevel get_simd_level() const { return m_Noise.get_level(); }
+
+private:
+    TerrainSpec m_Spec;
+    Noise m_Noise;
+    FractalSpec m_HeightNoise;
+    FractalSpec m_CaveNoise;
+
+    [[nodiscard]] uint32_t to_height(float noise) const;
+    [[nodiscard]] bool has_caves() const { return m_Spec.CaveOctaves > 0 && m_Spec.CaveScale > 0.0f; }
+};
+
+}
@@ -0,0 +1,423 @@
+#include "texture_array.hpp"
+#include "cpu_profiler.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+struct TexelBlock {
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t Bytes;
+};
+
+// Formats block textures come in, blank layers need their level sizes
+static std::optional<TexelBlock> texel_block(const vk::Format format)
+{
+    switch (format) {
+    case vk::Format::eR8G8B8A8Unorm:
+    case vk::Format::eR8G8B8A8Srgb:
+    case vk::Format::eB8G8R8A8Unorm:
+    case vk::Format::eB8G8R8A8Srgb:
+        return TexelBlock { 1, 1, 4 };
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc1RgbaUnormBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+    case vk::Format::eBc4UnormBlock:
+        return TexelBlock { 4, 4, 8 };
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+    case vk::Format::eBc5UnormBlock:
+    case vk::Format::eBc7UnormBlock:
+    case vk::Format::eBc7SrgbBlock:
+        return TexelBlock { 4, 4, 16 };
+    default:
+        return std::nullopt;
+    }
+}
+
+static vk::Extent2D mip_extent(const vk::Extent2D extent, const uint32_t level)
+{
+    return vk::Extent2D { std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u) };
+}
+
+static vk::DeviceSize level_size(const TexelBlock& block, const vk::Extent2D extent)
+{
+    const vk::DeviceSize blocks_x = (extent.width + block.Width - 1) / block.Width;
+    const vk::DeviceSize blocks_y = (extent.height + block.Height - 1) / block.Height;
+    return blocks_x * blocks_y * block.Bytes;
+}
+
+vk::Result TextureArray::init(GpuManager& gpu, UploadManager& uploads, BindlessHeap& heap, TextureArraySpec spec)
+{
+    assert(!spec.Files.empty());
+    m_Gpu = &gpu;
+    m_Uploads = &uploads;
+    m_Heap = &heap;
+    m_Device = gpu.get_device();
+    m_Allocator = gpu.get_allocator();
+    m_Spec = std::move(spec);
+
+    if (!texel_block(m_Spec.Format).has_value()) {
+        LOG_ERROR("Unsupported block texture format {}", vk::to_string(m_Spec.Format));
+        return vk::Result::eErrorFormatNotSupported;
+    }
+
+    const vk::PhysicalDevice physical_device = gpu.get_physical_device();
+    const uint32_t max_layers = physical_device.getProperties().limits.maxImageArrayLayers;
+    if (m_Spec.Files.size() > max_layers) {
+        LOG_ERROR("{} block textures but the device supports {} array layers", m_Spec.Files.size(), max_layers);
+        return vk::Result::eErrorFormatNotSupported;
+    }
+
+    constexpr vk::FormatFeatureFlags blit_features {
+        vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst | vk::FormatFeatureFlagBits::eSampledImageFilterLinear
+    };
+    m_CanBlit = (physical_device.getFormatProperties(m_Spec.Format).optimalTilingFeatures & blit_features) == blit_features;
+    m_MipCount = std::bit_width(std::max(m_Spec.Extent.width, m_Spec.Extent.height));
+
+    vk::ImageCreateInfo image_info {};
+    image_info.imageType = vk::ImageType::e2D;
+    image_info.format = m_Spec.Format;
+    image_info.extent = vk::Extent3D { m_Spec.Extent.width, m_Spec.Extent.height, 1 };
+    image_info.mipLevels = m_MipCount;
+    image_info.arrayLayers = static_cast<uint32_t>(m_Spec.Files.size());
+    image_info.samples = vk::SampleCountFlagBits::e1;
+    image_info.tiling = vk::ImageTiling::eOptimal;
+    image_info.usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc;
+
+    VmaAllocationCreateInfo alloc_info {};
+    alloc_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    VkImage image;
+    const VkResult res = vmaCreateImage(m_Allocator, reinterpret_cast<const VkImageCreateInfo*>(&image_info), &alloc_info,
+        &image, &m_Image.Allocation, nullptr);
+    if (res != VK_SUCCESS) {
+        return static_cast<vk::Result>(res);
+    }
+
+    m_Image.Image = image;
+    m_Image.Extent = image_info.extent;
+    m_Image.Format = m_Spec.Format;
+    gpu.get_memory().track(MemoryCategory::eTextures, m_Image.Allocation);
+
+    m_Layers.resize(m_Spec.Files.size());
+    m_NextLevel = m_MipCount - 1;
+    m_ResidentMip = m_MipCount;
+
+    m_Stopping = false;
+    m_Loader = std::thread(&TextureArray::load_files, this);
+
+    LOG("Block textures: {} layers of {}x{} {}, {} mips", m_Layers.size(), m_Spec.Extent.width, m_Spec.Extent.height,
+        vk::to_string(m_Spec.Format), m_MipCount);
+    return vk::Result::eSuccess;
+}
+
+void TextureArray::destroy()
+{
+    m_Stopping = true;
+    if (m_Loader.joinable()) {
+        m_Loader.join();
+    }
+
+    if (m_View) {
+        m_Device.destroyImageView(m_View);
+        m_View = nullptr;
+    }
+    m_ViewIndex.reset();
+
+    if (m_Image.Image) {
+        m_Gpu->get_memory().untrack(MemoryCategory::eTextures, m_Image.Allocation);
+        vmaDestroyImage(m_Allocator, m_Image.Image, m_Image.Allocation);
+        m_Image = {};
+    }
+
+    m_Layers.clear();
+    m_Loaded.clear();
+}
+
+std::optional<uint32_t> TextureArray::find_layer(const std::string_view name) const
+{
+    for (uint32_t i = 0; i < m_Spec.Files.size(); i++) {
+        if (m_Spec.Files[i].stem().string() == name) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+#pragma region Loading
+
+void TextureArray::load_files()
+{
+    CpuProfiler::set_thread_name("Texture Loader");
+    const TexelBlock block = texel_block(m_Spec.Format).value();
+
+    for (uint32_t i = 0; i < m_Spec.Files.size() && !m_Stopping; i++) {
+        CPU_ZONE("Load Texture");
+        const std::filesystem::path& path = m_Spec.Files[i];
+        LoadedFile loaded { i };
+
+        auto file = MappedFile::open(path);
+        if (!file.has_value()) {
+            LOG_ERROR("{}", file.error());
+        } else if (const auto image = Ktx2Image::parse(file->data()); !image.has_value()) {
+            LOG_ERROR("{}: {}", path.string(), image.error());
+        } else if (image->Format != m_Spec.Format || image->Extent != m_Spec.Extent || image->LayerCount != 1) {
+            LOG_ERROR("{}: {}x{} {} does not match the {}x{} {} block texture array", path.string(),
+                image->Extent.width, image->Extent.height, vk::to_string(image->Format),
+                m_Spec.Extent.width, m_Spec.Extent.height, vk::to_string(m_Spec.Format));
+        } else {
+            // Levels too short for their extent would have the copies read past the staging data
+            const uint32_t stored_levels = std::min(std::max(image->LevelCount, 1u), m_MipCount);
+            bool valid = true;
+            for (uint32_t level = 0; level < stored_levels; level++) {
+                valid &= image->Levels[level].size() >= level_size(block, mip_extent(m_Spec.Extent, level));
+            }
+
+            if (!valid) {
+                LOG_ERROR("{}: levels are smaller than their extent", path.string());
+            } else if (image->LevelCount < m_MipCount && !m_CanBlit) {
+                LOG_ERROR("{}: has no mips and {} can not be blitted to generate them", path.string(), vk::to_string(m_Spec.Format));
+            } else {
+                loaded.Image = image.value();
+                loaded.File = std::move(file.value());
+            }
+        }
+
+        std::lock_guard lock { m_LoadedMutex };
+        m_Loaded.push_back(std::move(loaded));
+    }
+}
+
+void TextureArray::accept(LoadedFile&& loaded)
+{
+    Layer& layer = m_Layers[loaded.Layer];
+    layer.Loaded = true;
+
+    if (loaded.Image.has_value()) {
+        layer.File = std::move(loaded.File);
+        layer.Image = loaded.Image.value();
+        layer.GenerateMips = layer.Image.LevelCount < m_MipCount;
+        return;
+    }
+
+    // Blank layer, every level zeroed
+    const TexelBlock block = texel_block(m_Spec.Format).value();
+    std::array<vk::DeviceSize, Ktx2Image::MAX_LEVELS> offsets {};
+    vk::DeviceSize size = 0;
+    for (uint32_t level = 0; level < m_MipCount; level++) {
+        offsets[level] = size;
+        size += level_size(block, mip_extent(m_Spec.Extent, level));
+    }
+
+    layer.Blank.assign(size, std::byte { 0 });
+    layer.Image.Format = m_Spec.Format;
+    layer.Image.Extent = m_Spec.Extent;
+    layer.Image.LevelCount = m_MipCount;
+    for (uint32_t level = 0; level < m_MipCount; level++) {
+        layer.Image.Levels[level] = std::span<const std::byte> { layer.Blank }.subspan(offsets[level], level_size(block, mip_extent(m_Spec.Extent, level)));
+    }
+}
+
+#pragma endregion
+
+#pragma region Streaming
+
+void TextureArray::update()
+{
+    CPU_ZONE("Stream Textures");
+
+    std::vector<LoadedFile> loaded;
+    {
+        std::lock_guard lock { m_LoadedMutex };
+        std::swap(loaded, m_Loaded);
+    }
+    for (auto& file : loaded) {
+        accept(std::move(file));
+    }
+
+    vk::DeviceSize budget = UPLOAD_BUDGET_PER_FRAME;
+
+    // Only the base level comes from these files, the blits then produce all the others at once
+    for (uint32_t i = 0; i < m_Layers.size(); i++) {
+        Layer& layer = m_Layers[i];
+        if (layer.Loaded && layer.GenerateMips && !(layer.ReadyLevels & 1u)) {
+            (void)enqueue_level(layer, i, 0, budget);
+        }
+    }
+
+    // A level is only started once every layer queued the coarser ones, m_NextLevel wraps past 0 when done
+    while (m_NextLevel < m_MipCount) {
+        bool complete = true;
+        for (uint32_t i = 0; i < m_Layers.size(); i++) {
+            Layer& layer = m_Layers[i];
+            if (layer.ReadyLevels & (1u << m_NextLevel)) {
+                continue;
+            }
+
+            if (!layer.Loaded || layer.GenerateMips || !enqueue_level(layer, i, m_NextLevel, budget)) {
+                complete = false;
+            }
+        }
+
+        if (!complete) {
+            break;
+        }
+        m_NextLevel--;
+    }
+
+    update_view();
+}
+
+bool TextureArray::enqueue_level(Layer& layer, const uint32_t layer_index, const uint32_t level, vk::DeviceSize& budget)
+{
+    if (budget == 0) {
+        return false;
+    }
+
+    const std::span<const std::byte> data = layer.Image.Levels[level];
+    const vk::Extent2D extent = mip_extent(m_Spec.Extent, level);
+    const auto ticket = m_Uploads->enqueue_image(m_Image.Image, vk::ImageAspectFlagBits::eColor, vk::Extent3D { extent.width, extent.height, 1 },
+        level, layer_index, 1, data, vk::PipelineStageFlagBits2::eFragmentShader);
+    if (!ticket.has_value()) {
+        budget = 0;
+        return false;
+    }
+
+    layer.ReadyLevels |= 1u << level;
+    if (level == 0) {
+        layer.BaseTicket = ticket.value();
+    }
+
+    // The upload crossing the budget still goes, the next ones wait for the next frame
+    budget -= std::min<vk::DeviceSize>(budget, data.size());
+    return true;
+}
+
+void TextureArray::update_view()
+{
+    uint32_t resident = m_ResidentMip;
+    while (resident > 0 && std::ranges::all_of(m_Layers, [&](const Layer& layer) { return (layer.ReadyLevels & (1u << (resident - 1))) != 0; })) {
+        resident--;
+    }
+
+    if (resident == m_ResidentMip) {
+        return;
+    }
+
+    const vk::ImageViewCreateInfo view_info {
+        {},
+        m_Image.Image,
+        vk::ImageViewType::e2DArray,
+        m_Spec.Format,
+        {},
+        vk::ImageSubresourceRange { vk::ImageAspectFlagBits::eColor, resident, m_MipCount - resident, 0, get_layer_count() }
+    };
+
+    const auto [res, view] = m_Device.createImageView(view_info);
+    if (res != vk::Result::eSuccess) {
+        LOG_ERROR("Failed to create the block texture view: {}", vk::to_string(res));
+        return;
+    }
+
+    const auto index = m_Heap->add_sampled_image(view);
+    if (!index.has_value()) {
+        m_Device.destroyImageView(view);
+        return;
+    }
+
+    // Frames in flight still sample the previous view
+    if (m_ViewIndex.has_value()) {
+        m_Heap->release(BindlessType::eSampledImage, m_ViewIndex.value());
+    }
+    m_Gpu->get_deleter().push(m_View);
+
+    m_View = view;
+    m_ViewIndex = index;
+    m_ResidentMip = resident;
+    LOG("Block textures resident down to mip {}", m_ResidentMip);
+}
+
+#pragma endregion
+
+#pragma region MipGeneration
+
+void TextureArray::record(const vk::CommandBuffer cmd)
+{
+    const uint32_t all_levels = (1u << m_MipCount) - 1;
+    for (uint32_t i = 0; i < m_Layers.size(); i++) {
+        Layer& layer = m_Layers[i];
+        // The base level must have been acquired by an earlier frame, which also waited for its upload
+        if (layer.GenerateMips && layer.ReadyLevels == 1u && m_Uploads->is_acquired(layer.BaseTicket)) {
+            generate_mips(cmd, i);
+            layer.ReadyLevels = all_levels;
+        }
+    }
+}
+
+void TextureArray::generate_mips(const vk::CommandBuffer cmd, const uint32_t layer_index) const
+{
+    const auto range = [&](const uint32_t base_level, const uint32_t level_count) {
+        return vk::ImageSubresourceRange { vk::ImageAspectFlagBits::eColor, base_level, level_count, layer_index, 1 };
+    };
+
+    const auto barrier = [&](const vk::ImageMemoryBarrier2& image_barrier) {
+        const vk::DependencyInfo dependency { {}, 0, nullptr, 0, nullptr, 1, &image_barrier };
+        cmd.pipelineBarrier2(dependency);
+    };
+
+    const std::array start_barriers {
+        vk::ImageMemoryBarrier2 {
+            vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eNone,
+            vk::PipelineStageFlagBits2::eBlit, vk::AccessFlagBits2::eTransferRead,
+            vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eTransferSrcOptimal,
+            vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+            m_Image.Image, range(0, 1) },
+        vk::ImageMemoryBarrier2 {
+            vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+            vk::PipelineStageFlagBits2::eBlit, vk::AccessFlagBits2::eTransferWrite,
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+            vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+            m_Image.Image, range(1, m_MipCount - 1) }
+    };
+    const vk::DependencyInfo start_dependency { {}, 0, nullptr, 0, nullptr, static_cast<uint32_t>(start_barriers.size()), start_barriers.data() };
+    cmd.pipelineBarrier2(start_dependency);
+
+    for (uint32_t level = 1; level < m_MipCount; level++) {
+        const vk::Extent2D src = mip_extent(m_Spec.Extent, level - 1);
+        const vk::Extent2D dst = mip_extent(m_Spec.Extent, level);
+
+        const vk::ImageBlit2 region {
+            vk::ImageSubresourceLayers { vk::ImageAspectFlagBits::eColor, level - 1, layer_index, 1 },
+            { vk::Offset3D { 0, 0, 0 }, vk::Offset3D { static_cast<int32_t>(src.width), static_cast<int32_t>(src.height), 1 } },
+            vk::ImageSubresourceLayers { vk::ImageAspectFlagBits::eColor, level, layer_index, 1 },
+            { vk::Offset3D { 0, 0, 0 }, vk::Offset3D { static_cast<int32_t>(dst.width), static_cast<int32_t>(dst.height), 1 } }
+        };
+        const vk::BlitImageInfo2 blit_info {
+            m_Image.Image, vk::ImageLayout::eTransferSrcOptimal,
+            m_Image.Image, vk::ImageLayout::eTransferDstOptimal,
+            1, &region, vk::Filter::eLinear
+        };
+        cmd.blitImage2(blit_info);
+
+        // Source of the next level
+        barrier(vk::ImageMemoryBarrier2 {
+            vk::PipelineStageFlagBits2::eBlit, vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eBlit, vk::AccessFlagBits2::eTransferRead,
+            vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eTransferSrcOptimal,
+            vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+            m_Image.Image, range(level, 1) });
+    }
+
+    barrier(vk::ImageMemoryBarrier2 {
+        vk::PipelineStageFlagBits2::eBlit, vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eTransferRead,
+        vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead,
+        vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+        vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+        m_Image.Image, range(0, m_MipCount) });
+}
+
+#pragma endregion
+
+}
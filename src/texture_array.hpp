@@ -0,0 +1,99 @@
+#pragma once
+#include "bindless_heap.hpp"
+#include "ktx2.hpp"
+#include "mapped_file.hpp"
+#include "upload_manager.hpp"
+
+namespace Minecraft::VkEngine {
+
+struct TextureArraySpec {
+    // One layer per file, in this order
+    std::vector<std::filesystem::path> Files;
+    vk::Extent2D Extent { 16, 16 };
+    vk::Format Format { vk::Format::eR8G8B8A8Srgb };
+};
+
+/*
+ * 2D array texture streamed from KTX2 files, one layer per file.
+ * A loader thread maps and parses the files while frames keep going, the main thread then uploads
+ * one mip level of every layer at a time from the coarsest to the finest within a per frame budget.
+ * Files without mips get theirs generated by blits on the graphics queue.
+ *
+ * Shaders only see the resident mips: the bindless view starts at the finest level every layer
+ * has and is replaced whenever a finer one completes, so the coarse mips show on the first frames.
+ * Files that fail to load or do not match the array become blank layers.
+ */
+class TextureArray {
+public:
+    static constexpr vk::DeviceSize UPLOAD_BUDGET_PER_FRAME = 4 * 1024 * 1024;
+
+    [[nodiscard]] vk::Result init(GpuManager& gpu, UploadManager& uploads, BindlessHeap& heap, TextureArraySpec spec);
+    void destroy();
+
+    // Main thread, before the uploads are flushed. Picks up the loaded files, queues the next levels
+    // and swaps the view when a finer level became resident
+    void update();
+    // Mip generation blits, recorded after the upload acquires
+    void record(vk::CommandBuffer cmd);
+
+    // Empty until the coarsest level of every layer is resident
+    [[nodiscard]] std::optional<uint32_t> get_bindless_index() const { return m_ViewIndex; }
+    [[nodiscard]] uint32_t get_resident_mip() const { return m_ResidentMip; }
+    [[nodiscard]] uint32_t get_mip_count() const { return m_MipCount; }
+    [[nodiscard]] uint32_t get_layer_count() const { return static_cast<uint32_t>(m_Layers.size()); }
+    [[nodiscard]] bool is_fully_resident() const { return m_ResidentMip == 0; }
+    // Layer of a file by its stem, e.g. "stone" for blocks/stone.ktx2
+    [[nodiscard]] std::optional<uint32_t> find_layer(std::string_view name) const;
+
+private:
+    struct LoadedFile {
+        uint32_t Layer;
+        MappedFile File;
+        std::optional<Ktx2Image> Image;
+    };
+
+    struct Layer {
+        MappedFile File;
+        Ktx2Image Image;
+        // Backs Image when the file could not be used
+        std::vector<std::byte> Blank;
+        bool Loaded { false };
+        // Only the base level comes from the file
+        bool GenerateMips { false };
+        // Bit per level queued for upload or generated
+        uint32_t ReadyLevels { 0 };
+        UploadTicket BaseTicket { 0 };
+    };
+
+    GpuManager* m_Gpu { nullptr };
+    UploadManager* m_Uploads { nullptr };
+    BindlessHeap* m_Heap { nullptr };
+    vk::Device m_Device { nullptr };
+    VmaAllocator m_Allocator { nullptr };
+
+    TextureArraySpec m_Spec;
+    AllocatedImage m_Image {};
+    uint32_t m_MipCount { 0 };
+    bool m_CanBlit { false };
+    std::vector<Layer> m_Layers;
+
+    // Next level to queue, counting down from the coarsest
+    uint32_t m_NextLevel { 0 };
+    uint32_t m_ResidentMip { 0 };
+    vk::ImageView m_View { nullptr };
+    std::optional<uint32_t> m_ViewIndex;
+
+    // Loader thread
+    std::thread m_Loader;
+    std::atomic<bool> m_Stopping { false };
+    std::mutex m_LoadedMutex;
+    std::vector<LoadedFile> m_Loaded;
+
+    void load_files();
+    void accept(LoadedFile&& loaded);
+    [[nodiscard]] bool enqueue_level(Layer& layer, uint32_t layer_index, uint32_t level, vk::DeviceSize& budget);
+    void generate_mips(vk::CommandBuffer cmd, uint32_t layer_index) const;
+    void update_view();
+};
+
+}
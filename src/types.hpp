@@ -1,4 +1,5 @@
 #pragma once
+#include "vertex_layout.hpp"
 #include <vk_mem_alloc.h>
 
 namespace Minecraft {
@@ -29,6 +30,12 @@ struct AllocatedImage {
     vk::Format Format;
 };
 
+struct AllocatedBuffer {
+    vk::Buffer Buffer { nullptr };
+    VmaAllocation Allocation { nullptr };
+    vk::DeviceSize Size { 0 };
+};
+
 struct QueueBundle {
     vk::Queue Queue;
     uint32_t FamilyIndex;
@@ -40,6 +47,10 @@ struct SwapchainBundle {
     std::vector<VkImage> Images;
     std::vector<VkImageView> ImageViews;
     vk::Extent2D Extent {};
+    // Compute writes the images directly, they are then UNORM and shaders encode sRGB themselves
+    bool Storage { false };
+    // Bumped every time it is recreated, handles may be reused by the driver
+    uint64_t Generation { 0 };
 };
 
 struct DrawImageBundle {
@@ -47,42 +58,50 @@ struct DrawImageBundle {
     vk::ImageView ImageView;
     vk::Extent3D Extent;
     vk::Format Format;
+    // Same extent, reallocated together with the draw image
+    vk::Image DepthImage;
+    vk::ImageView DepthImageView;
+    vk::Format DepthFormat;
 };
 
 struct Vertex {
     glm::vec3 pos;
     glm::vec3 color;
-
-    static vk::VertexInputBindingDescription get_binding_description()
-    {
-        return vk::VertexInputBindingDescription {
-            0, sizeof(Vertex), vk::VertexInputRate::eVertex
-        };
-    }
-
-    static std::array<vk::VertexInputAttributeDescription, 2> get_attribute_descriptions()
-    {
-        return {
-            vk::VertexInputAttributeDescription {
-                0, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, pos) },
-
-            vk::VertexInputAttributeDescription {
-                1, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, color) }
-        };
-    }
 };
 
+using VertexLayoutBasic = VertexLayout<Vertex,
+    VERTEX_ATTRIBUTE(Vertex, pos),
+    VERTEX_ATTRIBUTE(Vertex, color)>;
+
 struct GpuManagerSpec {
     const char* AppName { "Default Application Name" };
     bool EnableValidation { true };
     std::optional<PFN_vkDebugUtilsMessengerCallbackEXT> DebugCallback;
     GLFWwindow* Window { nullptr };
 
-    GpuManagerSpec(const char* const app_name, const bool enable_validation, const std::optional<PFN_vkDebugUtilsMessengerCallbackEXT>& debug_callback, GLFWwindow* const window)
+    // Without a window there is no surface nor swapchain, frames only land in the draw image
+    bool Headless { false };
+    vk::Extent2D HeadlessExtent {};
+
+    // Falls back to FIFO when the surface does not support it
+    vk::PresentModeKHR PresentMode { vk::PresentModeKHR::eFifo };
+    uint32_t MinImageCount { 3 };
+
+    // The draw image follows the swapchain size, capped by MaxDrawExtent when it is not zero
+    vk::Format DrawImageFormat { vk::Format::eR16G16B16A16Sfloat };
+    vk::Extent2D MaxDrawExtent {};
+
+    // Create the swapchain with storage usage when the surface allows it
+    bool SwapchainStorage { true };
+
+    GpuManagerSpec(const char* const app_name, const bool enable_validation, const std::optional<PFN_vkDebugUtilsMessengerCallbackEXT>& debug_callback, GLFWwindow* const window,
+        const vk::Extent2D headless_extent = {})
         : AppName(app_name)
         , EnableValidation(enable_validation)
         , DebugCallback(debug_callback)
         , Window(window)
+        , Headless(window == nullptr)
+        , HeadlessExtent(headless_extent)
     {
     }
 };
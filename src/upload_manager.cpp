@@ -0,0 +1,485 @@
+#include "upload_manager.hpp"
+#include "cpu_profiler.hpp"
+#include "logger.hpp"
+
+namespace Minecraft::VkEngine {
+
+// Covers copyBufferToImage offset rules for every format up to 16 bytes per texel
+static constexpr vk::DeviceSize STAGING_ALIGNMENT = 16;
+
+static uint64_t align_up(const uint64_t value, const uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+vk::Result UploadManager::init(GpuManager& gpu, const vk::DeviceSize staging_size)
+{
+    m_Gpu = &gpu;
+    m_Device = gpu.get_device();
+    m_Allocator = gpu.get_allocator();
+    m_Memory = &gpu.get_memory();
+    m_TransferFamily = gpu.get_transfer_queue().FamilyIndex;
+    m_GraphicsFamily = gpu.get_graphics_queue_family();
+    m_StagingSize = staging_size / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+
+    const vk::BufferCreateInfo buffer_info {
+        {},
+        m_StagingSize,
+        vk::BufferUsageFlagBits::eTransferSrc,
+        vk::SharingMode::eExclusive
+    };
+
+    VmaAllocationCreateInfo alloc_info {};
+    alloc_info.usage = VMA_MEMORY_USAGE_AUTO;
+    alloc_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VkBuffer buffer;
+    VmaAllocationInfo allocation_info;
+    const VkResult res = vmaCreateBuffer(m_Allocator, reinterpret_cast<const VkBufferCreateInfo*>(&buffer_info), &alloc_info,
+        &buffer, &m_Staging.Allocation, &allocation_info);
+    if (res != VK_SUCCESS) {
+        return static_cast<vk::Result>(res);
+    }
+
+    m_Staging.Buffer = buffer;
+    m_Staging.Size = m_StagingSize;
+    m_Memory->track(MemoryCategory::eStaging, m_Staging.Allocation);
+    m_StagingData = static_cast<std::byte*>(allocation_info.pMappedData);
+
+    const auto timeline = gpu.create_timeline_semaphore(0);
+    if (!timeline.has_value()) {
+        return timeline.error();
+    }
+    m_Timeline = timeline.value();
+
+    for (auto& batch : m_Batches) {
+        const auto pool = gpu.create_command_pool(vk::CommandPoolCreateFlagBits::eTransient, m_TransferFamily);
+        if (!pool.has_value()) {
+            return pool.error();
+        }
+        batch.Pool = pool.value();
+
+        const auto cmd = gpu.allocate_command_buffer(batch.Pool, vk::CommandBufferLevel::ePrimary);
+        if (!cmd.has_value()) {
+            return cmd.error();
+        }
+        batch.Cmd = cmd.value();
+    }
+
+    LOG("Upload manager: {} MiB staging ring on the {} queue", m_StagingSize >> 20, uses_dedicated_queue() ? "transfer" : "graphics");
+    return vk::Result::eSuccess;
+}
+
+void UploadManager::destroy()
+{
+    // Pools and the timeline belong to the GpuManager
+    if (m_Staging.Buffer) {
+        m_Memory->untrack(MemoryCategory::eStaging, m_Staging.Allocation);
+        vmaDestroyBuffer(m_Allocator, m_Staging.Buffer, m_Staging.Allocation);
+        m_Staging = {};
+    }
+
+    m_StagingData = nullptr;
+    m_PendingBuffers.clear();
+    m_PendingImages.clear();
+    m_BufferAcquires.clear();
+    m_ImageAcquires.clear();
+}
+
+#pragma region Staging
+
+std::optional<vk::DeviceSize> UploadManager::allocate_staging(const vk::DeviceSize size)
+{
+    uint64_t begin = align_up(m_Head, STAGING_ALIGNMENT);
+    vk::DeviceSize offset = begin % m_StagingSize;
+
+    // Never split an upload across the end of the ring
+    if (offset + size > m_StagingSize) {
+        begin += m_StagingSize - offset;
+        offset = 0;
+    }
+
+    if (begin + size - m_Tail > m_StagingSize) {
+        return std::nullopt;
+    }
+
+    m_Head = begin + size;
+    return offset;
+}
+
+std::optional<vk::DeviceSize> UploadManager::reserve_staging(const vk::DeviceSize size)
+{
+    if (size > m_StagingSize) {
+        LOG_ERROR("Upload of {} bytes does not fit the {} bytes staging ring", size, m_StagingSize);
+        return std::nullopt;
+    }
+
+    auto offset = allocate_staging(size);
+    if (offset.has_value()) {
+        return offset;
+    }
+
+    reclaim();
+    offset = allocate_staging(size);
+    if (offset.has_value()) {
+        return offset;
+    }
+
+    CPU_ZONE("Upload Stall");
+
+    // Ring full: push what is queued and wait for the oldest batches to free space
+    if (flush() != vk::Result::eSuccess) {
+        return std::nullopt;
+    }
+
+    while (!offset.has_value() && m_CompletedValue < m_SubmittedValue) {
+        if (wait(m_CompletedValue + 1, UINT64_MAX) != vk::Result::eSuccess) {
+            return std::nullopt;
+        }
+        reclaim();
+        offset = allocate_staging(size);
+    }
+
+    return offset;
+}
+
+void UploadManager::refresh()
+{
+    const auto [res, value] = m_Device.getSemaphoreCounterValue(m_Timeline);
+    if (res != vk::Result::eSuccess) {
+        LOG_ERROR("Failed to query upload timeline: {}", vk::to_string(res));
+        return;
+    }
+
+    m_CompletedValue = std::max(m_CompletedValue, value);
+}
+
+void UploadManager::reclaim()
+{
+    refresh();
+
+    // Batches complete in submission order, the newest finished one bounds the free space
+    for (const auto& batch : m_Batches) {
+        if (batch.Value != 0 && batch.Value <= m_CompletedValue) {
+            m_Tail = std::max(m_Tail, batch.StagingEnd);
+        }
+    }
+}
+
+void UploadManager::flush_staging_range()
+{
+    // No-op on coherent memory, needed when VMA picked a cached non coherent type
+    const uint64_t size = m_Head - m_FlushedHead;
+    const vk::DeviceSize offset = m_FlushedHead % m_StagingSize;
+
+    if (offset + size <= m_StagingSize) {
+        vmaFlushAllocation(m_Allocator, m_Staging.Allocation, offset, size);
+    } else {
+        vmaFlushAllocation(m_Allocator, m_Staging.Allocation, offset, m_StagingSize - offset);
+        vmaFlushAllocation(m_Allocator, m_Staging.Allocation, 0, offset + size - m_StagingSize);
+    }
+
+    m_FlushedHead = m_Head;
+}
+
+#pragma endregion
+
+#pragma region Enqueue
+
+std::optional<UploadTicket> UploadManager::enqueue_buffer(const vk::Buffer dst, const vk::DeviceSize dst_offset, const std::span<const std::byte> data,
+    const vk::PipelineStageFlags2 dst_stage, const vk::AccessFlags2 dst_access)
+{
+    const auto offset = reserve_staging(data.size());
+    if (!offset.has_value()) {
+        return std::nullopt;
+    }
+
+    std::memcpy(m_StagingData + offset.value(), data.data(), data.size());
+    m_PendingBuffers.push_back(BufferCopy {
+        dst,
+        vk::BufferCopy2 { offset.value(), dst_offset, data.size() },
+        dst_stage,
+        dst_access });
+
+    return m_SubmittedValue + 1;
+}
+
+std::optional<UploadTicket> UploadManager::enqueue_image(const vk::Image dst, const vk::ImageAspectFlags aspect, const vk::Extent3D mip_extent,
+    const uint32_t mip_level, const uint32_t base_layer, const uint32_t layer_count, const std::span<const std::byte> data,
+    const vk::PipelineStageFlags2 dst_stage)
+{
+    const auto offset = reserve_staging(data.size());
+    if (!offset.has_value()) {
+        return std::nullopt;
+    }
+
+    std::memcpy(m_StagingData + offset.value(), data.data(), data.size());
+    m_PendingImages.push_back(ImageCopy {
+        dst,
+        vk::BufferImageCopy2 {
+            offset.value(), 0, 0,
+            vk::ImageSubresourceLayers { aspect, mip_level, base_layer, layer_count },
+            vk::Offset3D { 0, 0, 0 },
+            mip_extent },
+        dst_stage });
+
+    return m_SubmittedValue + 1;
+}
+
+#pragma endregion
+
+#pragma region Submission
+
+void UploadManager::record_batch(const vk::CommandBuffer cmd)
+{
+    const bool transfer_ownership = uses_dedicated_queue();
+    const uint32_t src_family = transfer_ownership ? m_TransferFamily : vk::QueueFamilyIgnored;
+    const uint32_t dst_family = transfer_ownership ? m_GraphicsFamily : vk::QueueFamilyIgnored;
+
+    // Whole mip levels are replaced so their previous content can be discarded
+    std::vector<vk::ImageMemoryBarrier2> image_barriers;
+    image_barriers.reserve(m_PendingImages.size());
+    for (const auto& copy : m_PendingImages) {
+        const auto& layers = copy.Region.imageSubresource;
+        image_barriers.push_back(vk::ImageMemoryBarrier2 {
+            vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+            vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+            vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+            copy.Dst,
+            vk::ImageSubresourceRange { layers.aspectMask, layers.mipLevel, 1, layers.baseArrayLayer, layers.layerCount } });
+    }
+
+    if (!image_barriers.empty()) {
+        const vk::DependencyInfo dependency { {}, 0, nullptr, 0, nullptr, static_cast<uint32_t>(image_barriers.size()), image_barriers.data() };
+        cmd.pipelineBarrier2(dependency);
+    }
+
+    // One copy command per destination, carrying all of its regions
+    std::ranges::stable_sort(m_PendingBuffers, {}, [](const BufferCopy& copy) { return static_cast<VkBuffer>(copy.Dst); });
+    std::ranges::stable_sort(m_PendingImages, {}, [](const ImageCopy& copy) { return static_cast<VkImage>(copy.Dst); });
+
+    std::vector<vk::BufferCopy2> buffer_regions;
+    for (size_t begin = 0; begin < m_PendingBuffers.size();) {
+        size_t end = begin;
+        buffer_regions.clear();
+        while (end < m_PendingBuffers.size() && m_PendingBuffers[end].Dst == m_PendingBuffers[begin].Dst) {
+            buffer_regions.push_back(m_PendingBuffers[end++].Region);
+        }
+
+        const vk::CopyBufferInfo2 copy_info {
+            m_Staging.Buffer, m_PendingBuffers[begin].Dst,
+            static_cast<uint32_t>(buffer_regions.size()), buffer_regions.data()
+        };
+        cmd.copyBuffer2(copy_info);
+        begin = end;
+    }
+
+    std::vector<vk::BufferImageCopy2> image_regions;
+    for (size_t begin = 0; begin < m_PendingImages.size();) {
+        size_t end = begin;
+        image_regions.clear();
+        while (end < m_PendingImages.size() && m_PendingImages[end].Dst == m_PendingImages[begin].Dst) {
+            image_regions.push_back(m_PendingImages[end++].Region);
+        }
+
+        const vk::CopyBufferToImageInfo2 copy_info {
+            m_Staging.Buffer, m_PendingImages[begin].Dst, vk::ImageLayout::eTransferDstOptimal,
+            static_cast<uint32_t>(image_regions.size()), image_regions.data()
+        };
+        cmd.copyBufferToImage2(copy_info);
+        begin = end;
+    }
+
+    // Release to the graphics family, the acquire half is recorded by the next frame.
+    // On a shared queue only the layout change remains, the timeline wait orders the rest
+    std::vector<vk::BufferMemoryBarrier2> buffer_releases;
+    if (transfer_ownership) {
+        buffer_releases.reserve(m_PendingBuffers.size());
+    }
+
+    for (const auto& copy : m_PendingBuffers) {
+        m_AcquireStages |= copy.DstStage;
+        if (!transfer_ownership) {
+            continue;
+        }
+
+        buffer_releases.push_back(vk::BufferMemoryBarrier2 {
+            vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+            src_family, dst_family,
+            copy.Dst, copy.Region.dstOffset, copy.Region.size });
+
+        m_BufferAcquires.push_back(vk::BufferMemoryBarrier2 {
+            vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+            copy.DstStage, copy.DstAccess,
+            src_family, dst_family,
+            copy.Dst, copy.Region.dstOffset, copy.Region.size });
+    }
+
+    image_barriers.clear();
+    for (const auto& copy : m_PendingImages) {
+        m_AcquireStages |= copy.DstStage;
+
+        const auto& layers = copy.Region.imageSubresource;
+        const vk::ImageSubresourceRange range { layers.aspectMask, layers.mipLevel, 1, layers.baseArrayLayer, layers.layerCount };
+
+        image_barriers.push_back(vk::ImageMemoryBarrier2 {
+            vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+            vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+            src_family, dst_family,
+            copy.Dst, range });
+
+        if (transfer_ownership) {
+            m_ImageAcquires.push_back(vk::ImageMemoryBarrier2 {
+                vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+                copy.DstStage, vk::AccessFlagBits2::eShaderSampledRead,
+                vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+                src_family, dst_family,
+                copy.Dst, range });
+        }
+    }
+
+    if (!buffer_releases.empty() || !image_barriers.empty()) {
+        const vk::DependencyInfo dependency {
+            {},
+            0, nullptr,
+            static_cast<uint32_t>(buffer_releases.size()), buffer_releases.data(),
+            static_cast<uint32_t>(image_barriers.size()), image_barriers.data()
+        };
+        cmd.pipelineBarrier2(dependency);
+    }
+}
+
+vk::Result UploadManager::flush()
+{
+    if (m_PendingBuffers.empty() && m_PendingImages.empty()) {
+        return vk::Result::eSuccess;
+    }
+
+    CPU_ZONE("Upload Flush");
+
+    Batch& batch = m_Batches[m_NextBatch];
+    if (batch.Value > m_CompletedValue) {
+        const vk::Result res = wait(batch.Value, UINT64_MAX);
+        if (res != vk::Result::eSuccess) {
+            return res;
+        }
+    }
+    reclaim();
+
+    vk::Result res = m_Device.resetCommandPool(batch.Pool);
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    constexpr vk::CommandBufferBeginInfo begin_info { vk::CommandBufferUsageFlagBits::eOneTimeSubmit };
+    res = batch.Cmd.begin(begin_info);
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    record_batch(batch.Cmd);
+
+    res = batch.Cmd.end();
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    flush_staging_range();
+
+    const UploadTicket value = m_SubmittedValue + 1;
+    const vk::CommandBufferSubmitInfo cmd_info { batch.Cmd, 0 };
+    const vk::SemaphoreSubmitInfo signal_info { m_Timeline, value, vk::PipelineStageFlagBits2::eAllCommands };
+    const vk::SubmitInfo2 submit_info {
+        {},
+        0, nullptr,
+        1, &cmd_info,
+        1, &signal_info
+    };
+
+    res = m_Gpu->submit_to_transfer_queue(submit_info);
+    if (res != vk::Result::eSuccess) {
+        return res;
+    }
+
+    m_SubmittedValue = value;
+    batch.Value = value;
+    batch.StagingEnd = m_Head;
+    m_NextBatch = (m_NextBatch + 1) % MAX_BATCHES_IN_FLIGHT;
+
+    m_PendingBuffers.clear();
+    m_PendingImages.clear();
+    return vk::Result::eSuccess;
+}
+
+void UploadManager::record_acquires(const vk::CommandBuffer cmd)
+{
+    if (!m_BufferAcquires.empty() || !m_ImageAcquires.empty()) {
+        const vk::DependencyInfo dependency {
+            {},
+            0, nullptr,
+            static_cast<uint32_t>(m_BufferAcquires.size()), m_BufferAcquires.data(),
+            static_cast<uint32_t>(m_ImageAcquires.size()), m_ImageAcquires.data()
+        };
+        cmd.pipelineBarrier2(dependency);
+
+        m_BufferAcquires.clear();
+        m_ImageAcquires.clear();
+    }
+
+    m_RecordedValue = m_SubmittedValue;
+    m_RecordedStages |= m_AcquireStages;
+    m_AcquireStages = {};
+}
+
+std::optional<vk::SemaphoreSubmitInfo> UploadManager::acquire_wait_info()
+{
+    if (m_RecordedValue <= m_AcquiredValue) {
+        return std::nullopt;
+    }
+
+    const vk::SemaphoreSubmitInfo info {
+        m_Timeline, m_RecordedValue,
+        m_RecordedStages ? m_RecordedStages : vk::PipelineStageFlagBits2::eAllCommands
+    };
+
+    m_AcquiredValue = m_RecordedValue;
+    m_RecordedStages = {};
+    return info;
+}
+
+bool UploadManager::is_complete(const UploadTicket ticket)
+{
+    if (m_CompletedValue >= ticket) {
+        return true;
+    }
+
+    refresh();
+    return m_CompletedValue >= ticket;
+}
+
+vk::Result UploadManager::wait(const UploadTicket ticket, const uint64_t timeout)
+{
+    if (m_CompletedValue >= ticket) {
+        return vk::Result::eSuccess;
+    }
+
+    const vk::SemaphoreWaitInfo wait_info {
+        {},
+        1, &m_Timeline,
+        &ticket
+    };
+
+    const vk::Result res = m_Device.waitSemaphores(wait_info, timeout);
+    if (res == vk::Result::eSuccess) {
+        m_CompletedValue = std::max(m_CompletedValue, ticket);
+    }
+
+    return res;
+}
+
+#pragma endregion
+
+}
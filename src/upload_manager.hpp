@@ -0,0 +1,117 @@
+#pragma once
+#include "gpu_manager.hpp"
+
+namespace Minecraft::VkEngine {
+
+// Timeline value of the batch carrying an upload, complete once the copy has landed
+using UploadTicket = uint64_t;
+
+/*
+ * Moves data to the GPU through a persistently mapped staging ring.
+ * Uploads are only queued by enqueue_*, flush() records all of them into one transfer
+ * submission that signals the upload timeline, on the dedicated transfer queue when the
+ * device has one. The next frame recorded on the graphics queue acquires ownership of the
+ * resources (record_acquires) and waits on that value at their first use (acquire_wait_info).
+ * Staging space is recycled once the timeline passes the batch that used it.
+ *
+ * Images are uploaded one whole mip level at a time and handed over in eShaderReadOnlyOptimal,
+ * they are meant to stay out of the ImageStateTracker.
+ */
+class UploadManager {
+public:
+    static constexpr vk::DeviceSize DEFAULT_STAGING_SIZE = 64ull * 1024 * 1024;
+    static constexpr uint32_t MAX_BATCHES_IN_FLIGHT = 4;
+
+    [[nodiscard]] vk::Result init(GpuManager& gpu, vk::DeviceSize staging_size = DEFAULT_STAGING_SIZE);
+    void destroy();
+
+    // dst_stage/dst_access describe the first use on the graphics queue
+    [[nodiscard]] std::optional<UploadTicket> enqueue_buffer(vk::Buffer dst, vk::DeviceSize dst_offset, std::span<const std::byte> data,
+        vk::PipelineStageFlags2 dst_stage, vk::AccessFlags2 dst_access);
+
+    // Replaces the whole mip level, the other levels of the image are left untouched
+    [[nodiscard]] std::optional<UploadTicket> enqueue_image(vk::Image dst, vk::ImageAspectFlags aspect, vk::Extent3D mip_extent,
+        uint32_t mip_level, uint32_t base_layer, uint32_t layer_count, std::span<const std::byte> data,
+        vk::PipelineStageFlags2 dst_stage);
+
+    // Submits everything queued so far as one batch, a no-op without pending uploads
+    [[nodiscard]] vk::Result flush();
+
+    // Acquire barriers for every batch flushed so far, recorded at the start of a graphics command buffer
+    void record_acquires(vk::CommandBuffer cmd);
+    // Wait to add to the submission of that command buffer, empty when it acquired nothing new
+    [[nodiscard]] std::optional<vk::SemaphoreSubmitInfo> acquire_wait_info();
+
+    [[nodiscard]] bool is_complete(UploadTicket ticket);
+    // Its acquire went out with an already submitted graphics command buffer
+    [[nodiscard]] bool is_acquired(const UploadTicket ticket) const { return ticket <= m_AcquiredValue; }
+    [[nodiscard]] vk::Result wait(UploadTicket ticket, uint64_t timeout);
+
+    [[nodiscard]] vk::DeviceSize get_staging_size() const { return m_StagingSize; }
+    [[nodiscard]] vk::DeviceSize get_staging_in_use() const { return m_Head - m_Tail; }
+    [[nodiscard]] bool uses_dedicated_queue() const { return m_TransferFamily != m_GraphicsFamily; }
+
+private:
+    struct BufferCopy {
+        vk::Buffer Dst;
+        vk::BufferCopy2 Region;
+        vk::PipelineStageFlags2 DstStage;
+        vk::AccessFlags2 DstAccess;
+    };
+
+    struct ImageCopy {
+        vk::Image Dst;
+        vk::BufferImageCopy2 Region;
+        vk::PipelineStageFlags2 DstStage;
+    };
+
+    struct Batch {
+        vk::CommandPool Pool { nullptr };
+        vk::CommandBuffer Cmd { nullptr };
+        UploadTicket Value { 0 };
+        uint64_t StagingEnd { 0 };
+    };
+
+    vk::Device m_Device { nullptr };
+    VmaAllocator m_Allocator { nullptr };
+    const GpuManager* m_Gpu { nullptr };
+    MemoryManager* m_Memory { nullptr };
+    uint32_t m_TransferFamily { 0 };
+    uint32_t m_GraphicsFamily { 0 };
+
+    // Staging ring, m_Head and m_Tail only grow and are wrapped on access
+    AllocatedBuffer m_Staging {};
+    std::byte* m_StagingData { nullptr };
+    vk::DeviceSize m_StagingSize { 0 };
+    uint64_t m_Head { 0 };
+    uint64_t m_Tail { 0 };
+    uint64_t m_FlushedHead { 0 };
+
+    vk::Semaphore m_Timeline { nullptr };
+    UploadTicket m_SubmittedValue { 0 };
+    UploadTicket m_CompletedValue { 0 };
+    UploadTicket m_RecordedValue { 0 };
+    UploadTicket m_AcquiredValue { 0 };
+
+    std::array<Batch, MAX_BATCHES_IN_FLIGHT> m_Batches {};
+    uint32_t m_NextBatch { 0 };
+
+    std::vector<BufferCopy> m_PendingBuffers;
+    std::vector<ImageCopy> m_PendingImages;
+
+    // Acquire side of the ownership transfers released by flushed batches
+    std::vector<vk::BufferMemoryBarrier2> m_BufferAcquires;
+    std::vector<vk::ImageMemoryBarrier2> m_ImageAcquires;
+    vk::PipelineStageFlags2 m_AcquireStages {};
+    vk::PipelineStageFlags2 m_RecordedStages {};
+
+    [[nodiscard]] std::optional<vk::DeviceSize> allocate_staging(vk::DeviceSize size);
+    // Like allocate_staging but stalls on the oldest batches when the ring is full
+    [[nodiscard]] std::optional<vk::DeviceSize> reserve_staging(vk::DeviceSize size);
+    void refresh();
+    void reclaim();
+    void record_batch(vk::CommandBuffer cmd);
+    void flush_staging_range();
+};
+
+}
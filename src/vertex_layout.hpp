@@ -0,0 +1,71 @@
+#pragma once
+
+namespace Minecraft {
+
+/*
+ * Compile time vertex input descriptions.
+ * A vertex type lists its fields once through VERTEX_ATTRIBUTE, the binding and attribute
+ * descriptions are then generated from that list with locations following the declaration order.
+ * Layouts must be tightly packed, padding is wasted vertex bandwidth and fails to compile.
+ */
+
+// Default format of a field type, specialize for new field types
+template<typename T>
+struct VertexFormatOf;
+
+#define VERTEX_FORMAT_OF(type, format)                        \
+    template<>                                                \
+    struct VertexFormatOf<type> {                             \
+        static constexpr vk::Format VALUE = vk::Format::format; \
+    }
+
+VERTEX_FORMAT_OF(float, eR32Sfloat);
+VERTEX_FORMAT_OF(glm::vec2, eR32G32Sfloat);
+VERTEX_FORMAT_OF(glm::vec3, eR32G32B32Sfloat);
+VERTEX_FORMAT_OF(glm::vec4, eR32G32B32A32Sfloat);
+VERTEX_FORMAT_OF(uint32_t, eR32Uint);
+VERTEX_FORMAT_OF(glm::uvec2, eR32G32Uint);
+VERTEX_FORMAT_OF(glm::u16vec2, eR16G16Uint);
+VERTEX_FORMAT_OF(glm::u16vec4, eR16G16B16A16Uint);
+VERTEX_FORMAT_OF(glm::i16vec4, eR16G16B16A16Sint);
+VERTEX_FORMAT_OF(glm::u8vec4, eR8G8B8A8Uint);
+
+#undef VERTEX_FORMAT_OF
+
+template<typename T, uint32_t Offset, vk::Format Format = VertexFormatOf<T>::VALUE>
+struct VertexAttribute {
+    static constexpr uint32_t OFFSET = Offset;
+    static constexpr uint32_t SIZE = sizeof(T);
+    static constexpr vk::Format FORMAT = Format;
+};
+
+template<typename V, typename... Attributes>
+struct VertexLayout {
+    static_assert(std::is_trivially_copyable_v<V>, "Vertices are memcpy'd into GPU buffers");
+    static_assert((0u + ... + Attributes::SIZE) == sizeof(V), "Vertex layout has padding or unlisted fields");
+
+    using Vertex = V;
+    static constexpr uint32_t STRIDE = sizeof(V);
+    static constexpr uint32_t ATTRIBUTE_COUNT = sizeof...(Attributes);
+
+    static constexpr vk::VertexInputBindingDescription binding_description(const uint32_t binding = 0)
+    {
+        return vk::VertexInputBindingDescription { binding, STRIDE, vk::VertexInputRate::eVertex };
+    }
+
+    static constexpr std::array<vk::VertexInputAttributeDescription, ATTRIBUTE_COUNT> attribute_descriptions(const uint32_t binding = 0)
+    {
+        uint32_t location = 0;
+        return { vk::VertexInputAttributeDescription { location++, binding, Attributes::FORMAT, Attributes::OFFSET }... };
+    }
+};
+
+}
+
+// Field of a vertex with the default format of its type
+#define VERTEX_ATTRIBUTE(vertex, field) \
+    ::Minecraft::VertexAttribute<decltype(vertex::field), offsetof(vertex, field)>
+
+// Field of a vertex read with another format of the same size, e.g. normalized integers
+#define VERTEX_ATTRIBUTE_AS(vertex, field, format) \
+    ::Minecraft::VertexAttribute<decltype(vertex::field), offsetof(vertex, field), vk::Format::format>
@@ -0,0 +1,253 @@
+#include "world_streamer.hpp"
+#include "cpu_profiler.hpp"
+
+namespace Minecraft::VkEngine {
+
+// Horizontal neighbors in Chunk::Neighbors order
+static constexpr std::array<std::pair<BlockFace, glm::ivec2>, 4> NEIGHBOR_OFFSETS { {
+    { BlockFace::ePosX, { 1, 0 } },
+    { BlockFace::eNegX, { -1, 0 } },
+    { BlockFace::ePosZ, { 0, 1 } },
+    { BlockFace::eNegZ, { 0, -1 } },
+} };
+
+void WorldStreamer::init(JobSystem& jobs, ChunkRenderer& renderer, WorldSpec spec)
+{
+    m_Jobs = &jobs;
+    m_Renderer = &renderer;
+    m_Spec = std::move(spec);
+    m_Generator = TerrainGenerator { m_Spec.Terrain };
+}
+
+void WorldStreamer::destroy()
+{
+    for (ChunkSlot& slot : m_Chunks | std::views::values) {
+        m_Jobs->cancel(slot.Generate);
+        m_Jobs->cancel(slot.Mesh);
+    }
+
+    // Cancelled jobs that already started still report to this object
+    for (const ChunkSlot& slot : m_Chunks | std::views::values) {
+        m_Jobs->wait(slot.Generate);
+        m_Jobs->wait(slot.Mesh);
+    }
+
+    m_Chunks.clear();
+    m_Ready.clear();
+    m_Completed.clear();
+}
+
+float WorldStreamer::distance(const glm::ivec2 coord) const
+{
+    return glm::length(glm::vec2 { coord - m_Center });
+}
+
+JobPriority WorldStreamer::priority(const float distance) const
+{
+    if (distance <= 2.0f) {
+        return JobPriority::eHigh;
+    }
+    return distance <= static_cast<float>(m_Spec.ViewDistance) * 0.5f ? JobPriority::eNormal : JobPriority::eLow;
+}
+
+void WorldStreamer::update(const glm::vec3 camera)
+{
+    CPU_ZONE("World Update");
+
+    m_Center = glm::ivec2 { glm::floor(glm::vec2 { camera.x, camera.z } / static_cast<float>(ChunkSection::SIZE)) };
+    const auto view = static_cast<float>(m_Spec.ViewDistance);
+    const float loaded = view + 1.0f;
+
+    // A chunk past the generated area has all its neighbors out of view, cancelling its generation
+    // only takes down meshing jobs that are cancelled anyway
+    for (auto it = m_Chunks.begin(); it != m_Chunks.end();) {
+        ChunkSlot& slot = it->second;
+        const float d = distance(slot.Coord);
+        if (d > loaded) {
+            unload(slot);
+            it = m_Chunks.erase(it);
+            continue;
+        }
+
+        if (d > view) {
+            cancel_mesh(slot);
+        }
+        ++it;
+    }
+
+    // Nearest first, jobs submitted from this thread are picked in submission order within a priority
+    std::vector<glm::ivec2> missing;
+    const auto radius = static_cast<int32_t>(m_Spec.ViewDistance) + 1;
+    for (int32_t z = -radius; z <= radius; z++) {
+        for (int32_t x = -radius; x <= radius; x++) {
+            const glm::ivec2 coord = m_Center + glm::ivec2 { x, z };
+            if (distance(coord) <= loaded && !m_Chunks.contains(key(coord))) {
+                missing.push_back(coord);
+            }
+        }
+    }
+
+    std::ranges::sort(missing, {}, [&](const glm::ivec2 coord) { return distance(coord); });
+    for (const glm::ivec2 coord : missing) {
+        load(coord);
+    }
+
+    std::vector<ChunkSlot*> unmeshed;
+    for (ChunkSlot& slot : m_Chunks | std::views::values) {
+        if (slot.State == MeshState::eNone && distance(slot.Coord) <= view) {
+            unmeshed.push_back(&slot);
+        }
+    }
+
+    std::ranges::sort(unmeshed, {}, [&](const ChunkSlot* slot) { return distance(slot->Coord); });
+    for (ChunkSlot* slot : unmeshed) {
+        schedule_mesh(*slot);
+    }
+
+    upload_ready();
+}
+
+void WorldStreamer::load(const glm::ivec2 coord)
+{
+    ChunkSlot& slot = m_Chunks[key(coord)];
+    slot.Coord = coord;
+    slot.Data = std::make_shared<Chunk>();
+
+    slot.Generate = m_Jobs->submit([this, chunk = slot.Data, coord] {
+        CPU_ZONE("Generate Chunk");
+        m_Generator.generate(*chunk, coord.x, coord.y);
+        m_Generated.fetch_add(1, std::memory_order_relaxed);
+    }, priority(distance(coord)));
+}
+
+void WorldStreamer::unload(ChunkSlot& slot)
+{
+    m_Jobs->cancel(slot.Generate);
+    cancel_mesh(slot);
+}
+
+void WorldStreamer::schedule_mesh(ChunkSlot& slot)
+{
+    // Neighbors generating meanwhile are dependencies, no need to wait for them here
+    std::array<std::shared_ptr<const Chunk>, NEIGHBOR_OFFSETS.size()> neighbors;
+    std::array<JobHandle, NEIGHBOR_OFFSETS.size() + 1> dependencies { slot.Generate };
+    for (size_t i = 0; i < NEIGHBOR_OFFSETS.size(); i++) {
+        const auto it = m_Chunks.find(key(slot.Coord + NEIGHBOR_OFFSETS[i].second));
+        if (it != m_Chunks.end()) {
+            neighbors[i] = it->second.Data;
+            dependencies[i + 1] = it->second.Generate;
+        }
+    }
+
+    slot.State = MeshState::eMeshing;
+    slot.MeshRequest = m_NextMeshRequest++;
+
+    slot.Mesh = m_Jobs->submit([this, chunk = std::shared_ptr<const Chunk> { slot.Data }, neighbors, coord = slot.Coord, request = slot.MeshRequest] {
+        CPU_ZONE("Mesh Chunk");
+
+        Chunk::Neighbors around {};
+        for (size_t i = 0; i < NEIGHBOR_OFFSETS.size(); i++) {
+            around[static_cast<size_t>(NEIGHBOR_OFFSETS[i].first)] = neighbors[i].get();
+        }
+
+        // Scratch memory is reused by every job the worker runs, the texture table stays owned by the spec
+        thread_local ChunkMesher mesher;
+        mesher.set_textures(m_Spec.BlockTextures);
+        ChunkMesh section_mesh;
+        PreparedMesh prepared { coord, request };
+
+        // Upload preparation: one stream for the whole chunk, each section drawn from its own range
+        for (uint32_t section = 0; section < Chunk::SECTION_COUNT; section++) {
+            if (JobSystem::is_cancelled()) {
+                return;
+            }
+
+            mesher.mesh(*chunk, section, around, section_mesh);
+            prepared.Sections[section] = SectionDraw {
+                static_cast<uint32_t>(prepared.Indices.size()),
+                static_cast<uint32_t>(section_mesh.Indices.size()),
+                static_cast<int32_t>(prepared.Vertices.size())
+            };
+            prepared.Vertices.insert(prepared.Vertices.end(), section_mesh.Vertices.begin(), section_mesh.Vertices.end());
+            prepared.Indices.insert(prepared.Indices.end(), section_mesh.Indices.begin(), section_mesh.Indices.end());
+        }
+
+        std::scoped_lock lock { m_CompletedMutex };
+        m_Completed.push_back(std::move(prepared));
+    }, priority(distance(slot.Coord)), dependencies);
+}
+
+void WorldStreamer::cancel_mesh(ChunkSlot& slot)
+{
+    if (slot.State == MeshState::eMeshing) {
+        m_Jobs->cancel(slot.Mesh);
+    }
+
+    remove_draw(slot);
+    slot.State = MeshState::eNone;
+}
+
+void WorldStreamer::upload_ready()
+{
+    CPU_ZONE("World Uploads");
+
+    {
+        std::scoped_lock lock { m_CompletedMutex };
+        std::ranges::move(m_Completed, std::back_inserter(m_Ready));
+        m_Completed.clear();
+    }
+
+    // Results of cancelled or superseded requests, or of chunks gone meanwhile
+    std::erase_if(m_Ready, [&](const PreparedMesh& prepared) {
+        const auto it = m_Chunks.find(key(prepared.Coord));
+        return it == m_Chunks.end() || it->second.State != MeshState::eMeshing || it->second.MeshRequest != prepared.Request;
+    });
+
+    std::ranges::sort(m_Ready, {}, [&](const PreparedMesh& prepared) { return distance(prepared.Coord); });
+
+    vk::DeviceSize budget = m_Spec.UploadBudgetPerFrame;
+    size_t uploaded = 0;
+    for (; uploaded < m_Ready.size(); uploaded++) {
+        const PreparedMesh& prepared = m_Ready[uploaded];
+        ChunkSlot& slot = m_Chunks.at(key(prepared.Coord));
+
+        if (prepared.Indices.empty()) {
+            slot.State = MeshState::eDone;
+            continue;
+        }
+
+        // The first mesh always goes, however large
+        const vk::DeviceSize bytes = std::as_bytes(std::span { prepared.Vertices }).size() + std::as_bytes(std::span { prepared.Indices }).size();
+        if (bytes > budget && budget != m_Spec.UploadBudgetPerFrame) {
+            break;
+        }
+
+        const auto render = m_Renderer->add(prepared.Coord.x, prepared.Coord.y, prepared.Vertices, prepared.Indices, prepared.Sections);
+        if (!render.has_value()) {
+            // Staging ring or arenas full, the next frames retry
+            break;
+        }
+        budget -= std::min(bytes, budget);
+
+        slot.State = MeshState::eDone;
+        slot.Render = render.value();
+        m_Uploaded++;
+    }
+
+    m_Ready.erase(m_Ready.begin(), m_Ready.begin() + static_cast<ptrdiff_t>(uploaded));
+}
+
+void WorldStreamer::remove_draw(ChunkSlot& slot)
+{
+    m_Renderer->remove(slot.Render);
+    slot.Render = {};
+}
+
+std::string WorldStreamer::summary() const
+{
+    return fmt::format("World: {} chunks loaded, {} drawn, {} jobs pending, {} meshes waiting for upload, {} generated with {} noise, {} uploaded in total",
+        m_Chunks.size(), m_Renderer->get_chunk_count(), m_Jobs->get_pending_count(), m_Ready.size(), m_Generated.load(std::memory_order_relaxed),
+        to_string(m_Generator.get_simd_level()), m_Uploaded);
+}
+
+}
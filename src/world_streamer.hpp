@@ -0,0 +1,106 @@
+#pragma once
+#include "chunk_mesher.hpp"
+#include "chunk_renderer.hpp"
+#include "job_system.hpp"
+#include "terrain_generator.hpp"
+
+namespace Minecraft::VkEngine {
+
+struct WorldSpec {
+    // Radius in chunks of what gets meshed, one more ring is generated so every meshed chunk has its neighbors
+    uint32_t ViewDistance { 8 };
+    TerrainSpec Terrain {};
+    // Texture layers per block id, see ChunkMesher
+    std::vector<BlockFaceTextures> BlockTextures {};
+    // Mesh bytes handed to the UploadManager per frame, the rest waits for the next frames
+    vk::DeviceSize UploadBudgetPerFrame { 8 * 1024 * 1024 };
+};
+
+/*
+ * Keeps the chunks around the camera generated and meshed, all of the CPU work running on the JobSystem.
+ *
+ * Each chunk gets a generation job, and once it is in view a meshing job depending on the generation of the chunk
+ * and its four neighbors, both prioritised by distance to the camera. The meshing job also prepares the upload:
+ * the sections are packed into one vertex and one index stream with their ranges, the main thread only hands them
+ * to the ChunkRenderer, nearest first within a per frame budget.
+ *
+ * Chunks leaving the view lose their mesh and cancel pending meshing, chunks leaving the generated area are dropped
+ * along with their jobs. Jobs hold the chunks they read, so a chunk can go while its neighbors are still meshed.
+ */
+class WorldStreamer {
+public:
+    void init(JobSystem& jobs, ChunkRenderer& renderer, WorldSpec spec);
+    // Waits for the jobs still referencing the streamer, geometry is left to the ChunkRenderer
+    void destroy();
+
+    // Main thread, before the uploads are flushed
+    void update(glm::vec3 camera);
+
+    // No job pending and nothing waiting for upload
+    [[nodiscard]] bool is_idle() const { return m_Jobs->get_pending_count() == 0 && m_Ready.empty(); }
+    [[nodiscard]] std::string summary() const;
+
+private:
+    struct PreparedMesh {
+        glm::ivec2 Coord {};
+        uint64_t Request { 0 };
+        std::vector<PackedChunkVertex> Vertices;
+        std::vector<uint32_t> Indices;
+        std::array<SectionDraw, Chunk::SECTION_COUNT> Sections {};
+    };
+
+    enum class MeshState : uint8_t {
+        eNone,
+        // Job queued or running, or result waiting for upload
+        eMeshing,
+        // Handed to the renderer, or nothing to draw
+        eDone
+    };
+
+    struct ChunkSlot {
+        glm::ivec2 Coord {};
+        std::shared_ptr<Chunk> Data;
+        JobHandle Generate {};
+        JobHandle Mesh {};
+        MeshState State { MeshState::eNone };
+        // Results of older meshing requests are dropped
+        uint64_t MeshRequest { 0 };
+        ChunkRenderHandle Render {};
+    };
+
+    JobSystem* m_Jobs { nullptr };
+    ChunkRenderer* m_Renderer { nullptr };
+    WorldSpec m_Spec;
+    TerrainGenerator m_Generator;
+
+    std::unordered_map<uint64_t, ChunkSlot> m_Chunks;
+    uint64_t m_NextMeshRequest { 1 };
+    glm::ivec2 m_Center {};
+    // Meshes prepared by the jobs, waiting for upload budget
+    std::vector<PreparedMesh> m_Ready;
+
+    // Filled by the meshing jobs
+    std::mutex m_CompletedMutex;
+    std::vector<PreparedMesh> m_Completed;
+
+    // Totals for the summary
+    std::atomic<uint64_t> m_Generated { 0 };
+    uint64_t m_Uploaded { 0 };
+
+    [[nodiscard]] static uint64_t key(const glm::ivec2 coord)
+    {
+        return static_cast<uint64_t>(static_cast<uint32_t>(coord.x)) << 32 | static_cast<uint32_t>(coord.y);
+    }
+
+    [[nodiscard]] float distance(glm::ivec2 coord) const;
+    [[nodiscard]] JobPriority priority(float distance) const;
+
+    void load(glm::ivec2 coord);
+    void unload(ChunkSlot& slot);
+    void schedule_mesh(ChunkSlot& slot);
+    void cancel_mesh(ChunkSlot& slot);
+    void upload_ready();
+    void remove_draw(ChunkSlot& slot);
+};
+
+}